@@ -55,7 +55,6 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdio.h>
-#include <math.h>
 
 #include "nordic_common.h"
 #include "nrf.h"
@@ -70,6 +69,7 @@
 #include "nrf_sdh_soc.h"
 #include "nrf_sdh_ble.h"
 #include "app_timer.h"
+#include "app_scheduler.h"
 #include "fds.h"
 #include "peer_manager.h"
 #include "peer_manager_handler.h"
@@ -91,6 +91,14 @@
 
 #include "ble_sls.h"
 #include "pwm_controller.h"
+#include "qdec_acq.h"
+#include "sled_pipeline.h"
+#include "odometer.h"
+#include "sled_link.h"
+#include "resistance_ctrl.h"
+#include "sled_prof.h"
+#include "sled_snapshot.h"
+#include "ble_dgs.h"
 
 #define DEVICE_NAME                     "RAPTR_SLED"                       /**< Name of device. Will be included in the advertising data. */
 #define MANUFACTURER_NAME               "NordicSemiconductor"                   /**< Manufacturer. Will be passed to Device Information Service. */
@@ -102,14 +110,38 @@
 
 #define MIN_CONN_INTERVAL               MSEC_TO_UNITS(100, UNIT_1_25_MS)        /**< Minimum acceptable connection interval (0.1 seconds). */
 #define MAX_CONN_INTERVAL               MSEC_TO_UNITS(200, UNIT_1_25_MS)        /**< Maximum acceptable connection interval (0.2 second). */
-#define SLAVE_LATENCY                   0                                       /**< Slave latency. */
+#define SLAVE_LATENCY                   4                                       /**< Slave latency while idle. */
 #define CONN_SUP_TIMEOUT                MSEC_TO_UNITS(4000, UNIT_10_MS)         /**< Connection supervisory timeout (4 seconds). */
 
+#define ACTIVE_MIN_CONN_INTERVAL        MSEC_TO_UNITS(7.5, UNIT_1_25_MS)        /**< Minimum connection interval while streaming a moving sled (7.5 ms). */
+#define ACTIVE_MAX_CONN_INTERVAL        MSEC_TO_UNITS(15, UNIT_1_25_MS)         /**< Maximum connection interval while streaming a moving sled (15 ms). */
+#define ACTIVE_SLAVE_LATENCY            0                                       /**< Slave latency while streaming a moving sled. */
+#define LINK_IDLE_TIMEOUT               APP_TIMER_TICKS(5000)                   /**< Time without motion before relaxing the connection interval (5 seconds). */
+
 #define FIRST_CONN_PARAMS_UPDATE_DELAY  APP_TIMER_TICKS(5000)                   /**< Time from initiating event (connect or start of notification) to first time sd_ble_gap_conn_param_update is called (5 seconds). */
 #define NEXT_CONN_PARAMS_UPDATE_DELAY   APP_TIMER_TICKS(30000)                  /**< Time between each call to sd_ble_gap_conn_param_update after the first call (30 seconds). */
 #define MAX_CONN_PARAMS_UPDATE_COUNT    3                                       /**< Number of attempts before giving up the connection parameter negotiation. */
 
-#define QENC_MEAS_INTERVAL              APP_TIMER_TICKS(100)                   /**< Encoder measurement interval (ticks). */
+#define VALUE_HEARTBEAT_INTERVAL        APP_TIMER_TICKS(1000)                   /**< Longest time without a Sled Value notification while the value does not change (1 second). */
+#define VALUE_DEADBAND_POWER_Q16        (1 << 16)                               /**< Power change that triggers a Sled Value notification (1 W, Q16.16). */
+#define VALUE_DEADBAND_DIST_MM          50                                      /**< Distance change that triggers a Sled Value notification (50 mm). */
+#define QENC_IDLE_TIMEOUT_US            2000000                                 /**< Time without encoder motion before QDEC sampling sleeps (2 seconds). */
+#define QENC_COUNTS_PER_REV             (256 * 4)                               /**< Encoder counts per revolution after x4 decoding. */
+#define QENC_MAX_SPEED_MM_S             12000                                   /**< Top sprint speed the QDEC sample period is sized for (12 m/s). */
+#define QENC_VELOCITY_TAU_US            50000                                   /**< Memory of the velocity estimator, trades smoothness for response (50 ms). */
+#define QENC_MAX_COUNTS_PER_S           (((uint64_t)QENC_MAX_SPEED_MM_S * 1000 * QENC_COUNTS_PER_REV) / ODOMETER_UM_PER_REV) /**< Transition rate at QENC_MAX_SPEED_MM_S. */
+#define STREAM_MAX_LATENCY              (BLE_SLS_STREAM_TICK_HZ / 10)           /**< Longest time a sample waits for a batched notification (100 ms). */
+#define STREAM_US_TO_TICKS(_us)         (((_us) * BLE_SLS_STREAM_TICK_HZ) / 1000000) /**< Converts microseconds to Sled Stream timestamp units. */
+
+#define RES_CTRL_KP                     (40 << 8)                               /**< Constant power proportional gain, duty ticks per watt (Q8.8). */
+#define RES_CTRL_KI                     (6250 << 8)                             /**< Constant power integral gain, duty ticks per watt and second (Q8.8). */
+#define RES_CTRL_DUTY_MIN               0                                       /**< Lowest duty in constant power mode. */
+#define RES_CTRL_DUTY_MAX               PWM_TOP_VALUE                           /**< Highest duty in constant power mode. */
+
+#define PROF_LOG_INTERVAL               APP_TIMER_TICKS(10000)                  /**< Interval of the CPU profile log over RTT (10 seconds). */
+
+#define SCHED_MAX_EVENT_DATA_SIZE       sizeof(sled_evt_t)                      /**< Maximum size of scheduler events. */
+#define SCHED_QUEUE_SIZE                16                                      /**< Maximum number of events in the scheduler queue. */
 
 #define SEC_PARAM_BOND                  1                                       /**< Perform bonding. */
 #define SEC_PARAM_MITM                  0                                       /**< Man In The Middle protection not required. */
@@ -123,23 +155,70 @@
 #define DEAD_BEEF                       0xDEADBEEF                              /**< Value used as error code on stack dump, can be used to identify stack location on stack unwind. */
 
 
-/* Variables for QDEC */
-static volatile bool m_report_ready_flag = false;
-static volatile bool m_first_report_flag = true;
-static volatile uint8_t m_accdblread;
-static volatile int8_t m_accread;
-static uint64_t send_data;
+/**@brief Application event types, all processed by @ref sled_evt_dispatch in the main loop. */
+typedef enum
+{
+    SLED_EVT_QDEC_REPORT,       /**< QDEC reports are waiting in the acquisition FIFO. */
+    SLED_EVT_PWM_CMD,           /**< A Sled PWM command was accepted. */
+    SLED_EVT_VALUE_HEARTBEAT,   /**< The Sled Value heartbeat interval elapsed. */
+    SLED_EVT_VALUE_RESEND,      /**< The TX queue has room for a held back Sled Value. */
+    SLED_EVT_SESSION_RESET,     /**< A central connected, the odometer session restarts. */
+    SLED_EVT_QDEC_SLEEP,        /**< QDEC sampling went to sleep, the sled stands still. */
+    SLED_EVT_PROF_LOG           /**< The CPU profile log interval elapsed. */
+} sled_evt_type_t;
+
+/**@brief Sled PWM command, copied out of the SoftDevice write event. */
+typedef struct
+{
+    ble_sls_cmd_opcode_t opcode;
+    union
+    {
+        uint8_t  mode;              /**< BLE_SLS_CMD_SET_MODE. */
+        struct
+        {
+            uint16_t duty;
+            uint16_t ramp_ms;
+        } duty;                     /**< BLE_SLS_CMD_SET_DUTY. */
+        uint32_t target_q16;        /**< BLE_SLS_CMD_SET_POWER, watts in Q16.16. */
+        struct
+        {
+            uint8_t             count;
+            pwm_profile_point_t points[BLE_SLS_CMD_PROFILE_MAX_POINTS];
+        } profile;                  /**< BLE_SLS_CMD_SET_PROFILE. */
+    } params;
+} sled_cmd_t;
+
+/**@brief Application event, the unit of the scheduler queue. */
+typedef struct
+{
+    sled_evt_type_t type;
+    sled_cmd_t      cmd;        /**< Valid for SLED_EVT_PWM_CMD only. */
+} sled_evt_t;
+
+static sled_pipeline_t m_pipeline;                                              /**< Power, distance and time from the QDEC reports. */
+static sled_snapshot_t m_snapshot;                                              /**< Latest published batch, the only way consumers see the metrics. */
+static uint32_t        m_batches;                                               /**< Batches published, main loop only. */
+static resistance_ctrl_t m_resistance_ctrl;                                     /**< Constant power controller, stepped once per batch of QDEC reports. */
+static volatile bool m_qdec_evt_queued = false;                                 /**< A QDEC report event is waiting in the scheduler queue. */
+static volatile bool m_resend_evt_queued = false;                               /**< A Sled Value resend event is waiting in the scheduler queue. */
+static bool m_value_notifying = false;                                          /**< Client subscribed to Sled Value. */
+static bool m_value_sent = false;                                               /**< Sled Value notified since the last heartbeat, main loop only. */
+static uint32_t m_value_last_power_q16;                                         /**< Power of the last Sled Value notified, main loop only. */
+static int64_t  m_value_last_dist_mm;                                           /**< Distance of the last Sled Value notified, main loop only. */
+static bool m_stream_notifying = false;                                         /**< Client subscribed to Sled Stream. */
 
 NRF_BLE_GATT_DEF(m_gatt);                                                       /**< GATT module instance. */
 NRF_BLE_QWR_DEF(m_qwr);                                                         /**< Context for the Queued Write module.*/
 BLE_ADVERTISING_DEF(m_advertising);                                             /**< Advertising module instance. */
-APP_TIMER_DEF(m_qenc_timer_id);                                                 /**< Encoder measurement timer . */
+APP_TIMER_DEF(m_value_hb_timer_id);                                             /**< Sled Value heartbeat timer. */
+APP_TIMER_DEF(m_prof_timer_id);                                                 /**< CPU profile log timer. */
 
 static uint16_t m_conn_handle = BLE_CONN_HANDLE_INVALID;                        /**< Handle of the current connection. */
 
 /* Declare all services structure your application is using
  */
 BLE_SLS_DEF(m_sls);
+BLE_DGS_DEF(m_dgs);
 
 // Use UUIDs for service(s) used in your application.
 static ble_uuid_t m_adv_uuids[] =                                               /**< Universally unique service identifiers. */
@@ -147,10 +226,354 @@ static ble_uuid_t m_adv_uuids[] =
     {SLED_SERVICE_UUID, BLE_UUID_TYPE_VENDOR_BEGIN}
 };
 
-static void char_pwm_write_handler(uint32_t pwm_value)
+static void sled_evt_dispatch(void * p_event_data, uint16_t event_size);
+
+/**@brief Function for queueing an application event without parameters.
+ *
+ * @details Safe to call from any context.
+ *
+ * @return  NRF_SUCCESS, or NRF_ERROR_NO_MEM if the scheduler queue is full.
+ */
+static ret_code_t sled_evt_post(sled_evt_type_t type)
+{
+    sled_evt_t evt;
+
+    evt.type = type;
+    return app_sched_event_put(&evt, sizeof(evt), sled_evt_dispatch);
+}
+
+/**@brief Function for handling a Sled PWM command.
+ *
+ * @details Called from the Sled Service in SoftDevice context. The command is only validated and
+ *          queued, so the client learns about a bad command right away while the PWM and the
+ *          constant power controller are touched from the main loop alone.
+ *
+ * @return  NRF_SUCCESS to accept the command, NRF_ERROR_NO_MEM if the scheduler queue is full,
+ *          NRF_ERROR_INVALID_PARAM to reject it.
+ */
+static ret_code_t sled_cmd_handler(ble_sls_cmd_t const * p_cmd)
+{
+    sled_evt_t      evt;
+    uint8_t const * p_point;
+
+    evt.type       = SLED_EVT_PWM_CMD;
+    evt.cmd.opcode = p_cmd->opcode;
+
+    switch (p_cmd->opcode)
+    {
+        case BLE_SLS_CMD_SET_MODE:
+            if (p_cmd->params.set_mode.mode >= PWM_SETTING_COUNT)
+            {
+                return NRF_ERROR_INVALID_PARAM;
+            }
+            evt.cmd.params.mode = p_cmd->params.set_mode.mode;
+            break;
+
+        case BLE_SLS_CMD_SET_DUTY:
+            if (p_cmd->params.set_duty.duty > PWM_TOP_VALUE)
+            {
+                return NRF_ERROR_INVALID_PARAM;
+            }
+            evt.cmd.params.duty.duty    = p_cmd->params.set_duty.duty;
+            evt.cmd.params.duty.ramp_ms = p_cmd->params.set_duty.ramp_ms;
+            break;
+
+        case BLE_SLS_CMD_SET_POWER:
+            evt.cmd.params.target_q16 = ((uint32_t)p_cmd->params.set_power.target_dw << 16) / 10;
+            break;
+
+        case BLE_SLS_CMD_SET_PROFILE:
+            // The points live in the SoftDevice event buffer, decode them into the event.
+            p_point = p_cmd->params.set_profile.p_points;
+            for (uint8_t i = 0; i < p_cmd->params.set_profile.count; i++)
+            {
+                evt.cmd.params.profile.points[i].left  = uint16_decode(&p_point[0]);
+                evt.cmd.params.profile.points[i].right = uint16_decode(&p_point[2]);
+                evt.cmd.params.profile.points[i].steps = uint16_decode(&p_point[4]);
+                p_point                               += BLE_SLS_CMD_POINT_LEN;
+            }
+            evt.cmd.params.profile.count = p_cmd->params.set_profile.count;
+            if (pwmProfileCheck(evt.cmd.params.profile.points, evt.cmd.params.profile.count) != NRF_SUCCESS)
+            {
+                return NRF_ERROR_INVALID_PARAM;
+            }
+            break;
+
+        default:
+            return NRF_ERROR_INVALID_PARAM;
+    }
+
+    return app_sched_event_put(&evt, sizeof(evt), sled_evt_dispatch);
+}
+
+/**@brief Function for applying a queued Sled PWM command in the main loop.
+ */
+static void sled_cmd_apply(sled_cmd_t const * p_cmd)
+{
+    ret_code_t err_code = NRF_SUCCESS;
+    uint32_t   prof     = sled_prof_start();
+
+    switch (p_cmd->opcode)
+    {
+        case BLE_SLS_CMD_SET_MODE:
+            resistance_ctrl_target_set(&m_resistance_ctrl, 0);
+            initPwm((pwm_setting_t)p_cmd->params.mode);
+            break;
+
+        case BLE_SLS_CMD_SET_DUTY:
+            resistance_ctrl_target_set(&m_resistance_ctrl, 0);
+            err_code = pwmResistanceRamp(p_cmd->params.duty.duty, p_cmd->params.duty.ramp_ms);
+            break;
+
+        case BLE_SLS_CMD_SET_POWER:
+            resistance_ctrl_target_set(&m_resistance_ctrl, p_cmd->params.target_q16);
+            break;
+
+        case BLE_SLS_CMD_SET_PROFILE:
+            resistance_ctrl_target_set(&m_resistance_ctrl, 0);
+            err_code = pwmProfileSet(p_cmd->params.profile.points, p_cmd->params.profile.count);
+            break;
+
+        default:
+            break;
+    }
+    APP_ERROR_CHECK(err_code);
+
+    // Any fixed resistance and a zero power target leave constant power mode. The controller gains
+    // are tuned for the report period of the fastest range, so acquisition is pinned to it only
+    // while the loop runs.
+    qdec_acq_autorange_set(!resistance_ctrl_is_enabled(&m_resistance_ctrl));
+
+    sled_prof_stop(SLED_PROF_PWM, prof);
+}
+
+/**@brief Function for handling QDEC acquisition events in interrupt context.
+ *
+ * @details Only wakes the main loop. One event is queued at a time; the reports themselves wait
+ *          in the acquisition FIFO, and if the queue is full the next report tries again.
+ */
+static void qdec_acq_evt_handler(qdec_acq_evt_t const * p_evt)
+{
+    switch (p_evt->type)
+    {
+        case QDEC_ACQ_EVT_REPORT:
+            if (!m_qdec_evt_queued && (sled_evt_post(SLED_EVT_QDEC_REPORT) == NRF_SUCCESS))
+            {
+                m_qdec_evt_queued = true;
+            }
+            break;
+
+        case QDEC_ACQ_EVT_SLEEP:
+            NRF_LOG_DEBUG("QDEC sampling asleep.");
+            (void)sled_evt_post(SLED_EVT_QDEC_SLEEP);
+            break;
+
+        case QDEC_ACQ_EVT_WAKE:
+            NRF_LOG_DEBUG("QDEC sampling awake.");
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**@brief Function for adding the latest snapshot to the Sled Stream.
+ */
+static void sled_stream_update(void)
+{
+    ret_code_t           err_code;
+    sled_snapshot_data_t snap;
+    ble_sls_stream_rec_t stream_rec;
+
+    sled_snapshot_read(&m_snapshot, &snap);
+
+    // The pipeline sums the hardware measured spans, so the clock is continuous across TIMER wrap.
+    stream_rec.timestamp = (uint16_t)STREAM_US_TO_TICKS(snap.time_us);
+    stream_rec.power     = SLED_METRICS_Q16_TO_FLOAT(snap.power_q16);
+    stream_rec.distance  = (float)snap.session_mm / 1000.0f;
+
+    // Not subscribed: the sample is dropped. TX queue full is handled by the service.
+    err_code = ble_sls_stream_rec_add(&m_sls, &stream_rec);
+    if (err_code != NRF_ERROR_INVALID_STATE)
+    {
+        APP_ERROR_CHECK(err_code);
+    }
+}
+
+/**@brief Function for notifying the Sled Value from the latest snapshot.
+ *
+ * @details Without a heartbeat the value is only sent when power or distance left the deadband
+ *          around the last value sent, or power dropped to zero. A heartbeat is only sent if
+ *          nothing went out since the previous one, so a moving sled never sees it.
+ *
+ * @param[in]   heartbeat   True when called for the heartbeat timer.
+ */
+static void sled_value_send(bool heartbeat)
+{
+    ret_code_t             err_code;
+    sled_snapshot_data_t   snap;
+    ble_sls_sled_value_t * p_sled_value;
+
+    if (!m_value_notifying)
+    {
+        return;
+    }
+
+    sled_snapshot_read(&m_snapshot, &snap);
+
+    if (heartbeat)
+    {
+        if (m_value_sent)
+        {
+            m_value_sent = false;
+            return;
+        }
+    }
+    else if ((ABS((int64_t)snap.power_q16 - m_value_last_power_q16) < VALUE_DEADBAND_POWER_Q16)
+             && (ABS(snap.session_mm - m_value_last_dist_mm) < VALUE_DEADBAND_DIST_MM)
+             && ((snap.power_q16 != 0) || (m_value_last_power_q16 == 0)))
+    {
+        return;
+    }
+
+    // Power and distance always come from the same batch.
+    p_sled_value           = ble_sls_sled_value_back_get(&m_sls);
+    p_sled_value->power    = SLED_METRICS_Q16_TO_FLOAT(snap.power_q16);
+    p_sled_value->distance = (float)snap.session_mm / 1000.0f;
+    ble_sls_sled_value_publish(&m_sls);
+
+    // TX queue full is handled by the service; the link can drop before the client unsubscribes.
+    err_code = ble_sls_sled_value_notify(&m_sls);
+    if (err_code != NRF_ERROR_INVALID_STATE)
+    {
+        APP_ERROR_CHECK(err_code);
+    }
+
+    m_value_last_power_q16 = snap.power_q16;
+    m_value_last_dist_mm   = snap.session_mm;
+    m_value_sent           = !heartbeat;
+}
+
+/**@brief Function for publishing the pipeline output of one batch of reports.
+ */
+static void sled_batch_publish(void)
+{
+    sled_snapshot_data_t snap;
+    uint32_t             prof = sled_prof_start();
+
+    snap.time_us     = m_pipeline.time_us;
+    snap.session_mm  = odometer_session_mm(&m_pipeline.odometer);
+    snap.lifetime_mm = odometer_lifetime_mm(&m_pipeline.odometer);
+    snap.power_q16   = m_pipeline.power_q16;
+    snap.vel_q16     = m_pipeline.velocity.vel_q16;
+    snap.acc_q16     = m_pipeline.velocity.acc_q16;
+    snap.batch       = ++m_batches;
+    snap.moving      = m_pipeline.moving;
+    sled_snapshot_publish(&m_snapshot, &snap);
+
+    sled_link_activity_update(snap.moving);
+    sled_stream_update();
+    sled_value_send(false);
+
+    sled_prof_stop(SLED_PROF_NOTIFY, prof);
+}
+
+/**@brief Function for draining the QDEC FIFO in the main loop.
+ *
+ * @details Every report runs through the pipeline; the constant power control step and the
+ *          notifications run once per batch.
+ */
+static void qdec_reports_process(void)
 {
-  NRF_LOG_INFO("We have received the PWM value into our App: %d", pwm_value);
-  initPwm(pwm_value);
+    qdec_acq_sample_t sample;
+    uint32_t          prof = sled_prof_start();
+    uint32_t          prof_stage;
+
+    // Cleared first, so a report arriving while draining queues a new event.
+    m_qdec_evt_queued = false;
+
+    while (qdec_acq_sample_get(&sample))
+    {
+        prof_stage = sled_prof_start();
+        sled_pipeline_gap_add(&m_pipeline, sample.gap_us);
+        sled_pipeline_report_add(&m_pipeline, sample.range, sample.counts, sample.dt_us);
+        sled_prof_stop(SLED_PROF_POWER, prof_stage);
+    }
+
+    if (qdec_acq_batch_ready())
+    {
+        if (resistance_ctrl_is_enabled(&m_resistance_ctrl))
+        {
+            prof_stage = sled_prof_start();
+            pwmResistanceSet(resistance_ctrl_update(&m_resistance_ctrl,
+                                                    m_pipeline.power_q16,
+                                                    m_pipeline.batch_us,
+                                                    m_pipeline.moving));
+            sled_prof_stop(SLED_PROF_CTRL, prof_stage);
+        }
+        sled_batch_publish();
+        sled_pipeline_batch_begin(&m_pipeline);
+    }
+
+    sled_prof_stop(SLED_PROF_QDEC, prof);
+}
+
+/**@brief Function for dispatching application events, runs from @ref app_sched_execute.
+ *
+ * @param[in] p_event_data  Pointer to the @ref sled_evt_t.
+ * @param[in] event_size    Size of the event.
+ */
+static void sled_evt_dispatch(void * p_event_data, uint16_t event_size)
+{
+    sled_evt_t const * p_evt = (sled_evt_t const *)p_event_data;
+    ret_code_t         err_code;
+    uint32_t           prof;
+
+    UNUSED_PARAMETER(event_size);
+
+    switch (p_evt->type)
+    {
+        case SLED_EVT_QDEC_REPORT:
+            qdec_reports_process();
+            break;
+
+        case SLED_EVT_PWM_CMD:
+            sled_cmd_apply(&p_evt->cmd);
+            break;
+
+        case SLED_EVT_VALUE_HEARTBEAT:
+            prof = sled_prof_start();
+            sled_value_send(true);
+            sled_prof_stop(SLED_PROF_NOTIFY, prof);
+            break;
+
+        case SLED_EVT_VALUE_RESEND:
+            m_resend_evt_queued = false;
+            err_code = ble_sls_sled_value_resend(&m_sls);
+            if (err_code != NRF_ERROR_INVALID_STATE)
+            {
+                APP_ERROR_CHECK(err_code);
+            }
+            break;
+
+        case SLED_EVT_SESSION_RESET:
+            sled_pipeline_session_reset(&m_pipeline);
+            // Every connection gets its own profile window.
+            sled_prof_reset();
+            break;
+
+        case SLED_EVT_QDEC_SLEEP:
+            // No more batches run the link idle timeout until the sled moves again.
+            sled_link_idle_request();
+            break;
+
+        case SLED_EVT_PROF_LOG:
+            sled_prof_log();
+            break;
+
+        default:
+            break;
+    }
 }
 
 static void advertising_start(bool erase_bonds);
@@ -193,20 +616,34 @@ static void pm_evt_handler(pm_evt_t const * p_evt)
     }
 }
 
-/**@brief Function for handling the Encoder measurement timer timeout.
+/**@brief Function for handling the Sled Value heartbeat timer timeout.
  *
- * @details This function will be called each time the encoder timer expires.
+ * @param[in] p_context Unused.
+ */
+static void value_hb_timeout_handler(void * p_context)
+{
+    UNUSED_PARAMETER(p_context);
+    // A heartbeat lost to a full queue is covered by the next one.
+    (void)sled_evt_post(SLED_EVT_VALUE_HEARTBEAT);
+}
+
+
+/**@brief Function for handling the CPU profile log timer timeout.
  *
- * @param[in] p_context Pointer used for passing come arbitrary information (context) from the 
- *                      app_start_timer() call to the timeout handler.
+ * @param[in] p_context Unused.
  */
-static void qenc_meas_timeout_handler(void * p_context)
+static void prof_log_timeout_handler(void * p_context)
 {
     UNUSED_PARAMETER(p_context);
-    ret_code_t err_code;
-//    NRF_LOG_INFO("Updating Sled Power: %d", m_sled_power);
-    err_code = ble_sls_sled_value_update(&m_sls, send_data);
-    APP_ERROR_CHECK(err_code);
+    (void)sled_evt_post(SLED_EVT_PROF_LOG);
+}
+
+
+/**@brief Function for the Event Scheduler initialization.
+ */
+static void scheduler_init(void)
+{
+    APP_SCHED_INIT(SCHED_MAX_EVENT_DATA_SIZE, SCHED_QUEUE_SIZE);
 }
 
 
@@ -230,9 +667,14 @@ static void timers_init(void)
        err_code = app_timer_create(&m_app_timer_id, APP_TIMER_MODE_REPEATED, timer_timeout_handler);
        APP_ERROR_CHECK(err_code); */
 
-     err_code = app_timer_create(&m_qenc_timer_id,
+     err_code = app_timer_create(&m_value_hb_timer_id,
                                  APP_TIMER_MODE_REPEATED,
-                                 qenc_meas_timeout_handler);
+                                 value_hb_timeout_handler);
+     APP_ERROR_CHECK(err_code);
+
+     err_code = app_timer_create(&m_prof_timer_id,
+                                 APP_TIMER_MODE_REPEATED,
+                                 prof_log_timeout_handler);
      APP_ERROR_CHECK(err_code);
 }
 
@@ -271,11 +713,50 @@ static void gap_params_init(void)
 }
 
 
+/**@brief Function for handling events from the GATT library.
+ */
+static void gatt_evt_handler(nrf_ble_gatt_t * p_gatt, nrf_ble_gatt_evt_t const * p_evt)
+{
+    sled_link_on_gatt_evt(p_gatt, p_evt);
+}
+
+
+/**@brief Function for handling changes of the negotiated link parameters.
+ *
+ * @details Keeps the Sled Stream notification size in line with the negotiated ATT MTU.
+ */
+static void on_link_evt(sled_link_info_t const * p_info)
+{
+    ble_sls_att_mtu_set(&m_sls, p_info->att_mtu);
+}
+
+
 /**@brief Function for initializing the GATT module.
+ *
+ * @details The largest ATT MTU, data length and the 2M PHY are requested on every connection,
+ *          and the connection interval follows the telemetry load.
  */
 static void gatt_init(void)
 {
-    ret_code_t err_code = nrf_ble_gatt_init(&m_gatt, NULL);
+    sled_link_init_t link_init;
+
+    ret_code_t err_code = nrf_ble_gatt_init(&m_gatt, gatt_evt_handler);
+    APP_ERROR_CHECK(err_code);
+
+    memset(&link_init, 0, sizeof(link_init));
+
+    link_init.evt_handler                     = on_link_evt;
+    link_init.active_params.min_conn_interval = ACTIVE_MIN_CONN_INTERVAL;
+    link_init.active_params.max_conn_interval = ACTIVE_MAX_CONN_INTERVAL;
+    link_init.active_params.slave_latency     = ACTIVE_SLAVE_LATENCY;
+    link_init.active_params.conn_sup_timeout  = CONN_SUP_TIMEOUT;
+    link_init.idle_params.min_conn_interval   = MIN_CONN_INTERVAL;
+    link_init.idle_params.max_conn_interval   = MAX_CONN_INTERVAL;
+    link_init.idle_params.slave_latency       = SLAVE_LATENCY;
+    link_init.idle_params.conn_sup_timeout    = CONN_SUP_TIMEOUT;
+    link_init.idle_timeout                    = LINK_IDLE_TIMEOUT;
+
+    err_code = sled_link_init(&m_gatt, &link_init);
     APP_ERROR_CHECK(err_code);
 }
 
@@ -308,24 +789,123 @@ static void on_sls_evt(ble_sls_t     * p_sls_service,
     switch(p_evt->evt_type)
     {
         case BLE_SLS_EVT_CONNECTED:
+            err_code = sled_evt_post(SLED_EVT_SESSION_RESET);
+            APP_ERROR_CHECK(err_code);
+            m_value_notifying  = false;
+            m_stream_notifying = false;
             break;
 
         case BLE_SLS_EVT_DISCONNECTED:
             break;
 
         case BLE_SLS_EVT_NOTIFICATION_ENABLED:
-            err_code = app_timer_start(m_qenc_timer_id, QENC_MEAS_INTERVAL, NULL);
+            err_code = app_timer_start(m_value_hb_timer_id, VALUE_HEARTBEAT_INTERVAL, NULL);
             APP_ERROR_CHECK(err_code);
+            m_value_notifying = true;
+            m_value_sent      = false;
+            // A new subscriber gets the current value right away.
+            (void)sled_evt_post(SLED_EVT_VALUE_HEARTBEAT);
             break;
 
         case BLE_SLS_EVT_NOTIFICATION_DISABLED:
-            err_code = app_timer_stop(m_qenc_timer_id);
+            err_code = app_timer_stop(m_value_hb_timer_id);
             APP_ERROR_CHECK(err_code);
+            m_value_notifying = false;
+            break;
+
+        case BLE_SLS_EVT_STREAM_ENABLED:
+            NRF_LOG_INFO("Sled Stream enabled.");
+            m_stream_notifying = true;
             break;
+
+        case BLE_SLS_EVT_STREAM_DISABLED:
+            m_stream_notifying = false;
+            break;
+
+        case BLE_SLS_EVT_TX_READY:
+            if (!m_resend_evt_queued && (sled_evt_post(SLED_EVT_VALUE_RESEND) == NRF_SUCCESS))
+            {
+                m_resend_evt_queued = true;
+            }
+            break;
+
         default:
             // No implementation needed.
             break;
     }
+
+    sled_link_notify_set(m_value_notifying || m_stream_notifying);
+}
+
+// The QDEC resolves one transition per sample and flags two as a double; three look like one
+// count backwards. The sample period must keep the top speed below two transitions per sample.
+// The fastest acquisition range is the one used at top speed.
+STATIC_ASSERT(QENC_MAX_COUNTS_PER_S * QDEC_ACQ_FAST_SAMPLE_US < 2 * 1000000);
+STATIC_ASSERT(QDEC_ACQ_RANGE_COUNT <= SLED_PIPELINE_RANGE_MAX);
+STATIC_ASSERT(QDEC_ACQ_RANGE_COUNT <= SLED_VELOCITY_RANGE_MAX);
+
+STATIC_ASSERT(SLED_PROF_ENCODED_LEN <= BLE_DGS_VALUE_MAX_LEN);
+STATIC_ASSERT(BLE_DGS_COUNTERS_LEN <= BLE_DGS_VALUE_MAX_LEN);
+
+/**@brief Function for encoding the Diagnostics Service Counters value.
+ *
+ * @details Only copies counters the modules keep anyway, so it is cheap to leave in production.
+ *
+ * @return  Length of the value, @ref BLE_DGS_COUNTERS_LEN.
+ */
+static uint16_t diag_counters_encode(uint8_t * p_buf)
+{
+    qdec_acq_stats_t           qdec_stats;
+    ble_sls_tx_stats_t         tx_stats;
+    sled_link_info_t const *   p_link = sled_link_info_get();
+    uint16_t                   len    = 0;
+
+    qdec_acq_stats_get(&qdec_stats);
+
+    CRITICAL_REGION_ENTER();
+    tx_stats = *ble_sls_tx_stats_get(&m_sls);
+    CRITICAL_REGION_EXIT();
+
+    len += uint32_encode(qdec_stats.reports,   &p_buf[len]);
+    len += uint32_encode(qdec_stats.accdbl,    &p_buf[len]);
+    len += uint32_encode(qdec_stats.overflows, &p_buf[len]);
+    len += uint32_encode(qdec_stats.sleeps,    &p_buf[len]);
+    len += uint32_encode(tx_stats.queued,      &p_buf[len]);
+    len += uint32_encode(tx_stats.sent,        &p_buf[len]);
+    len += uint32_encode(tx_stats.deferred,    &p_buf[len]);
+    len += uint32_encode(tx_stats.coalesced,   &p_buf[len]);
+    len += uint32_encode(tx_stats.dropped,     &p_buf[len]);
+    len += uint32_encode(m_sls.cmd_seq_gaps,   &p_buf[len]);
+    p_buf[len++] = tx_stats.outstanding_max;
+    p_buf[len++] = (uint8_t)app_sched_queue_utilization_get();
+    len += uint16_encode(p_link->att_mtu,       &p_buf[len]);
+    len += uint16_encode(p_link->data_len,      &p_buf[len]);
+    p_buf[len++] = p_link->tx_phy;
+    p_buf[len++] = p_link->rx_phy;
+    len += uint16_encode(p_link->conn_interval, &p_buf[len]);
+    len += uint16_encode(p_link->slave_latency, &p_buf[len]);
+    len += uint32_encode(qdec_stats.accdbl_saturated, &p_buf[len]);
+
+    return len;
+}
+
+/**@brief Function for building the value of a Diagnostics Service characteristic.
+ *
+ * @details Called in SoftDevice context when a client reads the characteristic.
+ */
+static uint16_t dgs_read_handler(ble_dgs_char_t characteristic, uint8_t * p_buf)
+{
+    switch (characteristic)
+    {
+        case BLE_DGS_CHAR_PROFILE:
+            return sled_prof_encode(p_buf);
+
+        case BLE_DGS_CHAR_COUNTERS:
+            return diag_counters_encode(p_buf);
+
+        default:
+            return 0;
+    }
 }
 
 /**@brief Function for initializing services that will be used by the application.
@@ -344,7 +924,8 @@ static void services_init(void)
     // Initialize SLS Service init structure to zero
     ble_sls_init_t     sls_init;
     memset(&sls_init, 0, sizeof(sls_init));
-    sls_init.char_pwm_value_write_handler = char_pwm_write_handler;
+    sls_init.cmd_handler = sled_cmd_handler;
+    sls_init.stream_max_latency = STREAM_MAX_LATENCY;
 
     // Set the sls evt handler
     sls_init.evt_handler = on_sls_evt;
@@ -354,6 +935,13 @@ static void services_init(void)
     
     err_code = ble_sls_init(&m_sls, &sls_init);
     APP_ERROR_CHECK(err_code);
+
+    ble_dgs_init_t const dgs_init =
+    {
+        .read_handler = dgs_read_handler
+    };
+    err_code = ble_dgs_init(&m_dgs, &dgs_init);
+    APP_ERROR_CHECK(err_code);
 }
 
 
@@ -361,9 +949,8 @@ static void services_init(void)
  *
  * @details This function will be called for all events in the Connection Parameters Module which
  *          are passed to the application.
- *          @note All this function does is to disconnect. This could have been done by simply
- *                setting the disconnect_on_fail config parameter, but instead we use the event
- *                handler mechanism to demonstrate its use.
+ *          @note A central refusing the short active interval is not a reason to drop the link,
+ *                only a failure to agree on the idle parameters disconnects.
  *
  * @param[in] p_evt  Event received from the Connection Parameters Module.
  */
@@ -371,7 +958,8 @@ static void on_conn_params_evt(ble_conn_params_evt_t * p_evt)
 {
     ret_code_t err_code;
 
-    if (p_evt->evt_type == BLE_CONN_PARAMS_EVT_FAILED)
+    if ((p_evt->evt_type == BLE_CONN_PARAMS_EVT_FAILED)
+        && (sled_link_info_get()->mode == SLED_LINK_MODE_IDLE))
     {
         err_code = sd_ble_gap_disconnect(m_conn_handle, BLE_HCI_CONN_INTERVAL_UNACCEPTABLE);
         APP_ERROR_CHECK(err_code);
@@ -419,6 +1007,8 @@ static void application_timers_start(void)
     ret_code_t err_code;
 
     // Start application timers.
+    err_code = app_timer_start(m_prof_timer_id, PROF_LOG_INTERVAL, NULL);
+    APP_ERROR_CHECK(err_code);
 }
 
 
@@ -719,7 +1309,7 @@ static void idle_state_handle(void)
 {
     if (NRF_LOG_PROCESS() == false)
     {
-        nrf_pwr_mgmt_run();
+        sled_prof_sleep();
     }
 }
 
@@ -742,38 +1332,19 @@ static void advertising_start(bool erase_bonds)
 }
 
 
-
-/**@brief Callback function for QDEC event.
- */
-static void qdec_event_handler(nrf_drv_qdec_event_t event)
-{
-  if (event.type == NRF_QDEC_EVENT_REPORTRDY)
-  {
-    /*set the accumulator values*/
-    m_accdblread          = event.data.report.accdbl;
-    m_accread             = event.data.report.acc;
-    m_report_ready_flag   = true;
-    
-    nrf_drv_qdec_disable();
-  }
-}
-
 /**@brief Function for application main entry.
  */
 int main(void)
 {
     uint32_t err_code;
-    uint32_t temp;
-    float cpr = 256 * 4;
     bool erase_bonds;
-    float m_sled_power;
-    float m_sled_dist;
-    float total_counts = 0;
-    float period;
+    uint32_t qdec_period_us[QDEC_ACQ_RANGE_COUNT];
 
     // Initialize BLE.
     log_init();
     timers_init();
+    sled_prof_init();
+    scheduler_init();
     buttons_leds_init(&erase_bonds);
     power_management_init();
     ble_stack_init();
@@ -788,43 +1359,45 @@ int main(void)
     err_code = NRF_LOG_INIT(NULL);
     APP_ERROR_CHECK(err_code);
 
-    err_code = nrf_drv_qdec_init(NULL, qdec_event_handler);
+    resistance_ctrl_config_t const res_ctrl_config =
+    {
+        .kp       = RES_CTRL_KP,
+        .ki       = RES_CTRL_KI,
+        .duty_min = RES_CTRL_DUTY_MIN,
+        .duty_max = RES_CTRL_DUTY_MAX
+    };
+    err_code = resistance_ctrl_init(&m_resistance_ctrl, &res_ctrl_config);
     APP_ERROR_CHECK(err_code);
-    nrf_qdec_dbfen_enable();
-    
-    NRF_LOG_INFO("QDEC initialized.");
+
+    qdec_acq_init_t const qdec_init =
+    {
+        .evt_handler     = qdec_acq_evt_handler,
+        .idle_timeout_us = QENC_IDLE_TIMEOUT_US
+    };
+    err_code = qdec_acq_init(&qdec_init);
+    APP_ERROR_CHECK(err_code);
+
+    for (uint8_t i = 0; i < QDEC_ACQ_RANGE_COUNT; i++)
+    {
+        qdec_period_us[i] = qdec_acq_range_get(i)->period_us;
+    }
+    err_code = sled_pipeline_init(&m_pipeline, QENC_COUNTS_PER_REV, qdec_period_us, QDEC_ACQ_RANGE_COUNT,
+                                  QENC_VELOCITY_TAU_US);
+    APP_ERROR_CHECK(err_code);
+    sled_snapshot_init(&m_snapshot);
 
     // Start execution.
     NRF_LOG_INFO("RAPTR is online.");
     application_timers_start();
 
     advertising_start(erase_bonds);
+    qdec_acq_start();
 
-    // Enter main loop.
+    // Enter main loop. Interrupt handlers only queue events, the CPU sleeps once the queue drains.
     for (;;)
     {
-      idle_state_handle();
-      nrf_drv_qdec_enable();        // start burst sampling clock, clock will be stopped by REPORTRDY event
-      while (!m_report_ready_flag)  // wait for a report
-      {
-       __WFE();
-      }
-      // Calculate the power in watts
-      period = nrf_qdec_sampleper_to_value(nrf_qdec_sampleper_reg_get())*.000001
-              *nrf_qdec_reportper_to_value(nrf_qdec_reportper_reg_get());
-
-      m_sled_power = 0.001735*pow(m_accread/period * (1/cpr) * 2 * M_PI, 2);
-
-      // Calculate the distance in meters
-      total_counts += m_accread;
-      m_sled_dist = total_counts*(1/cpr)*0.99745;
-
-      memcpy(&send_data, &m_sled_power, sizeof(uint32_t));
-      memcpy(&temp, &m_sled_dist, sizeof(uint32_t));
-      send_data = send_data << 32 | temp;
-
-      m_report_ready_flag = false;
-      NRF_LOG_FLUSH();
+        app_sched_execute();
+        idle_state_handle();
     }
 }
 
@@ -0,0 +1,28 @@
+/**@file
+ * @brief Host stand-in for app_error.h, an error ends the simulation run.
+ */
+#ifndef APP_ERROR_H__
+#define APP_ERROR_H__
+
+#include <stdint.h>
+#include "sdk_errors.h"
+
+void app_error_handler(ret_code_t error_code, uint32_t line_num, const uint8_t * p_file_name);
+
+#define APP_ERROR_HANDLER(ERR_CODE)                                         \
+    do                                                                      \
+    {                                                                       \
+        app_error_handler((ERR_CODE), __LINE__, (uint8_t const *)__FILE__); \
+    } while (0)
+
+#define APP_ERROR_CHECK(ERR_CODE)                           \
+    do                                                      \
+    {                                                       \
+        const uint32_t LOCAL_ERR_CODE = (ERR_CODE);         \
+        if (LOCAL_ERR_CODE != NRF_SUCCESS)                  \
+        {                                                   \
+            APP_ERROR_HANDLER(LOCAL_ERR_CODE);              \
+        }                                                   \
+    } while (0)
+
+#endif /* APP_ERROR_H__ */
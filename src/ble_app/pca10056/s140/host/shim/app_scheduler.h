@@ -0,0 +1,38 @@
+/**@file
+ * @brief Host stand-in for app_scheduler.h, same queue semantics as the SDK module.
+ */
+#ifndef APP_SCHEDULER_H__
+#define APP_SCHEDULER_H__
+
+#include <stdint.h>
+#include "sdk_errors.h"
+#include "app_error.h"
+#include "app_util.h"
+
+typedef void (*app_sched_event_handler_t)(void * p_event_data, uint16_t event_size);
+
+typedef struct
+{
+    app_sched_event_handler_t handler;
+    uint16_t                  event_data_size;
+} app_sched_event_header_t;
+
+#define APP_SCHED_BUF_SIZE(EVENT_SIZE, QUEUE_SIZE)                                              \
+            (((EVENT_SIZE) + sizeof(app_sched_event_header_t)) * ((QUEUE_SIZE) + 1))
+
+#define APP_SCHED_INIT(EVENT_SIZE, QUEUE_SIZE)                                                  \
+    do                                                                                          \
+    {                                                                                           \
+        static uint32_t APP_SCHED_BUF[CEIL_DIV(APP_SCHED_BUF_SIZE((EVENT_SIZE), (QUEUE_SIZE)),  \
+                                               sizeof(uint32_t))];                              \
+        uint32_t ERR_CODE = app_sched_init((EVENT_SIZE), (QUEUE_SIZE), APP_SCHED_BUF);          \
+        APP_ERROR_CHECK(ERR_CODE);                                                              \
+    } while (0)
+
+uint32_t app_sched_init(uint16_t max_event_size, uint16_t queue_size, void * p_evt_buffer);
+void     app_sched_execute(void);
+uint32_t app_sched_event_put(void const * p_event_data, uint16_t event_size,
+                             app_sched_event_handler_t handler);
+uint16_t app_sched_queue_utilization_get(void);
+
+#endif /* APP_SCHEDULER_H__ */
@@ -0,0 +1,55 @@
+/**@file
+ * @brief Host stand-in for app_util.h, only the helpers the application uses.
+ */
+#ifndef APP_UTIL_H__
+#define APP_UTIL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "nordic_common.h"
+
+#define STATIC_ASSERT(EXPR)     _Static_assert((EXPR), "static assert failed")
+
+#define ABS(a)                  (((a) < 0) ? -(a) : (a))
+
+#define ROUNDED_DIV(A, B)       (((A) + ((B) / 2)) / (B))
+#define CEIL_DIV(A, B)          (((A) + (B) - 1) / (B))
+#define ARRAY_SIZE(arr)         (sizeof(arr) / sizeof((arr)[0]))
+
+#define UNIT_0_625_MS           625
+#define UNIT_1_25_MS            1250
+#define UNIT_10_MS              10000
+#define MSEC_TO_UNITS(TIME, RESOLUTION) (((TIME) * 1000) / (RESOLUTION))
+
+#define __INLINE                inline
+
+static inline uint8_t uint16_encode(uint16_t value, uint8_t * p_encoded_data)
+{
+    p_encoded_data[0] = (uint8_t)((value & 0x00FF) >> 0);
+    p_encoded_data[1] = (uint8_t)((value & 0xFF00) >> 8);
+    return sizeof(uint16_t);
+}
+
+static inline uint8_t uint32_encode(uint32_t value, uint8_t * p_encoded_data)
+{
+    p_encoded_data[0] = (uint8_t)((value & 0x000000FF) >> 0);
+    p_encoded_data[1] = (uint8_t)((value & 0x0000FF00) >> 8);
+    p_encoded_data[2] = (uint8_t)((value & 0x00FF0000) >> 16);
+    p_encoded_data[3] = (uint8_t)((value & 0xFF000000) >> 24);
+    return sizeof(uint32_t);
+}
+
+static inline uint16_t uint16_decode(uint8_t const * p_encoded_data)
+{
+    return (uint16_t)((((uint16_t)p_encoded_data[0])) | (((uint16_t)p_encoded_data[1]) << 8));
+}
+
+static inline uint32_t uint32_decode(uint8_t const * p_encoded_data)
+{
+    return ((((uint32_t)p_encoded_data[0]) << 0)  |
+            (((uint32_t)p_encoded_data[1]) << 8)  |
+            (((uint32_t)p_encoded_data[2]) << 16) |
+            (((uint32_t)p_encoded_data[3]) << 24));
+}
+
+#endif /* APP_UTIL_H__ */
@@ -0,0 +1,28 @@
+/**@file
+ * @brief Host stand-in for app_util_platform.h.
+ *
+ * @details Interrupt handlers only run while the main loop waits in nrf_pwr_mgmt_run, so a
+ *          critical region only has to be tracked, and waiting inside one fails the run.
+ */
+#ifndef APP_UTIL_PLATFORM_H__
+#define APP_UTIL_PLATFORM_H__
+
+#include <stdint.h>
+#include "nrf.h"
+#include "app_util.h"
+
+#define APP_IRQ_PRIORITY_HIGHEST    2
+#define APP_IRQ_PRIORITY_HIGH       3
+#define APP_IRQ_PRIORITY_MID        4
+#define APP_IRQ_PRIORITY_LOW_MID    5
+#define APP_IRQ_PRIORITY_LOW        6
+#define APP_IRQ_PRIORITY_LOWEST     7
+#define APP_IRQ_PRIORITY_THREAD     15
+
+void sim_critical_region_enter(void);
+void sim_critical_region_exit(void);
+
+#define CRITICAL_REGION_ENTER() { sim_critical_region_enter();
+#define CRITICAL_REGION_EXIT()    sim_critical_region_exit(); }
+
+#endif /* APP_UTIL_PLATFORM_H__ */
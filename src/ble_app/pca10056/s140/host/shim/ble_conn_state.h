@@ -0,0 +1,7 @@
+/**@file
+ * @brief Host stand-in for ble_conn_state.h, unused by the application.
+ */
+#ifndef BLE_CONN_STATE_H__
+#define BLE_CONN_STATE_H__
+
+#endif /* BLE_CONN_STATE_H__ */
@@ -0,0 +1,150 @@
+/**@file
+ * @brief Host stand-in for the SoftDevice ble_gap.h, the peripheral role only.
+ */
+#ifndef BLE_GAP_H__
+#define BLE_GAP_H__
+
+#include <stdint.h>
+#include "ble_types.h"
+
+enum BLE_GAP_EVTS
+{
+    BLE_GAP_EVT_CONNECTED = 0x10,
+    BLE_GAP_EVT_DISCONNECTED,
+    BLE_GAP_EVT_CONN_PARAM_UPDATE,
+    BLE_GAP_EVT_SEC_PARAMS_REQUEST,
+    BLE_GAP_EVT_PHY_UPDATE_REQUEST = 0x21,
+    BLE_GAP_EVT_PHY_UPDATE,
+    BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST,
+    BLE_GAP_EVT_DATA_LENGTH_UPDATE
+};
+
+#define BLE_GAP_PHY_AUTO                            0x00
+#define BLE_GAP_PHY_1MBPS                           0x01
+#define BLE_GAP_PHY_2MBPS                           0x02
+#define BLE_GAP_PHY_CODED                           0x04
+
+#define BLE_GAP_DATA_LENGTH_DEFAULT                 27
+#define BLE_GAP_IO_CAPS_NONE                        0x03
+#define BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE 0x06
+
+#define BLE_GAP_CONN_SEC_MODE_SET_NO_ACCESS(ptr)    do { (ptr)->sm = 0; (ptr)->lv = 0; } while (0)
+#define BLE_GAP_CONN_SEC_MODE_SET_OPEN(ptr)         do { (ptr)->sm = 1; (ptr)->lv = 1; } while (0)
+
+typedef struct
+{
+    uint8_t sm : 4;
+    uint8_t lv : 4;
+} ble_gap_conn_sec_mode_t;
+
+typedef struct
+{
+    uint16_t min_conn_interval;
+    uint16_t max_conn_interval;
+    uint16_t slave_latency;
+    uint16_t conn_sup_timeout;
+} ble_gap_conn_params_t;
+
+typedef struct
+{
+    uint8_t tx_phys;
+    uint8_t rx_phys;
+} ble_gap_phys_t;
+
+typedef struct
+{
+    uint8_t enc  : 1;
+    uint8_t id   : 1;
+    uint8_t sign : 1;
+    uint8_t link : 1;
+} ble_gap_sec_kdist_t;
+
+typedef struct
+{
+    uint8_t             bond     : 1;
+    uint8_t             mitm     : 1;
+    uint8_t             lesc     : 1;
+    uint8_t             keypress : 1;
+    uint8_t             io_caps  : 3;
+    uint8_t             oob      : 1;
+    uint8_t             min_key_size;
+    uint8_t             max_key_size;
+    ble_gap_sec_kdist_t kdist_own;
+    ble_gap_sec_kdist_t kdist_peer;
+} ble_gap_sec_params_t;
+
+typedef struct
+{
+    uint16_t max_tx_octets;
+    uint16_t max_rx_octets;
+    uint16_t max_tx_time_us;
+    uint16_t max_rx_time_us;
+} ble_gap_data_length_params_t;
+
+typedef struct
+{
+    uint16_t tx_payload_limited_octets;
+    uint16_t rx_payload_limited_octets;
+    uint16_t tx_rx_time_limited_us;
+} ble_gap_data_length_limitation_t;
+
+typedef struct
+{
+    uint8_t               role;
+    ble_gap_conn_params_t conn_params;
+} ble_gap_evt_connected_t;
+
+typedef struct
+{
+    uint8_t reason;
+} ble_gap_evt_disconnected_t;
+
+typedef struct
+{
+    ble_gap_conn_params_t conn_params;
+} ble_gap_evt_conn_param_update_t;
+
+typedef struct
+{
+    ble_gap_phys_t peer_preferred_phys;
+} ble_gap_evt_phy_update_request_t;
+
+typedef struct
+{
+    uint8_t status;
+    uint8_t tx_phy;
+    uint8_t rx_phy;
+} ble_gap_evt_phy_update_t;
+
+typedef struct
+{
+    ble_gap_data_length_params_t effective_params;
+} ble_gap_evt_data_length_update_t;
+
+typedef struct
+{
+    uint16_t conn_handle;
+    union
+    {
+        ble_gap_evt_connected_t          connected;
+        ble_gap_evt_disconnected_t       disconnected;
+        ble_gap_evt_conn_param_update_t  conn_param_update;
+        ble_gap_evt_phy_update_request_t phy_update_request;
+        ble_gap_evt_phy_update_t         phy_update;
+        ble_gap_evt_data_length_update_t data_length_update;
+    } params;
+} ble_gap_evt_t;
+
+uint32_t sd_ble_gap_device_name_set(ble_gap_conn_sec_mode_t const * p_write_perm,
+                                    uint8_t const * p_dev_name, uint16_t len);
+uint32_t sd_ble_gap_appearance_set(uint16_t appearance);
+uint32_t sd_ble_gap_ppcp_set(ble_gap_conn_params_t const * p_conn_params);
+uint32_t sd_ble_gap_ppcp_get(ble_gap_conn_params_t * p_conn_params);
+uint32_t sd_ble_gap_phy_update(uint16_t conn_handle, ble_gap_phys_t const * p_gap_phys);
+uint32_t sd_ble_gap_disconnect(uint16_t conn_handle, uint8_t hci_status_code);
+uint32_t sd_ble_gap_conn_param_update(uint16_t conn_handle, ble_gap_conn_params_t const * p_conn_params);
+uint32_t sd_ble_gap_data_length_update(uint16_t                                 conn_handle,
+                                       ble_gap_data_length_params_t const *     p_dl_params,
+                                       ble_gap_data_length_limitation_t *       p_dl_limitation);
+
+#endif /* BLE_GAP_H__ */
@@ -0,0 +1,42 @@
+/**@file
+ * @brief Host stand-in for the SoftDevice ble_gatt.h.
+ */
+#ifndef BLE_GATT_H__
+#define BLE_GATT_H__
+
+#include <stdint.h>
+
+#define BLE_GATT_ATT_MTU_DEFAULT                        23
+#define BLE_GATT_HANDLE_INVALID                         0x0000
+
+#define BLE_GATT_HVX_NOTIFICATION                       0x01
+#define BLE_GATT_HVX_INDICATION                         0x02
+
+#define BLE_GATT_STATUS_SUCCESS                         0x0000
+#define BLE_GATT_STATUS_ATTERR_INVALID_HANDLE           0x0101
+#define BLE_GATT_STATUS_ATTERR_READ_NOT_PERMITTED       0x0102
+#define BLE_GATT_STATUS_ATTERR_WRITE_NOT_PERMITTED      0x0103
+#define BLE_GATT_STATUS_ATTERR_REQUEST_NOT_SUPPORTED    0x0106
+#define BLE_GATT_STATUS_ATTERR_INVALID_ATT_VAL_LENGTH   0x010D
+#define BLE_GATT_STATUS_ATTERR_APP_BEGIN                0x0180
+
+#define BLE_GATT_TIMEOUT_SRC_PROTOCOL                   0x00
+
+typedef struct
+{
+    uint8_t broadcast      : 1;
+    uint8_t read           : 1;
+    uint8_t write_wo_resp  : 1;
+    uint8_t write          : 1;
+    uint8_t notify         : 1;
+    uint8_t indicate       : 1;
+    uint8_t auth_signed_wr : 1;
+} ble_gatt_char_props_t;
+
+typedef struct
+{
+    uint8_t reliable_wr : 1;
+    uint8_t wr_aux      : 1;
+} ble_gatt_char_ext_props_t;
+
+#endif /* BLE_GATT_H__ */
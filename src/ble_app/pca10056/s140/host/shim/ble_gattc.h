@@ -0,0 +1,37 @@
+/**@file
+ * @brief Host stand-in for the SoftDevice ble_gattc.h, only the ATT MTU exchange.
+ */
+#ifndef BLE_GATTC_H__
+#define BLE_GATTC_H__
+
+#include <stdint.h>
+
+enum BLE_GATTC_EVTS
+{
+    BLE_GATTC_EVT_EXCHANGE_MTU_RSP = 0x3A,
+    BLE_GATTC_EVT_TIMEOUT
+};
+
+typedef struct
+{
+    uint16_t server_rx_mtu;
+} ble_gattc_evt_exchange_mtu_rsp_t;
+
+typedef struct
+{
+    uint8_t src;
+} ble_gattc_evt_timeout_t;
+
+typedef struct
+{
+    uint16_t conn_handle;
+    union
+    {
+        ble_gattc_evt_exchange_mtu_rsp_t exchange_mtu_rsp;
+        ble_gattc_evt_timeout_t          timeout;
+    } params;
+} ble_gattc_evt_t;
+
+uint32_t sd_ble_gattc_exchange_mtu_request(uint16_t conn_handle, uint16_t client_rx_mtu);
+
+#endif /* BLE_GATTC_H__ */
@@ -0,0 +1,13 @@
+/**@file
+ * @brief Host stand-in for the SoftDevice ble_hci.h.
+ */
+#ifndef BLE_HCI_H__
+#define BLE_HCI_H__
+
+#define BLE_HCI_STATUS_CODE_SUCCESS                 0x00
+#define BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION   0x13
+#define BLE_HCI_LOCAL_HOST_TERMINATED_CONNECTION    0x16
+#define BLE_HCI_UNSUPPORTED_REMOTE_FEATURE          0x1A
+#define BLE_HCI_CONN_INTERVAL_UNACCEPTABLE          0x3B
+
+#endif /* BLE_HCI_H__ */
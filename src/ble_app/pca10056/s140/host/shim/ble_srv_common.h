@@ -0,0 +1,26 @@
+/**@file
+ * @brief Host stand-in for ble_srv_common.h.
+ */
+#ifndef BLE_SRV_COMMON_H__
+#define BLE_SRV_COMMON_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble.h"
+#include "app_util.h"
+
+typedef void (*ble_srv_error_handler_t)(uint32_t nrf_error);
+
+typedef struct
+{
+    ble_gap_conn_sec_mode_t cccd_write_perm;
+    ble_gap_conn_sec_mode_t read_perm;
+    ble_gap_conn_sec_mode_t write_perm;
+} ble_srv_cccd_security_mode_t;
+
+static inline bool ble_srv_is_notification_enabled(uint8_t const * p_encoded_data)
+{
+    return (uint16_decode(p_encoded_data) & BLE_GATT_HVX_NOTIFICATION) != 0;
+}
+
+#endif /* BLE_SRV_COMMON_H__ */
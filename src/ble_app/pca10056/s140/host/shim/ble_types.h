@@ -0,0 +1,33 @@
+/**@file
+ * @brief Host stand-in for the SoftDevice ble_types.h.
+ */
+#ifndef BLE_TYPES_H__
+#define BLE_TYPES_H__
+
+#include <stdint.h>
+#include "nrf_error.h"
+
+#define BLE_CONN_HANDLE_INVALID             0xFFFF
+
+#define BLE_UUID_TYPE_UNKNOWN               0x00
+#define BLE_UUID_TYPE_BLE                   0x01
+#define BLE_UUID_TYPE_VENDOR_BEGIN          0x02
+
+#define BLE_ERROR_NOT_ENABLED               (NRF_ERROR_STK_BASE_NUM + 0x001)
+#define BLE_ERROR_INVALID_CONN_HANDLE       (NRF_ERROR_STK_BASE_NUM + 0x002)
+#define BLE_ERROR_INVALID_ATTR_HANDLE       (NRF_ERROR_STK_BASE_NUM + 0x003)
+#define BLE_ERROR_GATTS_INVALID_ATTR_TYPE   (NRF_ERROR_STK_BASE_NUM + 0x400)
+#define BLE_ERROR_GATTS_SYS_ATTR_MISSING    (NRF_ERROR_STK_BASE_NUM + 0x401)
+
+typedef struct
+{
+    uint8_t uuid128[16];
+} ble_uuid128_t;
+
+typedef struct
+{
+    uint16_t uuid;
+    uint8_t  type;
+} ble_uuid_t;
+
+#endif /* BLE_TYPES_H__ */
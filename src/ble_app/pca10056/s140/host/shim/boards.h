@@ -0,0 +1,14 @@
+/**@file
+ * @brief Host stand-in for boards.h, the PCA10056 pins the application uses.
+ */
+#ifndef BOARDS_H
+#define BOARDS_H
+
+#include "nrf_gpio.h"
+
+#define LED_3           NRF_GPIO_PIN_MAP(0, 15)
+#define LED_4           NRF_GPIO_PIN_MAP(0, 16)
+#define ARDUINO_12_PIN  NRF_GPIO_PIN_MAP(1, 14)
+#define ARDUINO_13_PIN  NRF_GPIO_PIN_MAP(1, 15)
+
+#endif /* BOARDS_H */
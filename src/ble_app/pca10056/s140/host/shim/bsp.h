@@ -0,0 +1,49 @@
+/**@file
+ * @brief Host stand-in for bsp.h, the board has no buttons or LEDs on the host.
+ */
+#ifndef BSP_H__
+#define BSP_H__
+
+#include <stdint.h>
+#include "boards.h"
+
+#define BSP_INIT_NONE       0
+#define BSP_INIT_LEDS       (1 << 0)
+#define BSP_INIT_BUTTONS    (1 << 1)
+
+typedef enum
+{
+    BSP_EVENT_NOTHING = 0,
+    BSP_EVENT_DEFAULT,
+    BSP_EVENT_CLEAR_BONDING_DATA,
+    BSP_EVENT_CLEAR_ALERT,
+    BSP_EVENT_DISCONNECT,
+    BSP_EVENT_ADVERTISING_START,
+    BSP_EVENT_ADVERTISING_STOP,
+    BSP_EVENT_WHITELIST_OFF,
+    BSP_EVENT_BOND,
+    BSP_EVENT_RESET,
+    BSP_EVENT_SLEEP,
+    BSP_EVENT_WAKEUP,
+    BSP_EVENT_SYSOFF,
+    BSP_EVENT_DFU
+} bsp_event_t;
+
+typedef enum
+{
+    BSP_INDICATE_IDLE = 0,
+    BSP_INDICATE_SCANNING,
+    BSP_INDICATE_ADVERTISING,
+    BSP_INDICATE_ADVERTISING_WHITELIST,
+    BSP_INDICATE_ADVERTISING_SLOW,
+    BSP_INDICATE_ADVERTISING_DIRECTED,
+    BSP_INDICATE_BONDING,
+    BSP_INDICATE_CONNECTED
+} bsp_indication_t;
+
+typedef void (*bsp_event_callback_t)(bsp_event_t);
+
+uint32_t bsp_init(uint32_t type, bsp_event_callback_t callback);
+uint32_t bsp_indication_set(bsp_indication_t indicate);
+
+#endif /* BSP_H__ */
@@ -0,0 +1,16 @@
+/**@file
+ * @brief Host stand-in for bsp_btn_ble.h.
+ */
+#ifndef BSP_BTN_BLE_H__
+#define BSP_BTN_BLE_H__
+
+#include <stdint.h>
+#include "bsp.h"
+#include "sdk_errors.h"
+
+typedef void (*bsp_btn_ble_error_handler_t)(uint32_t nrf_error);
+
+ret_code_t bsp_btn_ble_init(bsp_btn_ble_error_handler_t error_handler, bsp_event_t * p_startup_bsp_evt);
+ret_code_t bsp_btn_ble_sleep_mode_prepare(void);
+
+#endif /* BSP_BTN_BLE_H__ */
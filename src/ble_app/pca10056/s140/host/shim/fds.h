@@ -0,0 +1,7 @@
+/**@file
+ * @brief Host stand-in for fds.h, flash storage is not simulated.
+ */
+#ifndef FDS_H__
+#define FDS_H__
+
+#endif /* FDS_H__ */
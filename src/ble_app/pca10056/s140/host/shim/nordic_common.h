@@ -0,0 +1,22 @@
+/**@file
+ * @brief Host stand-in for nordic_common.h, only the macros the application uses.
+ */
+#ifndef NORDIC_COMMON_H__
+#define NORDIC_COMMON_H__
+
+#ifndef MIN
+#define MIN(a, b)   (((a) < (b)) ? (a) : (b))
+#endif
+
+#ifndef MAX
+#define MAX(a, b)   (((a) < (b)) ? (b) : (a))
+#endif
+
+#define UNUSED_PARAMETER(X)     ((void)(X))
+#define UNUSED_VARIABLE(X)      ((void)(X))
+#define UNUSED_RETURN_VALUE(X)  ((void)(X))
+
+#define STRINGIFY_(val)         #val
+#define STRINGIFY(val)          STRINGIFY_(val)
+
+#endif /* NORDIC_COMMON_H__ */
@@ -0,0 +1,56 @@
+/**@file
+ * @brief Host stand-in for nrf.h, the core registers the application touches.
+ *
+ * @details Reads of DWT->CYCCNT return the host clock scaled to the 64 MHz core clock, so the
+ *          profiled stages measure host execution time. Writes to DWT and CoreDebug go nowhere.
+ */
+#ifndef NRF_H__
+#define NRF_H__
+
+#include <stdint.h>
+
+#ifndef __INLINE
+#define __INLINE                    inline
+#endif
+
+#define __DMB()                     __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+typedef struct
+{
+    uint32_t CTRL;
+    uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk      (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk  (1UL << 24)
+
+uint32_t sim_cyccnt_get(void);
+
+#define DWT                         (&(DWT_Type){ .CYCCNT = sim_cyccnt_get() })
+#define CoreDebug                   (&(CoreDebug_Type){ 0 })
+
+extern uint32_t SystemCoreClock;
+
+/**@brief PWM registers, only the sequence registers and PWMPERIODEND. PTR is pointer sized on the host. */
+typedef struct
+{
+    uint32_t EVENTS_PWMPERIODEND;
+    struct
+    {
+        uintptr_t PTR;
+        uint32_t  CNT;
+        uint32_t  REFRESH;
+        uint32_t  ENDDELAY;
+    } SEQ[2];
+} NRF_PWM_Type;
+
+extern NRF_PWM_Type sim_pwm_regs[1];
+
+#define NRF_PWM0                    (&sim_pwm_regs[0])
+
+#endif /* NRF_H__ */
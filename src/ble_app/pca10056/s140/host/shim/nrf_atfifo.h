@@ -0,0 +1,32 @@
+/**@file
+ * @brief Host stand-in for nrf_atfifo.h, a plain ring buffer with the SDK interface.
+ */
+#ifndef NRF_ATFIFO_H__
+#define NRF_ATFIFO_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdk_errors.h"
+
+typedef struct
+{
+    uint8_t * p_buf;
+    uint16_t  item_size;
+    uint16_t  item_count;   /**< Slots in p_buf, one more than the FIFO holds. */
+    uint16_t  head;
+    uint16_t  tail;
+} nrf_atfifo_t;
+
+#define NRF_ATFIFO_DEF(fifo_id, storage_type, item_cnt)                         \
+    static storage_type   fifo_id##_data[(item_cnt) + 1];                       \
+    static nrf_atfifo_t   fifo_id##_inst;                                       \
+    static nrf_atfifo_t * const fifo_id = &fifo_id##_inst
+
+#define NRF_ATFIFO_INIT(fifo_id)                                                \
+    nrf_atfifo_init(fifo_id, fifo_id##_data, sizeof(fifo_id##_data), sizeof(fifo_id##_data[0]))
+
+ret_code_t nrf_atfifo_init(nrf_atfifo_t * p_fifo, void * p_buf, uint16_t buf_size, uint16_t item_size);
+ret_code_t nrf_atfifo_alloc_put(nrf_atfifo_t * p_fifo, void const * p_var, size_t size, bool * p_visible);
+ret_code_t nrf_atfifo_get_free(nrf_atfifo_t * p_fifo, void * p_var, size_t size, bool * p_released);
+
+#endif /* NRF_ATFIFO_H__ */
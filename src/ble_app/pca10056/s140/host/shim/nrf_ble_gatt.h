@@ -0,0 +1,62 @@
+/**@file
+ * @brief Host stand-in for nrf_ble_gatt.h.
+ *
+ * @details Starts the ATT MTU exchange and the data length update on every connection, like the
+ *          SDK module, on top of the simulated SoftDevice.
+ */
+#ifndef NRF_BLE_GATT_H__
+#define NRF_BLE_GATT_H__
+
+#include <stdint.h>
+#include "sdk_config.h"
+#include "sdk_errors.h"
+#include "ble.h"
+#include "nrf_sdh_ble.h"
+
+typedef enum
+{
+    NRF_BLE_GATT_EVT_ATT_MTU_UPDATED,
+    NRF_BLE_GATT_EVT_DATA_LENGTH_UPDATED
+} nrf_ble_gatt_evt_id_t;
+
+typedef struct
+{
+    nrf_ble_gatt_evt_id_t evt_id;
+    uint16_t              conn_handle;
+    union
+    {
+        uint16_t att_mtu_effective;
+        uint8_t  data_length;
+    } params;
+} nrf_ble_gatt_evt_t;
+
+typedef struct nrf_ble_gatt_s nrf_ble_gatt_t;
+
+typedef void (*nrf_ble_gatt_evt_handler_t)(nrf_ble_gatt_t * p_gatt, nrf_ble_gatt_evt_t const * p_evt);
+
+typedef struct
+{
+    uint16_t att_mtu_desired;
+    uint16_t att_mtu_effective;
+    uint8_t  data_length_desired;
+    uint8_t  data_length_effective;
+} nrf_ble_gatt_link_t;
+
+struct nrf_ble_gatt_s
+{
+    uint16_t                   att_mtu_desired_periph;
+    uint8_t                    data_length;
+    nrf_ble_gatt_link_t        link;
+    nrf_ble_gatt_evt_handler_t evt_handler;
+};
+
+#define NRF_BLE_GATT_DEF(_name)                                                                 \
+    static nrf_ble_gatt_t _name;                                                                \
+    NRF_SDH_BLE_OBSERVER(_name ## _obs, NRF_BLE_GATT_BLE_OBSERVER_PRIO, nrf_ble_gatt_on_ble_evt, &_name)
+
+ret_code_t nrf_ble_gatt_init(nrf_ble_gatt_t * p_gatt, nrf_ble_gatt_evt_handler_t evt_handler);
+ret_code_t nrf_ble_gatt_att_mtu_periph_set(nrf_ble_gatt_t * p_gatt, uint16_t desired_mtu);
+ret_code_t nrf_ble_gatt_data_length_set(nrf_ble_gatt_t * p_gatt, uint16_t conn_handle, uint8_t data_length);
+void       nrf_ble_gatt_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context);
+
+#endif /* NRF_BLE_GATT_H__ */
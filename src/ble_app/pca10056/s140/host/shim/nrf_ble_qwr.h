@@ -0,0 +1,28 @@
+/**@file
+ * @brief Host stand-in for nrf_ble_qwr.h, no service uses queued writes.
+ */
+#ifndef NRF_BLE_QWR_H__
+#define NRF_BLE_QWR_H__
+
+#include <stdint.h>
+#include "sdk_errors.h"
+
+typedef void (*nrf_ble_qwr_error_handler_t)(uint32_t nrf_error);
+
+typedef struct
+{
+    nrf_ble_qwr_error_handler_t error_handler;
+} nrf_ble_qwr_init_t;
+
+typedef struct
+{
+    uint16_t                    conn_handle;
+    nrf_ble_qwr_error_handler_t error_handler;
+} nrf_ble_qwr_t;
+
+#define NRF_BLE_QWR_DEF(_name) static nrf_ble_qwr_t _name
+
+ret_code_t nrf_ble_qwr_init(nrf_ble_qwr_t * p_qwr, nrf_ble_qwr_init_t const * p_qwr_init);
+ret_code_t nrf_ble_qwr_conn_handle_assign(nrf_ble_qwr_t * p_qwr, uint16_t conn_handle);
+
+#endif /* NRF_BLE_QWR_H__ */
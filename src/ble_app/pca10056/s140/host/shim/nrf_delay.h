@@ -0,0 +1,7 @@
+/**@file
+ * @brief Host stand-in for nrf_delay.h, unused by the application.
+ */
+#ifndef NRF_DELAY_H__
+#define NRF_DELAY_H__
+
+#endif /* NRF_DELAY_H__ */
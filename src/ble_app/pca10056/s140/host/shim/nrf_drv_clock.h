@@ -0,0 +1,7 @@
+/**@file
+ * @brief Host stand-in for nrf_drv_clock.h, the clocks always run on the host.
+ */
+#ifndef NRF_DRV_CLOCK_H__
+#define NRF_DRV_CLOCK_H__
+
+#endif /* NRF_DRV_CLOCK_H__ */
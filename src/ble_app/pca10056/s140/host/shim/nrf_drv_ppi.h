@@ -0,0 +1,18 @@
+/**@file
+ * @brief Host stand-in for the legacy PPI driver, connects the simulated QDEC and TIMER.
+ */
+#ifndef NRF_DRV_PPI_H__
+#define NRF_DRV_PPI_H__
+
+#include <stdint.h>
+#include "sdk_errors.h"
+#include "app_util_platform.h"
+
+typedef uint8_t nrf_ppi_channel_t;
+
+ret_code_t nrf_drv_ppi_init(void);
+ret_code_t nrf_drv_ppi_channel_alloc(nrf_ppi_channel_t * p_channel);
+ret_code_t nrf_drv_ppi_channel_assign(nrf_ppi_channel_t channel, uint32_t eep, uint32_t tep);
+ret_code_t nrf_drv_ppi_channel_enable(nrf_ppi_channel_t channel);
+
+#endif /* NRF_DRV_PPI_H__ */
@@ -0,0 +1,18 @@
+/**@file
+ * @brief Host stand-in for the legacy PWM driver names.
+ */
+#ifndef NRF_DRV_PWM_H__
+#define NRF_DRV_PWM_H__
+
+#include "nrfx_pwm.h"
+
+typedef nrfx_pwm_t          nrf_drv_pwm_t;
+typedef nrfx_pwm_config_t   nrf_drv_pwm_config_t;
+
+#define NRF_DRV_PWM_PIN_INVERTED    NRFX_PWM_PIN_INVERTED
+#define NRF_DRV_PWM_FLAG_LOOP       NRFX_PWM_FLAG_LOOP
+
+#define nrf_drv_pwm_init            nrfx_pwm_init
+#define nrf_drv_pwm_simple_playback nrfx_pwm_simple_playback
+
+#endif /* NRF_DRV_PWM_H__ */
@@ -0,0 +1,48 @@
+/**@file
+ * @brief Host stand-in for the legacy QDEC driver, backed by the simulated encoder.
+ */
+#ifndef NRF_DRV_QDEC_H__
+#define NRF_DRV_QDEC_H__
+
+#include <stdint.h>
+#include "sdk_errors.h"
+#include "app_util_platform.h"
+#include "nrf_qdec.h"
+
+typedef struct
+{
+    nrf_qdec_reportper_t reportper;
+    nrf_qdec_sampleper_t sampleper;
+    uint32_t             psela;
+    uint32_t             pselb;
+    uint32_t             pselled;
+    bool                 dbfen;
+    bool                 sample_inten;
+    uint8_t              interrupt_priority;
+} nrf_drv_qdec_config_t;
+
+typedef struct
+{
+    nrf_qdec_event_t type;
+    union
+    {
+        struct
+        {
+            int8_t value;
+        } sample;
+        struct
+        {
+            int16_t  acc;
+            uint16_t accdbl;
+        } report;
+    } data;
+} nrf_drv_qdec_event_t;
+
+typedef void (*qdec_event_handler_t)(nrf_drv_qdec_event_t event);
+
+ret_code_t nrf_drv_qdec_init(nrf_drv_qdec_config_t const * p_config, qdec_event_handler_t event_handler);
+void       nrf_drv_qdec_enable(void);
+void       nrf_drv_qdec_disable(void);
+uint32_t   nrfx_qdec_event_address_get(nrf_qdec_event_t event);
+
+#endif /* NRF_DRV_QDEC_H__ */
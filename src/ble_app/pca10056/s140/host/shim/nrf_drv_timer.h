@@ -0,0 +1,104 @@
+/**@file
+ * @brief Host stand-in for the legacy TIMER driver, counting on the simulated clock.
+ */
+#ifndef NRF_DRV_TIMER_H__
+#define NRF_DRV_TIMER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdk_config.h"
+#include "sdk_errors.h"
+#include "app_util_platform.h"
+
+typedef enum
+{
+    NRF_TIMER_FREQ_16MHz = 0,
+    NRF_TIMER_FREQ_8MHz,
+    NRF_TIMER_FREQ_4MHz,
+    NRF_TIMER_FREQ_2MHz,
+    NRF_TIMER_FREQ_1MHz,
+    NRF_TIMER_FREQ_500kHz,
+    NRF_TIMER_FREQ_250kHz,
+    NRF_TIMER_FREQ_125kHz,
+    NRF_TIMER_FREQ_62500Hz,
+    NRF_TIMER_FREQ_31250Hz
+} nrf_timer_frequency_t;
+
+typedef enum
+{
+    NRF_TIMER_MODE_TIMER = 0,
+    NRF_TIMER_MODE_COUNTER,
+    NRF_TIMER_MODE_LOW_POWER_COUNTER
+} nrf_timer_mode_t;
+
+typedef enum
+{
+    NRF_TIMER_BIT_WIDTH_16 = 0,
+    NRF_TIMER_BIT_WIDTH_8,
+    NRF_TIMER_BIT_WIDTH_24,
+    NRF_TIMER_BIT_WIDTH_32
+} nrf_timer_bit_width_t;
+
+typedef enum
+{
+    NRF_TIMER_CC_CHANNEL0 = 0,
+    NRF_TIMER_CC_CHANNEL1,
+    NRF_TIMER_CC_CHANNEL2,
+    NRF_TIMER_CC_CHANNEL3,
+    NRF_TIMER_CC_CHANNEL4,
+    NRF_TIMER_CC_CHANNEL5
+} nrf_timer_cc_channel_t;
+
+typedef enum
+{
+    NRF_TIMER_EVENT_COMPARE0 = 0x140,
+    NRF_TIMER_EVENT_COMPARE1 = 0x144,
+    NRF_TIMER_EVENT_COMPARE2 = 0x148,
+    NRF_TIMER_EVENT_COMPARE3 = 0x14C,
+    NRF_TIMER_EVENT_COMPARE4 = 0x150,
+    NRF_TIMER_EVENT_COMPARE5 = 0x154
+} nrf_timer_event_t;
+
+typedef struct
+{
+    uint8_t instance_id;
+    uint8_t cc_channel_count;
+} nrf_drv_timer_t;
+
+#define NRF_DRV_TIMER_INSTANCE(id)  { .instance_id = (id), .cc_channel_count = 4 }
+
+typedef struct
+{
+    nrf_timer_frequency_t frequency;
+    nrf_timer_mode_t      mode;
+    nrf_timer_bit_width_t bit_width;
+    uint8_t               interrupt_priority;
+    void *                p_context;
+} nrf_drv_timer_config_t;
+
+#define NRF_DRV_TIMER_DEFAULT_CONFIG                                                \
+{                                                                                   \
+    .frequency          = (nrf_timer_frequency_t)TIMER_DEFAULT_CONFIG_FREQUENCY,    \
+    .mode               = (nrf_timer_mode_t)TIMER_DEFAULT_CONFIG_MODE,              \
+    .bit_width          = (nrf_timer_bit_width_t)TIMER_DEFAULT_CONFIG_BIT_WIDTH,    \
+    .interrupt_priority = TIMER_DEFAULT_CONFIG_IRQ_PRIORITY,                        \
+    .p_context          = NULL                                                      \
+}
+
+typedef void (*nrf_timer_event_handler_t)(nrf_timer_event_t event_type, void * p_context);
+
+ret_code_t nrf_drv_timer_init(nrf_drv_timer_t const *        p_instance,
+                              nrf_drv_timer_config_t const * p_config,
+                              nrf_timer_event_handler_t      timer_event_handler);
+void       nrf_drv_timer_enable(nrf_drv_timer_t const * p_instance);
+void       nrf_drv_timer_disable(nrf_drv_timer_t const * p_instance);
+void       nrf_drv_timer_clear(nrf_drv_timer_t const * p_instance);
+uint32_t   nrf_drv_timer_capture(nrf_drv_timer_t const * p_instance, nrf_timer_cc_channel_t cc_channel);
+uint32_t   nrf_drv_timer_capture_get(nrf_drv_timer_t const * p_instance, nrf_timer_cc_channel_t cc_channel);
+void       nrf_drv_timer_compare(nrf_drv_timer_t const * p_instance,
+                                 nrf_timer_cc_channel_t  cc_channel,
+                                 uint32_t                cc_value,
+                                 bool                    enable_int);
+uint32_t   nrf_drv_timer_capture_task_address_get(nrf_drv_timer_t const * p_instance, uint32_t channel);
+
+#endif /* NRF_DRV_TIMER_H__ */
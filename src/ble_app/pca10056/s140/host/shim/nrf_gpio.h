@@ -0,0 +1,23 @@
+/**@file
+ * @brief Host stand-in for the GPIO HAL.
+ */
+#ifndef NRF_GPIO_H__
+#define NRF_GPIO_H__
+
+#include <stdint.h>
+
+typedef enum
+{
+    NRF_GPIO_PIN_NOPULL   = 0,
+    NRF_GPIO_PIN_PULLDOWN = 1,
+    NRF_GPIO_PIN_PULLUP   = 3
+} nrf_gpio_pin_pull_t;
+
+#define NRF_GPIO_PIN_MAP(port, pin) (((port) << 5) | ((pin) & 0x1F))
+
+static inline void nrf_gpio_cfg_output(uint32_t pin_number)
+{
+    (void)pin_number;
+}
+
+#endif /* NRF_GPIO_H__ */
@@ -0,0 +1,16 @@
+/**@file
+ * @brief Host stand-in for nrf_log.h, messages go to stdout when the simulation is verbose.
+ */
+#ifndef NRF_LOG_H_
+#define NRF_LOG_H_
+
+#include "sdk_common.h"
+
+void sim_log(char const * p_level, char const * p_fmt, ...);
+
+#define NRF_LOG_ERROR(...)      sim_log("error", __VA_ARGS__)
+#define NRF_LOG_WARNING(...)    sim_log("warning", __VA_ARGS__)
+#define NRF_LOG_INFO(...)       sim_log("info", __VA_ARGS__)
+#define NRF_LOG_DEBUG(...)      sim_log("debug", __VA_ARGS__)
+
+#endif /* NRF_LOG_H_ */
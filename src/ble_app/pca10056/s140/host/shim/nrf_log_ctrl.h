@@ -0,0 +1,13 @@
+/**@file
+ * @brief Host stand-in for nrf_log_ctrl.h, logging is synchronous on the host.
+ */
+#ifndef NRF_LOG_CTRL_H
+#define NRF_LOG_CTRL_H
+
+#include <stdbool.h>
+#include "sdk_errors.h"
+
+#define NRF_LOG_INIT(timestamp_func)    ((void)(timestamp_func), NRF_SUCCESS)
+#define NRF_LOG_PROCESS()               false
+
+#endif /* NRF_LOG_CTRL_H */
@@ -0,0 +1,9 @@
+/**@file
+ * @brief Host stand-in for nrf_log_default_backends.h.
+ */
+#ifndef NRF_LOG_DEFAULT_BACKENDS_H__
+#define NRF_LOG_DEFAULT_BACKENDS_H__
+
+#define NRF_LOG_DEFAULT_BACKENDS_INIT()
+
+#endif /* NRF_LOG_DEFAULT_BACKENDS_H__ */
@@ -0,0 +1,112 @@
+/**@file
+ * @brief Host stand-in for the PWM HAL, writes the simulated PWM registers.
+ */
+#ifndef NRF_PWM_H__
+#define NRF_PWM_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "nrf.h"
+
+typedef enum
+{
+    NRF_PWM_CLK_16MHz = 0,
+    NRF_PWM_CLK_8MHz,
+    NRF_PWM_CLK_4MHz,
+    NRF_PWM_CLK_2MHz,
+    NRF_PWM_CLK_1MHz,
+    NRF_PWM_CLK_500kHz,
+    NRF_PWM_CLK_250kHz,
+    NRF_PWM_CLK_125kHz
+} nrf_pwm_clk_t;
+
+typedef enum
+{
+    NRF_PWM_MODE_UP = 0,
+    NRF_PWM_MODE_UP_AND_DOWN
+} nrf_pwm_mode_t;
+
+typedef enum
+{
+    NRF_PWM_LOAD_COMMON = 0,
+    NRF_PWM_LOAD_GROUPED,
+    NRF_PWM_LOAD_INDIVIDUAL,
+    NRF_PWM_LOAD_WAVE_FORM
+} nrf_pwm_dec_load_t;
+
+typedef enum
+{
+    NRF_PWM_STEP_AUTO = 0,
+    NRF_PWM_STEP_TRIGGERED
+} nrf_pwm_dec_step_t;
+
+typedef enum
+{
+    NRF_PWM_TASK_STOP,
+    NRF_PWM_TASK_SEQSTART0,
+    NRF_PWM_TASK_SEQSTART1,
+    NRF_PWM_TASK_NEXTSTEP
+} nrf_pwm_task_t;
+
+typedef enum
+{
+    NRF_PWM_EVENT_PWMPERIODEND
+} nrf_pwm_event_t;
+
+typedef struct
+{
+    uint16_t channel_0;
+    uint16_t channel_1;
+    uint16_t channel_2;
+    uint16_t channel_3;
+} nrf_pwm_values_individual_t;
+
+typedef union
+{
+    uint16_t const *                    p_raw;
+    nrf_pwm_values_individual_t const * p_individual;
+} nrf_pwm_values_t;
+
+typedef struct
+{
+    nrf_pwm_values_t values;
+    uint16_t         length;
+    uint32_t         repeats;
+    uint32_t         end_delay;
+} nrf_pwm_sequence_t;
+
+static inline void nrf_pwm_seq_ptr_set(NRF_PWM_Type * p_reg, uint8_t seq_id, uint16_t const * p_values)
+{
+    p_reg->SEQ[seq_id].PTR = (uintptr_t)p_values;
+}
+
+static inline void nrf_pwm_seq_cnt_set(NRF_PWM_Type * p_reg, uint8_t seq_id, uint16_t length)
+{
+    p_reg->SEQ[seq_id].CNT = length;
+}
+
+static inline void nrf_pwm_seq_refresh_set(NRF_PWM_Type * p_reg, uint8_t seq_id, uint32_t refresh)
+{
+    p_reg->SEQ[seq_id].REFRESH = refresh;
+}
+
+static inline void nrf_pwm_seq_end_delay_set(NRF_PWM_Type * p_reg, uint8_t seq_id, uint32_t end_delay)
+{
+    p_reg->SEQ[seq_id].ENDDELAY = end_delay;
+}
+
+static inline void nrf_pwm_event_clear(NRF_PWM_Type * p_reg, nrf_pwm_event_t event)
+{
+    (void)event;
+    p_reg->EVENTS_PWMPERIODEND = 0;
+}
+
+static inline bool nrf_pwm_event_check(NRF_PWM_Type const * p_reg, nrf_pwm_event_t event)
+{
+    (void)event;
+    return p_reg->EVENTS_PWMPERIODEND != 0;
+}
+
+void nrf_pwm_task_trigger(NRF_PWM_Type * p_reg, nrf_pwm_task_t task);
+
+#endif /* NRF_PWM_H__ */
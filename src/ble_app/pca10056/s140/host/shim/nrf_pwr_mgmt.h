@@ -0,0 +1,14 @@
+/**@file
+ * @brief Host stand-in for nrf_pwr_mgmt.h.
+ */
+#ifndef NRF_PWR_MGMT_H__
+#define NRF_PWR_MGMT_H__
+
+#include "sdk_errors.h"
+
+ret_code_t nrf_pwr_mgmt_init(void);
+
+/**@brief Advances the simulated clock to the next event and runs its interrupt handlers. */
+void nrf_pwr_mgmt_run(void);
+
+#endif /* NRF_PWR_MGMT_H__ */
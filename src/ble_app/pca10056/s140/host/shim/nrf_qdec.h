@@ -0,0 +1,57 @@
+/**@file
+ * @brief Host stand-in for the QDEC HAL, backed by the simulated encoder.
+ */
+#ifndef NRF_QDEC_H__
+#define NRF_QDEC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum
+{
+    NRF_QDEC_SAMPLEPER_128us = 0,
+    NRF_QDEC_SAMPLEPER_256us,
+    NRF_QDEC_SAMPLEPER_512us,
+    NRF_QDEC_SAMPLEPER_1024us,
+    NRF_QDEC_SAMPLEPER_2048us,
+    NRF_QDEC_SAMPLEPER_4096us,
+    NRF_QDEC_SAMPLEPER_8192us,
+    NRF_QDEC_SAMPLEPER_16384us,
+    NRF_QDEC_SAMPLEPER_32ms,
+    NRF_QDEC_SAMPLEPER_65ms,
+    NRF_QDEC_SAMPLEPER_131ms
+} nrf_qdec_sampleper_t;
+
+typedef enum
+{
+    NRF_QDEC_REPORTPER_10 = 0,
+    NRF_QDEC_REPORTPER_40,
+    NRF_QDEC_REPORTPER_80,
+    NRF_QDEC_REPORTPER_120,
+    NRF_QDEC_REPORTPER_160,
+    NRF_QDEC_REPORTPER_200,
+    NRF_QDEC_REPORTPER_240,
+    NRF_QDEC_REPORTPER_280
+} nrf_qdec_reportper_t;
+
+typedef enum
+{
+    NRF_QDEC_TASK_START,
+    NRF_QDEC_TASK_STOP,
+    NRF_QDEC_TASK_READCLRACC
+} nrf_qdec_task_t;
+
+typedef enum
+{
+    NRF_QDEC_EVENT_SAMPLERDY,
+    NRF_QDEC_EVENT_REPORTRDY,
+    NRF_QDEC_EVENT_ACCOF
+} nrf_qdec_event_t;
+
+void nrf_qdec_task_trigger(nrf_qdec_task_t task);
+bool nrf_qdec_event_check(nrf_qdec_event_t event);
+void nrf_qdec_sampleper_set(nrf_qdec_sampleper_t sampleper);
+void nrf_qdec_reportper_set(nrf_qdec_reportper_t reportper);
+void nrf_qdec_dbfen_enable(void);
+
+#endif /* NRF_QDEC_H__ */
@@ -0,0 +1,12 @@
+/**@file
+ * @brief Host stand-in for nrf_sdh.h.
+ */
+#ifndef NRF_SDH_H__
+#define NRF_SDH_H__
+
+#include "sdk_errors.h"
+#include "nrf_soc.h"
+
+ret_code_t nrf_sdh_enable_request(void);
+
+#endif /* NRF_SDH_H__ */
@@ -0,0 +1,37 @@
+/**@file
+ * @brief Host stand-in for nrf_sdh_ble.h.
+ *
+ * @details Observers are collected in one linker section per priority like on the target, and
+ *          the simulated SoftDevice dispatches events to them in priority order.
+ */
+#ifndef NRF_SDH_BLE_H__
+#define NRF_SDH_BLE_H__
+
+#include <stdint.h>
+#include "sdk_config.h"
+#include "sdk_errors.h"
+#include "nordic_common.h"
+#include "app_util.h"
+#include "ble.h"
+
+typedef void (*nrf_sdh_ble_evt_handler_t)(ble_evt_t const * p_ble_evt, void * p_context);
+
+typedef struct
+{
+    nrf_sdh_ble_evt_handler_t handler;
+    void *                    p_context;
+} nrf_sdh_ble_evt_observer_t;
+
+#define NRF_SDH_BLE_OBSERVER(_name, _prio, _handler, _context)                                  \
+    STATIC_ASSERT((_prio) < NRF_SDH_BLE_OBSERVER_PRIO_LEVELS);                                  \
+    static nrf_sdh_ble_evt_observer_t const _name                                               \
+        __attribute__((section("sdh_ble_observers" STRINGIFY(_prio)), used)) =                  \
+    {                                                                                           \
+        .handler   = _handler,                                                                  \
+        .p_context = _context                                                                   \
+    }
+
+ret_code_t nrf_sdh_ble_default_cfg_set(uint8_t conn_cfg_tag, uint32_t * p_ram_start);
+ret_code_t nrf_sdh_ble_enable(uint32_t * p_app_ram_start);
+
+#endif /* NRF_SDH_BLE_H__ */
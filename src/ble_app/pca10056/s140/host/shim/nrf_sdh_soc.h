@@ -0,0 +1,9 @@
+/**@file
+ * @brief Host stand-in for nrf_sdh_soc.h, no SoC events are simulated.
+ */
+#ifndef NRF_SDH_SOC_H__
+#define NRF_SDH_SOC_H__
+
+#include "nrf_soc.h"
+
+#endif /* NRF_SDH_SOC_H__ */
@@ -0,0 +1,12 @@
+/**@file
+ * @brief Host stand-in for the SoftDevice nrf_soc.h.
+ */
+#ifndef NRF_SOC_H__
+#define NRF_SOC_H__
+
+#include <stdint.h>
+
+/**@brief Ends the simulation run, system off only wakes up through a reset. */
+uint32_t sd_power_system_off(void);
+
+#endif /* NRF_SOC_H__ */
@@ -0,0 +1,63 @@
+/**@file
+ * @brief Host stand-in for the nrfx PWM driver, playing into the simulated PWM sink.
+ */
+#ifndef NRFX_PWM_H__
+#define NRFX_PWM_H__
+
+#include <stdint.h>
+#include "sdk_errors.h"
+#include "app_util_platform.h"
+#include "nrf_pwm.h"
+
+typedef struct
+{
+    NRF_PWM_Type * p_registers;
+    uint8_t        drv_inst_idx;
+} nrfx_pwm_t;
+
+#define NRFX_PWM_INSTANCE(id)       { .p_registers = NRF_PWM##id, .drv_inst_idx = (id) }
+
+#define NRFX_PWM_PIN_NOT_USED       0xFF
+#define NRFX_PWM_PIN_INVERTED       0x80
+#define NRFX_PWM_CHANNEL_COUNT      4
+
+typedef struct
+{
+    uint8_t            output_pins[NRFX_PWM_CHANNEL_COUNT];
+    uint8_t            irq_priority;
+    nrf_pwm_clk_t      base_clock;
+    nrf_pwm_mode_t     count_mode;
+    uint16_t           top_value;
+    nrf_pwm_dec_load_t load_mode;
+    nrf_pwm_dec_step_t step_mode;
+} nrfx_pwm_config_t;
+
+typedef enum
+{
+    NRFX_PWM_FLAG_STOP                = 0x01,
+    NRFX_PWM_FLAG_LOOP                = 0x02,
+    NRFX_PWM_FLAG_SIGNAL_END_SEQ0     = 0x04,
+    NRFX_PWM_FLAG_SIGNAL_END_SEQ1     = 0x08,
+    NRFX_PWM_FLAG_NO_EVT_FINISHED     = 0x10,
+    NRFX_PWM_FLAG_START_VIA_TASK      = 0x80
+} nrfx_pwm_flag_t;
+
+typedef enum
+{
+    NRFX_PWM_EVT_FINISHED,
+    NRFX_PWM_EVT_END_SEQ0,
+    NRFX_PWM_EVT_END_SEQ1,
+    NRFX_PWM_EVT_STOPPED
+} nrfx_pwm_evt_type_t;
+
+typedef void (*nrfx_pwm_handler_t)(nrfx_pwm_evt_type_t event_type);
+
+ret_code_t nrfx_pwm_init(nrfx_pwm_t const *        p_instance,
+                         nrfx_pwm_config_t const * p_config,
+                         nrfx_pwm_handler_t        handler);
+uint32_t   nrfx_pwm_simple_playback(nrfx_pwm_t const *         p_instance,
+                                    nrf_pwm_sequence_t const * p_sequence,
+                                    uint16_t                   playback_count,
+                                    uint32_t                   flags);
+
+#endif /* NRFX_PWM_H__ */
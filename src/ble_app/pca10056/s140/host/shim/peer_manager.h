@@ -0,0 +1,34 @@
+/**@file
+ * @brief Host stand-in for peer_manager.h, there are no bonds on the host.
+ */
+#ifndef PEER_MANAGER_H__
+#define PEER_MANAGER_H__
+
+#include <stdint.h>
+#include "sdk_errors.h"
+#include "ble_gap.h"
+
+typedef enum
+{
+    PM_EVT_BONDED_PEER_CONNECTED,
+    PM_EVT_CONN_SEC_START,
+    PM_EVT_CONN_SEC_SUCCEEDED,
+    PM_EVT_CONN_SEC_FAILED,
+    PM_EVT_PEERS_DELETE_SUCCEEDED = 0x10,
+    PM_EVT_PEERS_DELETE_FAILED
+} pm_evt_id_t;
+
+typedef struct
+{
+    pm_evt_id_t evt_id;
+    uint16_t    conn_handle;
+} pm_evt_t;
+
+typedef void (*pm_evt_handler_t)(pm_evt_t const * p_event);
+
+ret_code_t pm_init(void);
+ret_code_t pm_sec_params_set(ble_gap_sec_params_t * p_sec_params);
+ret_code_t pm_register(pm_evt_handler_t event_handler);
+ret_code_t pm_peers_delete(void);
+
+#endif /* PEER_MANAGER_H__ */
@@ -0,0 +1,19 @@
+/**@file
+ * @brief Host stand-in for sdk_common.h.
+ *
+ * @details Pulls in the application's own sdk_config.h, so host builds see the same configuration
+ *          as the target.
+ */
+#ifndef SDK_COMMON_H__
+#define SDK_COMMON_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "sdk_config.h"
+#include "nordic_common.h"
+#include "sdk_errors.h"
+#include "app_util.h"
+#include "sdk_macros.h"
+
+#endif /* SDK_COMMON_H__ */
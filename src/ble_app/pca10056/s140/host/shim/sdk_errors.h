@@ -0,0 +1,18 @@
+/**@file
+ * @brief Host stand-in for the nRF5 SDK error codes, same values as the SDK.
+ */
+#ifndef SDK_ERRORS_H__
+#define SDK_ERRORS_H__
+
+#include <stdint.h>
+#include "nrf_error.h"
+
+typedef uint32_t ret_code_t;
+
+#define NRF_ERROR_SDK_COMMON_ERROR_BASE     (NRF_ERROR_BASE_NUM + 0x8000)
+
+#define NRF_ERROR_MODULE_NOT_INITIALIZED    (NRF_ERROR_SDK_COMMON_ERROR_BASE + 0x0000)
+#define NRF_ERROR_MODULE_ALREADY_INITIALIZED (NRF_ERROR_SDK_COMMON_ERROR_BASE + 0x0005)
+#define NRF_ERROR_STORAGE_FULL              (NRF_ERROR_SDK_COMMON_ERROR_BASE + 0x0006)
+
+#endif /* SDK_ERRORS_H__ */
@@ -0,0 +1,29 @@
+/**@file
+ * @brief Host stand-in for sdk_macros.h, only the checks the application uses.
+ */
+#ifndef SDK_MACROS_H__
+#define SDK_MACROS_H__
+
+#include <stddef.h>
+#include "sdk_errors.h"
+
+#define VERIFY_SUCCESS(statement)               \
+do                                              \
+{                                               \
+    uint32_t _err_code = (uint32_t)(statement); \
+    if (_err_code != NRF_SUCCESS)               \
+    {                                           \
+        return _err_code;                       \
+    }                                           \
+} while (0)
+
+#define VERIFY_PARAM_NOT_NULL(param)            \
+do                                              \
+{                                               \
+    if ((param) == NULL)                        \
+    {                                           \
+        return NRF_ERROR_NULL;                  \
+    }                                           \
+} while (0)
+
+#endif /* SDK_MACROS_H__ */
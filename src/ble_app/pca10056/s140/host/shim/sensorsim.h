@@ -0,0 +1,7 @@
+/**@file
+ * @brief Host stand-in for sensorsim.h, unused by the application.
+ */
+#ifndef SENSORSIM_H__
+#define SENSORSIM_H__
+
+#endif /* SENSORSIM_H__ */
@@ -0,0 +1,187 @@
+/**@file
+ * @brief Host simulation of the sled hardware and the SoftDevice around the application.
+ *
+ * @details One simulated clock drives every fake peripheral. The application runs unmodified;
+ *          its interrupt handlers run in time order from nrf_pwr_mgmt_run, the only place the
+ *          main loop waits, so a run is fully determined by the scenario that drives it.
+ *
+ *          The first part of this header is for scenarios, the second part is shared between
+ *          the fakes.
+ */
+#ifndef SIM_H__
+#define SIM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble.h"
+
+#define SIM_US(_us)     ((uint64_t)(_us) * 1000)
+#define SIM_MS(_ms)     ((uint64_t)(_ms) * 1000000)
+#define SIM_S(_s)       ((uint64_t)(_s) * 1000000000)
+
+/**@brief How a simulation run ended. */
+typedef enum
+{
+    SIM_RESULT_END,         /**< The end time was reached. */
+    SIM_RESULT_SYSTEM_OFF,  /**< The application entered system off. */
+    SIM_RESULT_ERROR        /**< APP_ERROR_CHECK or a fake caught a misuse, see the log. */
+} sim_result_t;
+
+typedef void (*sim_event_handler_t)(void * p_context);
+
+/**@brief Function for the current simulated time, nanoseconds since reset. */
+uint64_t sim_time_ns(void);
+
+/**@brief Function for scheduling a handler at a simulated time.
+ *
+ * @details Events at the same time run in the order they were scheduled.
+ *
+ * @return  Event ID for @ref sim_event_cancel, never 0.
+ */
+uint32_t sim_event_at(uint64_t time_ns, sim_event_handler_t handler, void * p_context);
+
+/**@brief Function for cancelling a scheduled event. IDs of events that already ran are ignored. */
+void sim_event_cancel(uint32_t id);
+
+/**@brief Function for running the application from reset until a simulated time.
+ *
+ * @details Only one run per process, the application keeps its state in static variables.
+ */
+sim_result_t sim_run(int (*app_main)(void), uint64_t end_ns);
+
+/**@brief Function for logging the application's NRF_LOG output to stdout. */
+void sim_verbose_set(bool verbose);
+
+/**@brief Function for failing the run with a message, like an assert in the hardware. */
+void sim_fail(char const * p_fmt, ...);
+
+/**@brief Function for setting the encoder speed from now on, in counts per second after x4 decoding. */
+void sim_encoder_speed_set(double counts_per_s);
+
+/**@brief Function for the true encoder position, in counts. */
+double sim_encoder_position_get(void);
+
+/**@brief QDEC statistics, as seen by the hardware. */
+typedef struct
+{
+    uint32_t samples;       /**< Samples taken. */
+    uint32_t reports;       /**< REPORTRDY events, reports with transitions. */
+    uint32_t overspeed;     /**< Samples that moved three or more counts and decoded wrong. */
+    uint32_t wakes;         /**< Encoder edges delivered to an armed GPIOTE input. */
+} sim_qdec_stats_t;
+
+void sim_qdec_stats_get(sim_qdec_stats_t * p_stats);
+
+/**@brief Function for the QDEC enable state, false while sampling sleeps. */
+bool sim_qdec_is_enabled(void);
+
+/**@brief Handler for every PWM period whose output differs from the period before. */
+typedef void (*sim_pwm_handler_t)(uint16_t const * p_values);
+
+void sim_pwm_handler_set(sim_pwm_handler_t handler);
+
+/**@brief Function for the compare value a PWM channel outputs in the current period. */
+uint16_t sim_pwm_value_get(uint8_t channel);
+
+/**@brief PWM statistics. */
+typedef struct
+{
+    uint32_t seqstarts;         /**< SEQSTART0 tasks. */
+    uint32_t seqstarts_lost;    /**< SEQSTART0 tasks while one was waiting for its period boundary. */
+} sim_pwm_stats_t;
+
+void sim_pwm_stats_get(sim_pwm_stats_t * p_stats);
+
+/**@brief Behaviour of the simulated central. */
+typedef struct
+{
+    uint16_t att_mtu;           /**< ATT MTU the central offers. */
+    uint8_t  data_length;       /**< Largest LL payload the central accepts. */
+    bool     phy_2m;            /**< The central accepts the 2M PHY. */
+    uint16_t conn_interval;     /**< Connection interval at connection, 1.25 ms units. */
+    uint16_t conn_interval_min; /**< Shortest interval the central grants, 1.25 ms units. */
+    uint8_t  hvn_queue_size;    /**< Notifications the SoftDevice queues, hvn_tx_queue_size. */
+} sim_central_config_t;
+
+/**@brief Defaults: a recent phone, 247 byte MTU, 251 byte data length, 2M, 30 ms at
+ *        connection, 15 ms shortest and the SoftDevice default queue of one notification.
+ */
+void sim_central_config_set(sim_central_config_t const * p_config);
+
+/**@brief Function for connecting the central to the advertising peripheral. */
+void sim_central_connect(void);
+
+/**@brief Function for the central dropping the link. */
+void sim_central_disconnect(void);
+
+/**@brief Function for finding the value or CCCD handle of a characteristic by its 16-bit UUID. */
+uint16_t sim_central_handle_find(uint16_t uuid, bool cccd);
+
+/**@brief Handler for notifications received by the central, called at the end of the
+ *        connection event that carried them.
+ */
+typedef void (*sim_central_notify_handler_t)(uint16_t handle, uint8_t const * p_data, uint16_t len);
+
+void sim_central_notify_handler_set(sim_central_notify_handler_t handler);
+
+/**@brief Handler for the ATT response to a write request. */
+typedef void (*sim_central_write_rsp_handler_t)(uint16_t handle, uint16_t gatt_status);
+
+void sim_central_write_rsp_handler_set(sim_central_write_rsp_handler_t handler);
+
+/**@brief Function for queueing a write, sent in the next connection event the peripheral attends.
+ *
+ * @param[in]   with_response   Write request if true, write command otherwise.
+ */
+void sim_central_write(uint16_t handle, uint8_t const * p_data, uint16_t len, bool with_response);
+
+/**@brief Function for enabling notifications of a characteristic, a write request to its CCCD. */
+void sim_central_subscribe(uint16_t uuid, bool enable);
+
+/**@brief Function for reading a characteristic right away, without waiting for a connection event.
+ *
+ * @return  Length of the value, 0 if the read was rejected.
+ */
+uint16_t sim_central_read(uint16_t handle, uint8_t * p_buf, uint16_t max_len);
+
+/**@brief Link statistics. */
+typedef struct
+{
+    uint32_t conn_events;       /**< Connection events held. */
+    uint32_t conn_events_idle;  /**< Connection events the peripheral skipped with slave latency. */
+    uint32_t notifications;     /**< Notifications received by the central. */
+    uint32_t bytes;             /**< ATT payload bytes received by the central. */
+    uint32_t hvx_resources;     /**< sd_ble_gatts_hvx calls refused with a full queue. */
+    uint16_t att_mtu;
+    uint8_t  data_length;
+    uint8_t  phy;
+    uint16_t conn_interval;
+    uint16_t slave_latency;
+} sim_link_stats_t;
+
+void sim_link_stats_get(sim_link_stats_t * p_stats);
+
+/* For the fakes. */
+
+/**@brief Function for sleeping the CPU until the next event, the body of nrf_pwr_mgmt_run. */
+void sim_sleep(void);
+
+/**@brief Function for dispatching a BLE event to the observers, in priority order. */
+void sim_ble_evt_dispatch(ble_evt_t const * p_ble_evt);
+
+/**@brief Function for the advertising module to tell whether a central may connect. */
+void sim_advertising_set(bool advertising);
+
+/**@brief Function for the 24-bit RTC counter of app_timer, at the app_timer tick rate. */
+uint32_t sim_rtc_counter_get(void);
+
+/**@brief Function for the unwrapped RTC tick count. */
+uint64_t sim_rtc_ticks_get(void);
+
+/**@brief Function for the simulated time of an unwrapped RTC tick. */
+uint64_t sim_rtc_tick_time_ns(uint64_t tick);
+
+/**@brief Function for triggering a TIMER task through PPI, for the QDEC fake. */
+void sim_ppi_event(uint32_t event_address);
+
+#endif /* SIM_H__ */
@@ -0,0 +1,421 @@
+/**@file
+ * @brief SDK BLE modules on the simulated SoftDevice: nrf_ble_gatt, ble_conn_params and
+ *        ble_advertising, reduced to what a single peripheral link uses.
+ */
+#include <string.h>
+#include "sdk_common.h"
+#include "app_error.h"
+#include "app_timer.h"
+#include "nrf_ble_gatt.h"
+#include "ble_conn_params.h"
+#include "ble_advertising.h"
+#include "ble_hci.h"
+#include "sim.h"
+
+static ble_conn_params_init_t m_cp_init;
+static ble_gap_conn_params_t  m_cp_preferred;
+static uint16_t               m_cp_conn_handle = BLE_CONN_HANDLE_INVALID;
+static uint8_t                m_cp_update_count;
+
+APP_TIMER_DEF(m_cp_timer);
+
+static void conn_params_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context);
+
+NRF_SDH_BLE_OBSERVER(m_cp_obs, BLE_CONN_PARAMS_BLE_OBSERVER_PRIO, conn_params_on_ble_evt, NULL);
+
+
+ret_code_t nrf_ble_gatt_init(nrf_ble_gatt_t * p_gatt, nrf_ble_gatt_evt_handler_t evt_handler)
+{
+    VERIFY_PARAM_NOT_NULL(p_gatt);
+
+    memset(p_gatt, 0, sizeof(*p_gatt));
+    p_gatt->evt_handler            = evt_handler;
+    p_gatt->att_mtu_desired_periph = NRF_SDH_BLE_GATT_MAX_MTU_SIZE;
+    p_gatt->data_length            = NRF_SDH_BLE_GAP_DATA_LENGTH;
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_ble_gatt_att_mtu_periph_set(nrf_ble_gatt_t * p_gatt, uint16_t desired_mtu)
+{
+    if ((desired_mtu < BLE_GATT_ATT_MTU_DEFAULT) || (desired_mtu > NRF_SDH_BLE_GATT_MAX_MTU_SIZE))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    p_gatt->att_mtu_desired_periph = desired_mtu;
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_ble_gatt_data_length_set(nrf_ble_gatt_t * p_gatt, uint16_t conn_handle, uint8_t data_length)
+{
+    if (conn_handle != BLE_CONN_HANDLE_INVALID)
+    {
+        sim_fail("nrf_ble_gatt_data_length_set on a link not simulated.");
+    }
+    if ((data_length < BLE_GAP_DATA_LENGTH_DEFAULT) || (data_length > NRF_SDH_BLE_GAP_DATA_LENGTH))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    p_gatt->data_length = data_length;
+    return NRF_SUCCESS;
+}
+
+
+static void gatt_evt_send(nrf_ble_gatt_t * p_gatt, nrf_ble_gatt_evt_t const * p_evt)
+{
+    if (p_gatt->evt_handler != NULL)
+    {
+        p_gatt->evt_handler(p_gatt, p_evt);
+    }
+}
+
+
+void nrf_ble_gatt_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    nrf_ble_gatt_t *     p_gatt = (nrf_ble_gatt_t *)p_context;
+    nrf_ble_gatt_link_t * p_link = &p_gatt->link;
+    nrf_ble_gatt_evt_t   evt;
+    ret_code_t           err_code;
+
+    memset(&evt, 0, sizeof(evt));
+
+    switch (p_ble_evt->header.evt_id)
+    {
+        case BLE_GAP_EVT_CONNECTED:
+            p_link->att_mtu_desired       = p_gatt->att_mtu_desired_periph;
+            p_link->att_mtu_effective     = BLE_GATT_ATT_MTU_DEFAULT;
+            p_link->data_length_desired   = p_gatt->data_length;
+            p_link->data_length_effective = BLE_GAP_DATA_LENGTH_DEFAULT;
+
+            if (p_link->att_mtu_desired > BLE_GATT_ATT_MTU_DEFAULT)
+            {
+                err_code = sd_ble_gattc_exchange_mtu_request(p_ble_evt->evt.gap_evt.conn_handle,
+                                                             p_link->att_mtu_desired);
+                if (err_code != NRF_SUCCESS)
+                {
+                    sim_fail("sd_ble_gattc_exchange_mtu_request: 0x%x", err_code);
+                }
+            }
+            if (p_link->data_length_desired > BLE_GAP_DATA_LENGTH_DEFAULT)
+            {
+                ble_gap_data_length_params_t const dl_params =
+                {
+                    .max_tx_octets = p_link->data_length_desired,
+                    .max_rx_octets = p_link->data_length_desired
+                };
+
+                err_code = sd_ble_gap_data_length_update(p_ble_evt->evt.gap_evt.conn_handle, &dl_params, NULL);
+                if (err_code != NRF_SUCCESS)
+                {
+                    sim_fail("sd_ble_gap_data_length_update: 0x%x", err_code);
+                }
+            }
+            break;
+
+        case BLE_GATTC_EVT_EXCHANGE_MTU_RSP:
+            p_link->att_mtu_effective = MIN(MAX(p_ble_evt->evt.gattc_evt.params.exchange_mtu_rsp.server_rx_mtu,
+                                                BLE_GATT_ATT_MTU_DEFAULT),
+                                            p_link->att_mtu_desired);
+
+            evt.evt_id                   = NRF_BLE_GATT_EVT_ATT_MTU_UPDATED;
+            evt.conn_handle              = p_ble_evt->evt.gattc_evt.conn_handle;
+            evt.params.att_mtu_effective = p_link->att_mtu_effective;
+            gatt_evt_send(p_gatt, &evt);
+            break;
+
+        case BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST:
+            err_code = sd_ble_gatts_exchange_mtu_reply(p_ble_evt->evt.gatts_evt.conn_handle,
+                                                       p_link->att_mtu_desired);
+            if (err_code != NRF_SUCCESS)
+            {
+                sim_fail("sd_ble_gatts_exchange_mtu_reply: 0x%x", err_code);
+            }
+            p_link->att_mtu_effective = MIN(MAX(p_ble_evt->evt.gatts_evt.params.exchange_mtu_request.client_rx_mtu,
+                                                BLE_GATT_ATT_MTU_DEFAULT),
+                                            p_link->att_mtu_desired);
+
+            evt.evt_id                   = NRF_BLE_GATT_EVT_ATT_MTU_UPDATED;
+            evt.conn_handle              = p_ble_evt->evt.gatts_evt.conn_handle;
+            evt.params.att_mtu_effective = p_link->att_mtu_effective;
+            gatt_evt_send(p_gatt, &evt);
+            break;
+
+        case BLE_GAP_EVT_DATA_LENGTH_UPDATE:
+            p_link->data_length_effective =
+                (uint8_t)p_ble_evt->evt.gap_evt.params.data_length_update.effective_params.max_tx_octets;
+
+            evt.evt_id             = NRF_BLE_GATT_EVT_DATA_LENGTH_UPDATED;
+            evt.conn_handle        = p_ble_evt->evt.gap_evt.conn_handle;
+            evt.params.data_length = p_link->data_length_effective;
+            gatt_evt_send(p_gatt, &evt);
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+/**@brief Function for checking the granted connection parameters against the preferred ones. */
+static bool conn_params_ok(ble_gap_conn_params_t const * p_params)
+{
+    return (p_params->max_conn_interval >= m_cp_preferred.min_conn_interval)
+           && (p_params->max_conn_interval <= m_cp_preferred.max_conn_interval)
+           && (p_params->slave_latency == m_cp_preferred.slave_latency);
+}
+
+
+static void conn_params_evt_send(ble_conn_params_evt_type_t evt_type)
+{
+    ble_conn_params_evt_t evt =
+    {
+        .evt_type    = evt_type,
+        .conn_handle = m_cp_conn_handle
+    };
+
+    if (m_cp_init.evt_handler != NULL)
+    {
+        m_cp_init.evt_handler(&evt);
+    }
+}
+
+
+static void conn_params_update_request(void * p_context)
+{
+    ret_code_t err_code;
+
+    if (m_cp_conn_handle == BLE_CONN_HANDLE_INVALID)
+    {
+        return;
+    }
+
+    err_code = sd_ble_gap_conn_param_update(m_cp_conn_handle, &m_cp_preferred);
+    if (err_code == NRF_SUCCESS)
+    {
+        m_cp_update_count++;
+    }
+    else if ((err_code != NRF_ERROR_BUSY) && (m_cp_init.error_handler != NULL))
+    {
+        m_cp_init.error_handler(err_code);
+    }
+}
+
+
+static void conn_params_negotiation(ble_gap_conn_params_t const * p_params, uint32_t delay)
+{
+    if (conn_params_ok(p_params))
+    {
+        conn_params_evt_send(BLE_CONN_PARAMS_EVT_SUCCEEDED);
+    }
+    else if (m_cp_update_count < m_cp_init.max_conn_params_update_count)
+    {
+        APP_ERROR_CHECK(app_timer_start(m_cp_timer, delay, NULL));
+    }
+    else
+    {
+        conn_params_evt_send(BLE_CONN_PARAMS_EVT_FAILED);
+        if (m_cp_init.disconnect_on_fail)
+        {
+            (void)sd_ble_gap_disconnect(m_cp_conn_handle, BLE_HCI_CONN_INTERVAL_UNACCEPTABLE);
+        }
+    }
+}
+
+
+static void conn_params_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    switch (p_ble_evt->header.evt_id)
+    {
+        case BLE_GAP_EVT_CONNECTED:
+            m_cp_conn_handle  = p_ble_evt->evt.gap_evt.conn_handle;
+            m_cp_update_count = 0;
+            if (!conn_params_ok(&p_ble_evt->evt.gap_evt.params.connected.conn_params))
+            {
+                APP_ERROR_CHECK(app_timer_start(m_cp_timer, m_cp_init.first_conn_params_update_delay, NULL));
+            }
+            break;
+
+        case BLE_GAP_EVT_DISCONNECTED:
+            m_cp_conn_handle = BLE_CONN_HANDLE_INVALID;
+            (void)app_timer_stop(m_cp_timer);
+            break;
+
+        case BLE_GAP_EVT_CONN_PARAM_UPDATE:
+            conn_params_negotiation(&p_ble_evt->evt.gap_evt.params.conn_param_update.conn_params,
+                                    m_cp_init.next_conn_params_update_delay);
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+ret_code_t ble_conn_params_init(ble_conn_params_init_t const * p_init)
+{
+    ret_code_t err_code;
+
+    VERIFY_PARAM_NOT_NULL(p_init);
+
+    if (p_init->start_on_notify_cccd_handle != BLE_GATT_HANDLE_INVALID)
+    {
+        sim_fail("ble_conn_params start_on_notify_cccd_handle not simulated.");
+    }
+
+    m_cp_init = *p_init;
+    if (p_init->p_conn_params != NULL)
+    {
+        m_cp_preferred = *p_init->p_conn_params;
+    }
+    else
+    {
+        err_code = sd_ble_gap_ppcp_get(&m_cp_preferred);
+        VERIFY_SUCCESS(err_code);
+    }
+
+    return app_timer_create(&m_cp_timer, APP_TIMER_MODE_SINGLE_SHOT, conn_params_update_request);
+}
+
+
+ret_code_t ble_conn_params_change_conn_params(uint16_t conn_handle, ble_gap_conn_params_t * p_new_params)
+{
+    ret_code_t err_code;
+
+    if ((conn_handle == BLE_CONN_HANDLE_INVALID) || (conn_handle != m_cp_conn_handle))
+    {
+        return BLE_ERROR_INVALID_CONN_HANDLE;
+    }
+    if (p_new_params == NULL)
+    {
+        p_new_params = &m_cp_preferred;
+    }
+
+    // Sent right away, NRF_ERROR_BUSY while another update is running.
+    err_code = sd_ble_gap_conn_param_update(conn_handle, p_new_params);
+    if (err_code == NRF_SUCCESS)
+    {
+        m_cp_update_count = 1;
+        m_cp_preferred    = *p_new_params;
+    }
+
+    return err_code;
+}
+
+
+/**@brief Function for the end of fast advertising, there is no slow mode. */
+static void advertising_timeout(void * p_context)
+{
+    ble_advertising_t * p_advertising = (ble_advertising_t *)p_context;
+
+    p_advertising->timeout_event    = 0;
+    p_advertising->adv_mode_current = BLE_ADV_MODE_IDLE;
+    sim_advertising_set(false);
+
+    p_advertising->evt_handler(BLE_ADV_EVT_IDLE);
+}
+
+
+uint32_t ble_advertising_init(ble_advertising_t * const p_advertising, ble_advertising_init_t const * const p_init)
+{
+    if ((p_advertising == NULL) || (p_init == NULL))
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (p_init->config.ble_adv_slow_enabled || p_init->config.ble_adv_whitelist_enabled)
+    {
+        sim_fail("Only fast advertising without a whitelist is simulated.");
+    }
+
+    memset(p_advertising, 0, sizeof(*p_advertising));
+    p_advertising->initialized                    = true;
+    p_advertising->adv_mode_current               = BLE_ADV_MODE_IDLE;
+    p_advertising->adv_modes_config               = p_init->config;
+    p_advertising->current_slave_link_conn_handle = BLE_CONN_HANDLE_INVALID;
+    p_advertising->evt_handler                    = p_init->evt_handler;
+    p_advertising->error_handler                  = p_init->error_handler;
+
+    return NRF_SUCCESS;
+}
+
+
+void ble_advertising_conn_cfg_tag_set(ble_advertising_t * const p_advertising, uint8_t ble_cfg_tag)
+{
+    p_advertising->conn_cfg_tag = ble_cfg_tag;
+}
+
+
+uint32_t ble_advertising_start(ble_advertising_t * const p_advertising, ble_adv_mode_t advertising_mode)
+{
+    ble_adv_modes_config_t const * p_config = &p_advertising->adv_modes_config;
+
+    if (!p_advertising->initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    sim_event_cancel(p_advertising->timeout_event);
+    p_advertising->timeout_event = 0;
+
+    // Directed modes are not configured, they fall through to fast advertising like in the SDK.
+    if ((advertising_mode == BLE_ADV_MODE_IDLE) || !p_config->ble_adv_fast_enabled)
+    {
+        p_advertising->adv_mode_current = BLE_ADV_MODE_IDLE;
+        sim_advertising_set(false);
+        p_advertising->evt_handler(BLE_ADV_EVT_IDLE);
+        return NRF_SUCCESS;
+    }
+
+    p_advertising->adv_mode_current = BLE_ADV_MODE_FAST;
+    sim_advertising_set(true);
+    if (p_config->ble_adv_fast_timeout != 0)
+    {
+        p_advertising->timeout_event = sim_event_at(sim_time_ns() + SIM_MS(p_config->ble_adv_fast_timeout * 10),
+                                                    advertising_timeout,
+                                                    p_advertising);
+    }
+    p_advertising->evt_handler(BLE_ADV_EVT_FAST);
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_advertising_restart_without_whitelist(ble_advertising_t * const p_advertising)
+{
+    if (p_advertising->adv_mode_current == BLE_ADV_MODE_IDLE)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    return ble_advertising_start(p_advertising, BLE_ADV_MODE_FAST);
+}
+
+
+void ble_advertising_on_ble_evt(ble_evt_t const * const p_ble_evt, void * p_context)
+{
+    ble_advertising_t * p_advertising = (ble_advertising_t *)p_context;
+
+    switch (p_ble_evt->header.evt_id)
+    {
+        case BLE_GAP_EVT_CONNECTED:
+            sim_event_cancel(p_advertising->timeout_event);
+            p_advertising->timeout_event                  = 0;
+            p_advertising->adv_mode_current               = BLE_ADV_MODE_IDLE;
+            p_advertising->current_slave_link_conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+            break;
+
+        case BLE_GAP_EVT_DISCONNECTED:
+            if (p_ble_evt->evt.gap_evt.conn_handle == p_advertising->current_slave_link_conn_handle)
+            {
+                p_advertising->current_slave_link_conn_handle = BLE_CONN_HANDLE_INVALID;
+                if (!p_advertising->adv_modes_config.ble_adv_on_disconnect_disabled)
+                {
+                    (void)ble_advertising_start(p_advertising, BLE_ADV_MODE_DIRECTED_HIGH_DUTY);
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+}
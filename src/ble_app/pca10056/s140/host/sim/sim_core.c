@@ -0,0 +1,256 @@
+/**@file
+ * @brief Simulated clock and event queue, and the CPU: sleep, critical regions, errors and logging.
+ */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <time.h>
+#include "sdk_common.h"
+#include "app_error.h"
+#include "app_util_platform.h"
+#include "nrf_pwr_mgmt.h"
+#include "nrf_soc.h"
+#include "sim.h"
+
+#define SIM_EVENT_COUNT     64      /**< Events pending at the same time, a handful per peripheral. */
+
+typedef struct
+{
+    uint64_t            time_ns;
+    uint64_t            seq;        /**< Orders events at the same time. */
+    uint32_t            id;         /**< 0 for a free slot. */
+    sim_event_handler_t handler;
+    void *              p_context;
+} sim_event_t;
+
+static sim_event_t  m_events[SIM_EVENT_COUNT];
+static uint64_t     m_now_ns;
+static uint64_t     m_end_ns;
+static uint64_t     m_seq;
+static uint32_t     m_next_id = 1;
+static jmp_buf      m_exit;
+static bool         m_running;
+static bool         m_verbose;
+static uint32_t     m_critical_nesting;
+
+uint32_t SystemCoreClock = 64000000;
+
+
+uint64_t sim_time_ns(void)
+{
+    return m_now_ns;
+}
+
+
+uint32_t sim_event_at(uint64_t time_ns, sim_event_handler_t handler, void * p_context)
+{
+    if (time_ns < m_now_ns)
+    {
+        sim_fail("Event scheduled in the past.");
+    }
+
+    for (uint32_t i = 0; i < SIM_EVENT_COUNT; i++)
+    {
+        if (m_events[i].id == 0)
+        {
+            m_events[i].time_ns   = time_ns;
+            m_events[i].seq       = m_seq++;
+            m_events[i].id        = m_next_id++;
+            m_events[i].handler   = handler;
+            m_events[i].p_context = p_context;
+            if (m_next_id == 0)
+            {
+                m_next_id = 1;
+            }
+            return m_events[i].id;
+        }
+    }
+
+    sim_fail("Event queue full.");
+    return 0;
+}
+
+
+void sim_event_cancel(uint32_t id)
+{
+    if (id == 0)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < SIM_EVENT_COUNT; i++)
+    {
+        if (m_events[i].id == id)
+        {
+            m_events[i].id = 0;
+            return;
+        }
+    }
+}
+
+
+/**@brief Function for the slot of the next event, NULL if nothing is scheduled. */
+static sim_event_t * event_next(void)
+{
+    sim_event_t * p_next = NULL;
+
+    for (uint32_t i = 0; i < SIM_EVENT_COUNT; i++)
+    {
+        sim_event_t * p_event = &m_events[i];
+
+        if ((p_event->id != 0)
+            && ((p_next == NULL)
+                || (p_event->time_ns < p_next->time_ns)
+                || ((p_event->time_ns == p_next->time_ns) && (p_event->seq < p_next->seq))))
+        {
+            p_next = p_event;
+        }
+    }
+
+    return p_next;
+}
+
+
+void sim_sleep(void)
+{
+    sim_event_t * p_event;
+
+    if (m_critical_nesting != 0)
+    {
+        sim_fail("Sleeping inside a critical region.");
+    }
+
+    p_event = event_next();
+    if ((p_event == NULL) || (p_event->time_ns > m_end_ns))
+    {
+        m_now_ns = m_end_ns;
+        longjmp(m_exit, SIM_RESULT_END + 1);
+    }
+
+    // Every interrupt pending at the wake-up time runs before the main loop resumes.
+    m_now_ns = p_event->time_ns;
+    while ((p_event != NULL) && (p_event->time_ns == m_now_ns))
+    {
+        sim_event_handler_t handler   = p_event->handler;
+        void *              p_context = p_event->p_context;
+
+        p_event->id = 0;
+        handler(p_context);
+        p_event = event_next();
+    }
+}
+
+
+sim_result_t sim_run(int (*app_main)(void), uint64_t end_ns)
+{
+    int jmp;
+
+    if (m_running)
+    {
+        sim_fail("Only one run per process.");
+    }
+
+    m_running = true;
+    m_end_ns  = end_ns;
+
+    jmp = setjmp(m_exit);
+    if (jmp == 0)
+    {
+        (void)app_main();
+        printf("%10.6f s  main returned\n", m_now_ns / 1e9);
+        return SIM_RESULT_ERROR;
+    }
+
+    return (sim_result_t)(jmp - 1);
+}
+
+
+void sim_verbose_set(bool verbose)
+{
+    m_verbose = verbose;
+}
+
+
+void sim_fail(char const * p_fmt, ...)
+{
+    va_list args;
+
+    printf("%10.6f s  FAIL: ", m_now_ns / 1e9);
+    va_start(args, p_fmt);
+    vprintf(p_fmt, args);
+    va_end(args);
+    printf("\n");
+
+    if (!m_running)
+    {
+        exit(EXIT_FAILURE);
+    }
+    longjmp(m_exit, SIM_RESULT_ERROR + 1);
+}
+
+
+void sim_log(char const * p_level, char const * p_fmt, ...)
+{
+    va_list args;
+
+    if (!m_verbose)
+    {
+        return;
+    }
+
+    printf("%10.6f s  <%s> ", m_now_ns / 1e9, p_level);
+    va_start(args, p_fmt);
+    vprintf(p_fmt, args);
+    va_end(args);
+    printf("\n");
+}
+
+
+void app_error_handler(ret_code_t error_code, uint32_t line_num, const uint8_t * p_file_name)
+{
+    sim_fail("APP_ERROR 0x%04x at %s:%u", error_code, (char const *)p_file_name, line_num);
+}
+
+
+uint32_t sd_power_system_off(void)
+{
+    printf("%10.6f s  system off\n", m_now_ns / 1e9);
+    longjmp(m_exit, SIM_RESULT_SYSTEM_OFF + 1);
+}
+
+
+void sim_critical_region_enter(void)
+{
+    m_critical_nesting++;
+}
+
+
+void sim_critical_region_exit(void)
+{
+    if (m_critical_nesting == 0)
+    {
+        sim_fail("Critical region exit without enter.");
+    }
+    m_critical_nesting--;
+}
+
+
+uint32_t sim_cyccnt_get(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec) * (SystemCoreClock / 1000000) / 1000);
+}
+
+
+ret_code_t nrf_pwr_mgmt_init(void)
+{
+    return NRF_SUCCESS;
+}
+
+
+void nrf_pwr_mgmt_run(void)
+{
+    sim_sleep();
+}
@@ -0,0 +1,402 @@
+/**@file
+ * @brief SDK libraries on the simulated clock: app_timer, app_scheduler, nrf_atfifo, and the
+ *        board, bond and SoftDevice handler modules the application only initializes.
+ */
+#include <string.h>
+#include "sdk_common.h"
+#include "app_timer.h"
+#include "app_scheduler.h"
+#include "nrf_atfifo.h"
+#include "bsp.h"
+#include "bsp_btn_ble.h"
+#include "peer_manager.h"
+#include "peer_manager_handler.h"
+#include "nrf_sdh.h"
+#include "nrf_sdh_ble.h"
+#include "nrf_ble_qwr.h"
+#include "sim.h"
+
+#define RTC_FREQ        (APP_TIMER_CLOCK_FREQ / (APP_TIMER_CONFIG_RTC_FREQUENCY + 1))
+#define RTC_MASK        0x00FFFFFF
+
+static app_sched_event_header_t * m_sched_headers;
+static uint8_t *                  m_sched_data;
+static uint16_t                   m_sched_event_size;
+static uint16_t                   m_sched_slots;
+static uint16_t                   m_sched_start;
+static uint16_t                   m_sched_end;
+static uint16_t                   m_sched_utilization_max;
+
+static pm_evt_handler_t           m_pm_evt_handler;
+
+
+uint64_t sim_rtc_ticks_get(void)
+{
+    return (sim_time_ns() * RTC_FREQ) / 1000000000;
+}
+
+
+uint64_t sim_rtc_tick_time_ns(uint64_t tick)
+{
+    return (tick * 1000000000 + RTC_FREQ - 1) / RTC_FREQ;
+}
+
+
+uint32_t sim_rtc_counter_get(void)
+{
+    return (uint32_t)(sim_rtc_ticks_get() & RTC_MASK);
+}
+
+
+/**@brief Function for handling the timeout of an app_timer, in the RTC interrupt. */
+static void timer_timeout(void * p_context)
+{
+    app_timer_t * p_timer = (app_timer_t *)p_context;
+
+    p_timer->event = 0;
+    if (p_timer->mode == APP_TIMER_MODE_SINGLE_SHOT)
+    {
+        p_timer->active = false;
+        p_timer->handler(p_timer->p_context);
+        return;
+    }
+
+    p_timer->handler(p_timer->p_context);
+
+    // Stopped, or stopped and started again, by the handler.
+    if (p_timer->active && (p_timer->event == 0))
+    {
+        p_timer->end_tick += p_timer->interval;
+        p_timer->event     = sim_event_at(sim_rtc_tick_time_ns(p_timer->end_tick), timer_timeout, p_timer);
+    }
+}
+
+
+ret_code_t app_timer_init(void)
+{
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t app_timer_create(app_timer_id_t const *      p_timer_id,
+                            app_timer_mode_t            mode,
+                            app_timer_timeout_handler_t timeout_handler)
+{
+    app_timer_t * p_timer;
+
+    if ((p_timer_id == NULL) || (*p_timer_id == NULL) || (timeout_handler == NULL))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    p_timer = *p_timer_id;
+    if (p_timer->active)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    memset(p_timer, 0, sizeof(*p_timer));
+    p_timer->handler = timeout_handler;
+    p_timer->mode    = mode;
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context)
+{
+    if (timeout_ticks < APP_TIMER_MIN_TIMEOUT_TICKS)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if ((timer_id == NULL) || (timer_id->handler == NULL))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    // Like app_timer2, a running timer is left alone.
+    if (timer_id->active)
+    {
+        return NRF_SUCCESS;
+    }
+
+    timer_id->active    = true;
+    timer_id->p_context = p_context;
+    timer_id->interval  = timeout_ticks;
+    timer_id->end_tick  = sim_rtc_ticks_get() + timeout_ticks;
+    timer_id->event     = sim_event_at(sim_rtc_tick_time_ns(timer_id->end_tick), timer_timeout, timer_id);
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t app_timer_stop(app_timer_id_t timer_id)
+{
+    if (timer_id == NULL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    sim_event_cancel(timer_id->event);
+    timer_id->event  = 0;
+    timer_id->active = false;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_timer_cnt_get(void)
+{
+    return sim_rtc_counter_get();
+}
+
+
+uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from)
+{
+    return (ticks_to - ticks_from) & RTC_MASK;
+}
+
+
+uint32_t app_sched_init(uint16_t max_event_size, uint16_t queue_size, void * p_evt_buffer)
+{
+    if (p_evt_buffer == NULL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // Same layout as the SDK: all headers first, then the data slots.
+    m_sched_slots       = queue_size + 1;
+    m_sched_event_size  = max_event_size;
+    m_sched_headers     = (app_sched_event_header_t *)p_evt_buffer;
+    m_sched_data        = (uint8_t *)&m_sched_headers[m_sched_slots];
+    m_sched_start       = 0;
+    m_sched_end         = 0;
+    m_sched_utilization_max = 0;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_sched_event_put(void const * p_event_data, uint16_t event_size,
+                             app_sched_event_handler_t handler)
+{
+    uint16_t next;
+    uint16_t utilization;
+
+    if (event_size > m_sched_event_size)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    next = (m_sched_end + 1) % m_sched_slots;
+    if (next == m_sched_start)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    m_sched_headers[m_sched_end].handler         = handler;
+    m_sched_headers[m_sched_end].event_data_size = event_size;
+    if ((p_event_data != NULL) && (event_size > 0))
+    {
+        memcpy(&m_sched_data[m_sched_end * m_sched_event_size], p_event_data, event_size);
+    }
+    m_sched_end = next;
+
+    utilization = (m_sched_end + m_sched_slots - m_sched_start) % m_sched_slots;
+    m_sched_utilization_max = MAX(m_sched_utilization_max, utilization);
+
+    return NRF_SUCCESS;
+}
+
+
+void app_sched_execute(void)
+{
+    while (m_sched_start != m_sched_end)
+    {
+        app_sched_event_header_t const * p_header = &m_sched_headers[m_sched_start];
+        void *                           p_data   = (p_header->event_data_size > 0)
+                                                    ? &m_sched_data[m_sched_start * m_sched_event_size]
+                                                    : NULL;
+
+        p_header->handler(p_data, p_header->event_data_size);
+
+        // Freed only after the handler, like the SDK.
+        m_sched_start = (m_sched_start + 1) % m_sched_slots;
+    }
+}
+
+
+uint16_t app_sched_queue_utilization_get(void)
+{
+    return m_sched_utilization_max;
+}
+
+
+ret_code_t nrf_atfifo_init(nrf_atfifo_t * p_fifo, void * p_buf, uint16_t buf_size, uint16_t item_size)
+{
+    if ((p_fifo == NULL) || (p_buf == NULL) || (item_size == 0) || (buf_size < 2 * item_size))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    p_fifo->p_buf      = (uint8_t *)p_buf;
+    p_fifo->item_size  = item_size;
+    p_fifo->item_count = buf_size / item_size;
+    p_fifo->head       = 0;
+    p_fifo->tail       = 0;
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_atfifo_alloc_put(nrf_atfifo_t * p_fifo, void const * p_var, size_t size, bool * p_visible)
+{
+    uint16_t next = (p_fifo->tail + 1) % p_fifo->item_count;
+
+    if (size != p_fifo->item_size)
+    {
+        sim_fail("nrf_atfifo_alloc_put: item size %u, expected %u.", (unsigned)size, p_fifo->item_size);
+    }
+    if (next == p_fifo->head)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    memcpy(&p_fifo->p_buf[p_fifo->tail * p_fifo->item_size], p_var, size);
+    p_fifo->tail = next;
+    if (p_visible != NULL)
+    {
+        *p_visible = true;
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_atfifo_get_free(nrf_atfifo_t * p_fifo, void * p_var, size_t size, bool * p_released)
+{
+    if (size != p_fifo->item_size)
+    {
+        sim_fail("nrf_atfifo_get_free: item size %u, expected %u.", (unsigned)size, p_fifo->item_size);
+    }
+    if (p_fifo->head == p_fifo->tail)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    memcpy(p_var, &p_fifo->p_buf[p_fifo->head * p_fifo->item_size], size);
+    p_fifo->head = (p_fifo->head + 1) % p_fifo->item_count;
+    if (p_released != NULL)
+    {
+        *p_released = true;
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t bsp_init(uint32_t type, bsp_event_callback_t callback)
+{
+    return NRF_SUCCESS;
+}
+
+
+uint32_t bsp_indication_set(bsp_indication_t indicate)
+{
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t bsp_btn_ble_init(bsp_btn_ble_error_handler_t error_handler, bsp_event_t * p_startup_bsp_evt)
+{
+    if (p_startup_bsp_evt != NULL)
+    {
+        *p_startup_bsp_evt = BSP_EVENT_NOTHING;
+    }
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t bsp_btn_ble_sleep_mode_prepare(void)
+{
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t pm_init(void)
+{
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t pm_sec_params_set(ble_gap_sec_params_t * p_sec_params)
+{
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t pm_register(pm_evt_handler_t event_handler)
+{
+    m_pm_evt_handler = event_handler;
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t pm_peers_delete(void)
+{
+    pm_evt_t const evt =
+    {
+        .evt_id      = PM_EVT_PEERS_DELETE_SUCCEEDED,
+        .conn_handle = BLE_CONN_HANDLE_INVALID
+    };
+
+    if (m_pm_evt_handler != NULL)
+    {
+        m_pm_evt_handler(&evt);
+    }
+    return NRF_SUCCESS;
+}
+
+
+void pm_handler_on_pm_evt(pm_evt_t const * p_pm_evt)
+{
+}
+
+
+void pm_handler_flash_clean(pm_evt_t const * p_pm_evt)
+{
+}
+
+
+ret_code_t nrf_sdh_enable_request(void)
+{
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_sdh_ble_default_cfg_set(uint8_t conn_cfg_tag, uint32_t * p_ram_start)
+{
+    *p_ram_start = 0x20002000;
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_sdh_ble_enable(uint32_t * p_app_ram_start)
+{
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_ble_qwr_init(nrf_ble_qwr_t * p_qwr, nrf_ble_qwr_init_t const * p_qwr_init)
+{
+    p_qwr->conn_handle   = BLE_CONN_HANDLE_INVALID;
+    p_qwr->error_handler = p_qwr_init->error_handler;
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_ble_qwr_conn_handle_assign(nrf_ble_qwr_t * p_qwr, uint16_t conn_handle)
+{
+    p_qwr->conn_handle = conn_handle;
+    return NRF_SUCCESS;
+}
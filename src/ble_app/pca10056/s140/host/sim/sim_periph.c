@@ -0,0 +1,679 @@
+/**@file
+ * @brief Simulated encoder and the peripherals that read it: QDEC, TIMER, PPI and GPIOTE.
+ *
+ * @details The encoder moves at a piecewise constant speed. The QDEC samples its quadrature
+ *          state on the sample period grid and decodes the difference modulo four, so an encoder
+ *          too fast for the sample period decodes wrong exactly like the hardware does. REPORTRDY
+ *          is only raised for a report with at least one non-zero sample.
+ */
+#include <math.h>
+#include <string.h>
+#include "sdk_common.h"
+#include "nrf_drv_qdec.h"
+#include "nrf_drv_timer.h"
+#include "nrf_drv_ppi.h"
+#include "nrf_drv_gpiote.h"
+#include "sim.h"
+
+#define QDEC_BASE               0x40012000UL
+#define QDEC_EVENT_OFFSET(_e)   (0x100 + 4 * (uint32_t)(_e))
+#define TIMER_COUNT             5
+#define TIMER_CC_COUNT          6
+#define TIMER_CAPTURE_OFFSET    0x040
+#define PPI_CHANNEL_COUNT       20
+#define GPIOTE_PIN_COUNT        48
+
+static const uint32_t m_timer_base[TIMER_COUNT] =
+{
+    0x40008000UL, 0x40009000UL, 0x4000A000UL, 0x4001A000UL, 0x4001B000UL
+};
+
+static const uint16_t m_reportper_samples[] = {10, 40, 80, 120, 160, 200, 240, 280};
+
+/**@brief Encoder, position in counts after x4 decoding. */
+static struct
+{
+    uint64_t t0_ns;
+    double   x0;
+    double   speed;
+} m_enc;
+
+static struct
+{
+    qdec_event_handler_t handler;
+    bool                 initialized;
+    bool                 enabled;       /**< ENABLE register. */
+    bool                 started;       /**< Between TASKS_START and TASKS_STOP. */
+    nrf_qdec_sampleper_t sampleper;
+    nrf_qdec_reportper_t reportper;
+    int64_t              last_state;    /**< Encoder state at the previous sample. */
+    uint16_t             samples;       /**< Samples in the current report period. */
+    int16_t              acc;
+    uint16_t             accdbl;
+    bool                 nonzero;       /**< A sample in the current report period was non-zero. */
+    bool                 reportrdy;     /**< EVENTS_REPORTRDY. */
+    uint64_t             next_ns;       /**< Time of the next sample. */
+    uint32_t             event;
+    sim_qdec_stats_t     stats;
+} m_qdec;
+
+typedef struct
+{
+    nrf_timer_event_handler_t handler;
+    void *                    p_context;
+    bool                      running;
+    uint64_t                  start_ns;     /**< Time the counter held start_val, while running. */
+    uint32_t                  start_val;
+    uint32_t                  frozen;       /**< Counter while stopped. */
+    uint32_t                  cc[TIMER_CC_COUNT];
+    bool                      cc_int[TIMER_CC_COUNT];
+    uint32_t                  cc_event[TIMER_CC_COUNT];
+} sim_timer_t;
+
+static sim_timer_t m_timers[TIMER_COUNT];
+
+static struct
+{
+    bool     initialized;
+    uint32_t allocated;
+    uint32_t enabled;
+    uint32_t eep[PPI_CHANNEL_COUNT];
+    uint32_t tep[PPI_CHANNEL_COUNT];
+} m_ppi;
+
+static struct
+{
+    bool                         initialized;
+    nrf_drv_gpiote_evt_handler_t handler[GPIOTE_PIN_COUNT];
+    bool                         armed[GPIOTE_PIN_COUNT];
+    uint32_t                     event;
+} m_gpiote;
+
+static void gpiote_schedule(void);
+
+
+double sim_encoder_position_get(void)
+{
+    return m_enc.x0 + m_enc.speed * (double)(sim_time_ns() - m_enc.t0_ns) / 1e9;
+}
+
+
+void sim_encoder_speed_set(double counts_per_s)
+{
+    m_enc.x0    = sim_encoder_position_get();
+    m_enc.t0_ns = sim_time_ns();
+    m_enc.speed = counts_per_s;
+    gpiote_schedule();
+}
+
+
+/**@brief Function for the encoder state, the count the A and B pins encode. */
+static int64_t encoder_state(void)
+{
+    return (int64_t)floor(sim_encoder_position_get());
+}
+
+
+void sim_qdec_stats_get(sim_qdec_stats_t * p_stats)
+{
+    *p_stats = m_qdec.stats;
+}
+
+
+bool sim_qdec_is_enabled(void)
+{
+    return m_qdec.enabled && m_qdec.started;
+}
+
+
+static uint32_t qdec_sample_us(void)
+{
+    return 128UL << m_qdec.sampleper;
+}
+
+
+/**@brief Function for the QDEC interrupt, what nrfx_qdec_irq_handler does for REPORTRDY. */
+static void qdec_irq(void)
+{
+    nrf_drv_qdec_event_t event;
+
+    // SHORTS REPORTRDY_READCLRACC, then the driver clears the event and reads the registers.
+    m_qdec.reportrdy = false;
+
+    memset(&event, 0, sizeof(event));
+    event.type               = NRF_QDEC_EVENT_REPORTRDY;
+    event.data.report.acc    = m_qdec.acc;
+    event.data.report.accdbl = m_qdec.accdbl;
+
+    m_qdec.acc     = 0;
+    m_qdec.accdbl  = 0;
+    m_qdec.nonzero = false;
+
+    m_qdec.handler(event);
+}
+
+
+static void qdec_sample(void * p_context)
+{
+    int64_t state = encoder_state();
+    int64_t diff  = state - m_qdec.last_state;
+
+    m_qdec.event      = 0;
+    m_qdec.last_state = state;
+    m_qdec.stats.samples++;
+
+    if ((diff > 2) || (diff < -2))
+    {
+        m_qdec.stats.overspeed++;
+    }
+
+    // The pins only tell the state modulo four.
+    switch (((diff % 4) + 4) % 4)
+    {
+        case 1:
+            m_qdec.acc++;
+            m_qdec.nonzero = true;
+            break;
+
+        case 2:
+            // ACCDBL is 4 bits wide and saturates.
+            m_qdec.accdbl = MIN(m_qdec.accdbl + 1, 15);
+            m_qdec.nonzero = true;
+            break;
+
+        case 3:
+            m_qdec.acc--;
+            m_qdec.nonzero = true;
+            break;
+
+        default:
+            break;
+    }
+
+    m_qdec.next_ns += SIM_US(qdec_sample_us());
+    m_qdec.event    = sim_event_at(m_qdec.next_ns, qdec_sample, NULL);
+
+    if (++m_qdec.samples >= m_reportper_samples[m_qdec.reportper])
+    {
+        m_qdec.samples = 0;
+        if (m_qdec.nonzero)
+        {
+            m_qdec.reportrdy = true;
+            m_qdec.stats.reports++;
+            sim_ppi_event(QDEC_BASE + QDEC_EVENT_OFFSET(NRF_QDEC_EVENT_REPORTRDY));
+            qdec_irq();
+        }
+    }
+}
+
+
+void nrf_qdec_task_trigger(nrf_qdec_task_t task)
+{
+    switch (task)
+    {
+        case NRF_QDEC_TASK_START:
+            if (m_qdec.enabled && !m_qdec.started)
+            {
+                m_qdec.started    = true;
+                m_qdec.samples    = 0;
+                m_qdec.last_state = encoder_state();
+                m_qdec.next_ns    = sim_time_ns() + SIM_US(qdec_sample_us());
+                m_qdec.event      = sim_event_at(m_qdec.next_ns, qdec_sample, NULL);
+            }
+            break;
+
+        case NRF_QDEC_TASK_STOP:
+            m_qdec.started = false;
+            sim_event_cancel(m_qdec.event);
+            m_qdec.event = 0;
+            break;
+
+        case NRF_QDEC_TASK_READCLRACC:
+            m_qdec.acc    = 0;
+            m_qdec.accdbl = 0;
+            break;
+    }
+}
+
+
+bool nrf_qdec_event_check(nrf_qdec_event_t event)
+{
+    return (event == NRF_QDEC_EVENT_REPORTRDY) && m_qdec.reportrdy;
+}
+
+
+void nrf_qdec_sampleper_set(nrf_qdec_sampleper_t sampleper)
+{
+    m_qdec.sampleper = sampleper;
+}
+
+
+void nrf_qdec_reportper_set(nrf_qdec_reportper_t reportper)
+{
+    if ((uint32_t)reportper >= sizeof(m_reportper_samples) / sizeof(m_reportper_samples[0]))
+    {
+        sim_fail("QDEC REPORTPER %d not simulated.", reportper);
+    }
+    m_qdec.reportper = reportper;
+}
+
+
+void nrf_qdec_dbfen_enable(void)
+{
+}
+
+
+ret_code_t nrf_drv_qdec_init(nrf_drv_qdec_config_t const * p_config, qdec_event_handler_t event_handler)
+{
+    if (m_qdec.initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (event_handler == NULL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_qdec.initialized = true;
+    m_qdec.handler     = event_handler;
+    nrf_qdec_sampleper_set((p_config != NULL) ? p_config->sampleper
+                                              : (nrf_qdec_sampleper_t)QDEC_CONFIG_SAMPLEPER);
+    nrf_qdec_reportper_set((p_config != NULL) ? p_config->reportper
+                                              : (nrf_qdec_reportper_t)QDEC_CONFIG_REPORTPER);
+
+    return NRF_SUCCESS;
+}
+
+
+void nrf_drv_qdec_enable(void)
+{
+    m_qdec.enabled = true;
+    nrf_qdec_task_trigger(NRF_QDEC_TASK_START);
+}
+
+
+void nrf_drv_qdec_disable(void)
+{
+    nrf_qdec_task_trigger(NRF_QDEC_TASK_STOP);
+    m_qdec.enabled = false;
+}
+
+
+uint32_t nrfx_qdec_event_address_get(nrf_qdec_event_t event)
+{
+    return QDEC_BASE + QDEC_EVENT_OFFSET(event);
+}
+
+
+static sim_timer_t * timer_get(nrf_drv_timer_t const * p_instance)
+{
+    if (p_instance->instance_id >= TIMER_COUNT)
+    {
+        sim_fail("TIMER%d does not exist.", p_instance->instance_id);
+    }
+    return &m_timers[p_instance->instance_id];
+}
+
+
+static uint32_t timer_counter(sim_timer_t const * p_timer)
+{
+    if (!p_timer->running)
+    {
+        return p_timer->frozen;
+    }
+    return p_timer->start_val + (uint32_t)((sim_time_ns() - p_timer->start_ns) / 1000);
+}
+
+
+static void timer_compare_schedule(sim_timer_t * p_timer, uint8_t cc_channel);
+
+
+/**@brief Function for a COMPARE event, in the TIMER interrupt. */
+static void timer_compare(void * p_context)
+{
+    sim_timer_t * p_timer    = NULL;
+    uint32_t      event_id   = 0;
+    uint8_t       cc_channel = 0;
+
+    for (uint32_t i = 0; (i < TIMER_COUNT) && (p_timer == NULL); i++)
+    {
+        for (uint8_t ch = 0; ch < TIMER_CC_COUNT; ch++)
+        {
+            if (&m_timers[i].cc_event[ch] == p_context)
+            {
+                p_timer    = &m_timers[i];
+                cc_channel = ch;
+                break;
+            }
+        }
+    }
+
+    // The counter only matches again after a full wrap.
+    p_timer->cc_event[cc_channel] = 0;
+    timer_compare_schedule(p_timer, cc_channel);
+
+    event_id = NRF_TIMER_EVENT_COMPARE0 + 4 * cc_channel;
+    p_timer->handler((nrf_timer_event_t)event_id, p_timer->p_context);
+}
+
+
+static void timer_compare_schedule(sim_timer_t * p_timer, uint8_t cc_channel)
+{
+    uint64_t ticks;
+    uint64_t elapsed;
+
+    sim_event_cancel(p_timer->cc_event[cc_channel]);
+    p_timer->cc_event[cc_channel] = 0;
+
+    if (!p_timer->running || !p_timer->cc_int[cc_channel])
+    {
+        return;
+    }
+
+    ticks = (uint32_t)(p_timer->cc[cc_channel] - timer_counter(p_timer));
+    if (ticks == 0)
+    {
+        ticks = 1ULL << 32;
+    }
+
+    elapsed = (sim_time_ns() - p_timer->start_ns) / 1000;
+    p_timer->cc_event[cc_channel] = sim_event_at(p_timer->start_ns + (elapsed + ticks) * 1000,
+                                                 timer_compare,
+                                                 &p_timer->cc_event[cc_channel]);
+}
+
+
+static void timer_compare_schedule_all(sim_timer_t * p_timer)
+{
+    for (uint8_t ch = 0; ch < TIMER_CC_COUNT; ch++)
+    {
+        timer_compare_schedule(p_timer, ch);
+    }
+}
+
+
+ret_code_t nrf_drv_timer_init(nrf_drv_timer_t const *        p_instance,
+                              nrf_drv_timer_config_t const * p_config,
+                              nrf_timer_event_handler_t      timer_event_handler)
+{
+    sim_timer_t * p_timer = timer_get(p_instance);
+
+    if (p_timer->handler != NULL)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if ((p_config->frequency != NRF_TIMER_FREQ_1MHz)
+        || (p_config->bit_width != NRF_TIMER_BIT_WIDTH_32)
+        || (p_config->mode != NRF_TIMER_MODE_TIMER))
+    {
+        sim_fail("Only the 1 MHz, 32-bit TIMER is simulated.");
+    }
+
+    memset(p_timer, 0, sizeof(*p_timer));
+    p_timer->handler   = timer_event_handler;
+    p_timer->p_context = p_config->p_context;
+
+    return NRF_SUCCESS;
+}
+
+
+void nrf_drv_timer_enable(nrf_drv_timer_t const * p_instance)
+{
+    sim_timer_t * p_timer = timer_get(p_instance);
+
+    if (p_timer->running)
+    {
+        return;
+    }
+
+    p_timer->running   = true;
+    p_timer->start_ns  = sim_time_ns();
+    p_timer->start_val = p_timer->frozen;
+    timer_compare_schedule_all(p_timer);
+}
+
+
+void nrf_drv_timer_disable(nrf_drv_timer_t const * p_instance)
+{
+    sim_timer_t * p_timer = timer_get(p_instance);
+
+    // TASKS_SHUTDOWN, the counter is cleared as well.
+    p_timer->frozen  = 0;
+    p_timer->running = false;
+    timer_compare_schedule_all(p_timer);
+}
+
+
+void nrf_drv_timer_clear(nrf_drv_timer_t const * p_instance)
+{
+    sim_timer_t * p_timer = timer_get(p_instance);
+
+    p_timer->frozen    = 0;
+    p_timer->start_ns  = sim_time_ns();
+    p_timer->start_val = 0;
+    timer_compare_schedule_all(p_timer);
+}
+
+
+uint32_t nrf_drv_timer_capture(nrf_drv_timer_t const * p_instance, nrf_timer_cc_channel_t cc_channel)
+{
+    sim_timer_t * p_timer = timer_get(p_instance);
+
+    p_timer->cc[cc_channel] = timer_counter(p_timer);
+    timer_compare_schedule(p_timer, cc_channel);
+
+    return p_timer->cc[cc_channel];
+}
+
+
+uint32_t nrf_drv_timer_capture_get(nrf_drv_timer_t const * p_instance, nrf_timer_cc_channel_t cc_channel)
+{
+    return timer_get(p_instance)->cc[cc_channel];
+}
+
+
+void nrf_drv_timer_compare(nrf_drv_timer_t const * p_instance,
+                           nrf_timer_cc_channel_t  cc_channel,
+                           uint32_t                cc_value,
+                           bool                    enable_int)
+{
+    sim_timer_t * p_timer = timer_get(p_instance);
+
+    p_timer->cc[cc_channel]     = cc_value;
+    p_timer->cc_int[cc_channel] = enable_int;
+    timer_compare_schedule(p_timer, cc_channel);
+}
+
+
+uint32_t nrf_drv_timer_capture_task_address_get(nrf_drv_timer_t const * p_instance, uint32_t channel)
+{
+    (void)timer_get(p_instance);
+    return m_timer_base[p_instance->instance_id] + TIMER_CAPTURE_OFFSET + 4 * channel;
+}
+
+
+/**@brief Function for a task triggered through PPI, only TIMER captures are connected. */
+static void ppi_task(uint32_t task_address)
+{
+    for (uint8_t i = 0; i < TIMER_COUNT; i++)
+    {
+        uint32_t offset = task_address - m_timer_base[i];
+
+        if ((task_address >= m_timer_base[i]) && (offset >= TIMER_CAPTURE_OFFSET)
+            && (offset < TIMER_CAPTURE_OFFSET + 4 * TIMER_CC_COUNT))
+        {
+            nrf_drv_timer_t const instance = NRF_DRV_TIMER_INSTANCE(i);
+
+            (void)nrf_drv_timer_capture(&instance,
+                                        (nrf_timer_cc_channel_t)((offset - TIMER_CAPTURE_OFFSET) / 4));
+            return;
+        }
+    }
+
+    sim_fail("PPI task 0x%08x not simulated.", task_address);
+}
+
+
+void sim_ppi_event(uint32_t event_address)
+{
+    for (uint8_t ch = 0; ch < PPI_CHANNEL_COUNT; ch++)
+    {
+        if ((m_ppi.enabled & (1UL << ch)) && (m_ppi.eep[ch] == event_address))
+        {
+            ppi_task(m_ppi.tep[ch]);
+        }
+    }
+}
+
+
+ret_code_t nrf_drv_ppi_init(void)
+{
+    if (m_ppi.initialized)
+    {
+        return NRF_ERROR_MODULE_ALREADY_INITIALIZED;
+    }
+    m_ppi.initialized = true;
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_drv_ppi_channel_alloc(nrf_ppi_channel_t * p_channel)
+{
+    for (uint8_t ch = 0; ch < PPI_CHANNEL_COUNT; ch++)
+    {
+        if (!(m_ppi.allocated & (1UL << ch)))
+        {
+            m_ppi.allocated |= (1UL << ch);
+            *p_channel       = ch;
+            return NRF_SUCCESS;
+        }
+    }
+    return NRF_ERROR_NO_MEM;
+}
+
+
+ret_code_t nrf_drv_ppi_channel_assign(nrf_ppi_channel_t channel, uint32_t eep, uint32_t tep)
+{
+    if ((channel >= PPI_CHANNEL_COUNT) || !(m_ppi.allocated & (1UL << channel)))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    m_ppi.eep[channel] = eep;
+    m_ppi.tep[channel] = tep;
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_drv_ppi_channel_enable(nrf_ppi_channel_t channel)
+{
+    if ((channel >= PPI_CHANNEL_COUNT) || !(m_ppi.allocated & (1UL << channel)))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    m_ppi.enabled |= (1UL << channel);
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for an encoder edge while a GPIOTE input is armed, in the GPIOTE interrupt. */
+static void gpiote_edge(void * p_context)
+{
+    int64_t  state = encoder_state();
+    uint32_t pin;
+
+    m_gpiote.event = 0;
+
+    // Gray code: B toggles between an even state and the next one, A between an odd one and the next.
+    if (m_enc.speed > 0)
+    {
+        pin = ((state - 1) & 1) ? QDEC_CONFIG_PIO_A : QDEC_CONFIG_PIO_B;
+    }
+    else
+    {
+        pin = (state & 1) ? QDEC_CONFIG_PIO_A : QDEC_CONFIG_PIO_B;
+    }
+
+    if (m_gpiote.armed[pin] && (m_gpiote.handler[pin] != NULL))
+    {
+        m_qdec.stats.wakes++;
+        m_gpiote.handler[pin](pin, NRF_GPIOTE_POLARITY_TOGGLE);
+    }
+
+    gpiote_schedule();
+}
+
+
+/**@brief Function for scheduling the next encoder edge while any input is armed. */
+static void gpiote_schedule(void)
+{
+    bool   armed = false;
+    double x     = sim_encoder_position_get();
+    double boundary;
+
+    sim_event_cancel(m_gpiote.event);
+    m_gpiote.event = 0;
+
+    for (uint32_t pin = 0; pin < GPIOTE_PIN_COUNT; pin++)
+    {
+        armed = armed || m_gpiote.armed[pin];
+    }
+    if (!armed || (m_enc.speed == 0))
+    {
+        return;
+    }
+
+    // Moving down, the state changes as soon as the position drops below its integer part.
+    boundary = (m_enc.speed > 0) ? floor(x) + 1 : floor(x);
+
+    m_gpiote.event = sim_event_at(sim_time_ns() + (uint64_t)ceil(fabs(boundary - x) / fabs(m_enc.speed) * 1e9) + 1,
+                                  gpiote_edge,
+                                  NULL);
+}
+
+
+bool nrf_drv_gpiote_is_init(void)
+{
+    return m_gpiote.initialized;
+}
+
+
+ret_code_t nrf_drv_gpiote_init(void)
+{
+    if (m_gpiote.initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    m_gpiote.initialized = true;
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_drv_gpiote_in_init(nrf_drv_gpiote_pin_t               pin,
+                                  nrf_drv_gpiote_in_config_t const * p_config,
+                                  nrf_drv_gpiote_evt_handler_t       evt_handler)
+{
+    if ((pin >= GPIOTE_PIN_COUNT) || (m_gpiote.handler[pin] != NULL))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (p_config->sense != NRF_GPIOTE_POLARITY_TOGGLE)
+    {
+        sim_fail("Only toggle sensing is simulated.");
+    }
+    m_gpiote.handler[pin] = evt_handler;
+    return NRF_SUCCESS;
+}
+
+
+void nrf_drv_gpiote_in_event_enable(nrf_drv_gpiote_pin_t pin, bool int_enable)
+{
+    m_gpiote.armed[pin] = int_enable;
+    gpiote_schedule();
+}
+
+
+void nrf_drv_gpiote_in_event_disable(nrf_drv_gpiote_pin_t pin)
+{
+    m_gpiote.armed[pin] = false;
+    gpiote_schedule();
+}
@@ -0,0 +1,205 @@
+/**@file
+ * @brief Simulated PWM0, sequence playback in individual load mode.
+ *
+ * @details Like the hardware, a sequence latches SEQ[n].PTR, CNT and REFRESH when it starts and
+ *          reads each step from RAM when the step is loaded. A SEQSTART task while playing takes
+ *          effect at the next PWM period boundary, which also sets EVENTS_PWMPERIODEND.
+ */
+#include <string.h>
+#include "sdk_common.h"
+#include "nrf_drv_pwm.h"
+#include "sim.h"
+
+#define PWM_VALUES_PER_STEP     4
+#define PWM_VALUE_MASK          0x7FFF      /**< Bit 15 is the polarity. */
+
+NRF_PWM_Type sim_pwm_regs[1];
+
+static struct
+{
+    bool              initialized;
+    bool              playing;
+    bool              loop;
+    bool              seqstart0;    /**< SEQSTART0 triggered, applies at the next period boundary. */
+    uint64_t          period_ns;
+    uint64_t          next_ns;
+    uint32_t          event;
+    uint8_t           seq_id;
+    uint16_t const *  p_values;     /**< Latched SEQ[n].PTR. */
+    uint16_t          steps;        /**< Latched SEQ[n].CNT, in steps. */
+    uint32_t          refresh;      /**< Latched SEQ[n].REFRESH. */
+    uint16_t          step;
+    uint32_t          repeat;
+    uint16_t          output[PWM_VALUES_PER_STEP];
+    sim_pwm_handler_t handler;
+    sim_pwm_stats_t   stats;
+} m_pwm;
+
+
+void sim_pwm_handler_set(sim_pwm_handler_t handler)
+{
+    m_pwm.handler = handler;
+}
+
+
+uint16_t sim_pwm_value_get(uint8_t channel)
+{
+    return m_pwm.output[channel];
+}
+
+
+void sim_pwm_stats_get(sim_pwm_stats_t * p_stats)
+{
+    *p_stats = m_pwm.stats;
+}
+
+
+static void pwm_step_load(void)
+{
+    uint16_t values[PWM_VALUES_PER_STEP];
+
+    for (uint8_t i = 0; i < PWM_VALUES_PER_STEP; i++)
+    {
+        values[i] = m_pwm.p_values[m_pwm.step * PWM_VALUES_PER_STEP + i] & PWM_VALUE_MASK;
+    }
+
+    if (memcmp(values, m_pwm.output, sizeof(values)) != 0)
+    {
+        memcpy(m_pwm.output, values, sizeof(values));
+        if (m_pwm.handler != NULL)
+        {
+            m_pwm.handler(m_pwm.output);
+        }
+    }
+}
+
+
+static void pwm_seq_start(uint8_t seq_id)
+{
+    NRF_PWM_Type const * p_reg = NRF_PWM0;
+
+    if ((p_reg->SEQ[seq_id].CNT == 0) || (p_reg->SEQ[seq_id].CNT % PWM_VALUES_PER_STEP != 0))
+    {
+        sim_fail("PWM SEQ[%u].CNT %u is not whole individual steps.", seq_id, p_reg->SEQ[seq_id].CNT);
+    }
+
+    m_pwm.seq_id   = seq_id;
+    m_pwm.p_values = (uint16_t const *)p_reg->SEQ[seq_id].PTR;
+    m_pwm.steps    = p_reg->SEQ[seq_id].CNT / PWM_VALUES_PER_STEP;
+    m_pwm.refresh  = p_reg->SEQ[seq_id].REFRESH;
+    m_pwm.step     = 0;
+    m_pwm.repeat   = 0;
+    pwm_step_load();
+}
+
+
+/**@brief Function for a PWM period boundary. */
+static void pwm_period(void * p_context)
+{
+    m_pwm.event                   = 0;
+    NRF_PWM0->EVENTS_PWMPERIODEND = 1;
+
+    if (m_pwm.seqstart0)
+    {
+        m_pwm.seqstart0 = false;
+        pwm_seq_start(0);
+    }
+    else if (++m_pwm.repeat <= m_pwm.refresh)
+    {
+        // REFRESH extra periods on the same step.
+    }
+    else if (++m_pwm.step < m_pwm.steps)
+    {
+        m_pwm.repeat = 0;
+        pwm_step_load();
+    }
+    else if (m_pwm.loop || (m_pwm.seq_id == 0))
+    {
+        pwm_seq_start(m_pwm.seq_id ^ 1);
+    }
+    else
+    {
+        m_pwm.playing = false;
+        return;
+    }
+
+    m_pwm.next_ns += m_pwm.period_ns;
+    m_pwm.event    = sim_event_at(m_pwm.next_ns, pwm_period, NULL);
+}
+
+
+void nrf_pwm_task_trigger(NRF_PWM_Type * p_reg, nrf_pwm_task_t task)
+{
+    switch (task)
+    {
+        case NRF_PWM_TASK_SEQSTART0:
+            m_pwm.stats.seqstarts++;
+            if (m_pwm.playing)
+            {
+                m_pwm.stats.seqstarts_lost += m_pwm.seqstart0;
+                m_pwm.seqstart0             = true;
+                break;
+            }
+            m_pwm.playing = true;
+            m_pwm.next_ns = sim_time_ns() + m_pwm.period_ns;
+            pwm_seq_start(0);
+            m_pwm.event   = sim_event_at(m_pwm.next_ns, pwm_period, NULL);
+            break;
+
+        case NRF_PWM_TASK_STOP:
+            m_pwm.playing   = false;
+            m_pwm.seqstart0 = false;
+            sim_event_cancel(m_pwm.event);
+            m_pwm.event = 0;
+            break;
+
+        default:
+            sim_fail("PWM task %d not simulated.", task);
+            break;
+    }
+}
+
+
+ret_code_t nrfx_pwm_init(nrfx_pwm_t const *        p_instance,
+                         nrfx_pwm_config_t const * p_config,
+                         nrfx_pwm_handler_t        handler)
+{
+    if (m_pwm.initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if ((p_config->count_mode != NRF_PWM_MODE_UP)
+        || (p_config->load_mode != NRF_PWM_LOAD_INDIVIDUAL)
+        || (p_config->step_mode != NRF_PWM_STEP_AUTO))
+    {
+        sim_fail("Only up counting, individual load and auto step are simulated.");
+    }
+
+    m_pwm.initialized = true;
+    m_pwm.period_ns   = (uint64_t)p_config->top_value * ((1000000000ULL << p_config->base_clock) / 16000000);
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t nrfx_pwm_simple_playback(nrfx_pwm_t const *         p_instance,
+                                  nrf_pwm_sequence_t const * p_sequence,
+                                  uint16_t                   playback_count,
+                                  uint32_t                   flags)
+{
+    NRF_PWM_Type * p_reg = p_instance->p_registers;
+
+    // Like nrfx, the sequence goes into both SEQ[0] and SEQ[1].
+    for (uint8_t seq_id = 0; seq_id < 2; seq_id++)
+    {
+        nrf_pwm_seq_ptr_set(p_reg, seq_id, p_sequence->values.p_raw);
+        nrf_pwm_seq_cnt_set(p_reg, seq_id, p_sequence->length);
+        nrf_pwm_seq_refresh_set(p_reg, seq_id, p_sequence->repeats);
+        nrf_pwm_seq_end_delay_set(p_reg, seq_id, p_sequence->end_delay);
+    }
+
+    m_pwm.loop = (flags & NRFX_PWM_FLAG_LOOP) != 0;
+    nrf_pwm_task_trigger(p_reg, NRF_PWM_TASK_SEQSTART0);
+
+    return 0;
+}
@@ -0,0 +1,1096 @@
+/**@file
+ * @brief Simulated S140 for one peripheral link, and the central at the other end of it.
+ *
+ * @details The GATT server keeps an attribute table like the SoftDevice does and checks the
+ *          calls the same way: a notification needs the link, an enabled CCCD, and room in the
+ *          TX queue of hvn_tx_queue_size packets. Queued notifications go out in connection
+ *          events, as many as the event length allows at the negotiated PHY and data length,
+ *          and BLE_GATTS_EVT_HVN_TX_COMPLETE follows each event that sent any. The peripheral
+ *          skips up to slave latency events while it has nothing to send.
+ *
+ *          Link procedures (ATT MTU, data length, PHY, connection parameters) complete a few
+ *          connection intervals after they are requested, with what the central accepts.
+ */
+#include <string.h>
+#include "sdk_common.h"
+#include "ble.h"
+#include "ble_hci.h"
+#include "nrf_sdh_ble.h"
+#include "sim.h"
+
+#define ATTR_COUNT              32      /**< Attributes of the application, without GAP and GATT. */
+#define ATTR_HANDLE_FIRST       0x000C  /**< First handle after the GAP and GATT services. */
+#define ATTR_VALUE_MAX_LEN      512
+#define VS_UUID_COUNT           NRF_SDH_BLE_VS_UUID_COUNT
+#define HVN_QUEUE_MAX           16
+#define WRITE_QUEUE_MAX         16
+#define ATT_HEADER_LEN          3       /**< Opcode and handle of a notification or write. */
+#define L2CAP_HEADER_LEN        4
+#define T_IFS_NS                150000
+#define CONN_HANDLE             0
+
+/**@brief Connection intervals a procedure takes, request to completion. */
+#define PROC_MTU_INTERVALS          1
+#define PROC_DATA_LENGTH_INTERVALS  1
+#define PROC_PHY_INTERVALS          2
+#define PROC_CONN_PARAM_INTERVALS   6
+#define PROC_DISCONNECT_INTERVALS   1
+
+typedef enum
+{
+    ATTR_SERVICE,
+    ATTR_CHAR_DECL,
+    ATTR_VALUE,
+    ATTR_CCCD
+} attr_kind_t;
+
+typedef struct
+{
+    attr_kind_t           kind;
+    ble_uuid_t            uuid;
+    ble_gatt_char_props_t props;        /**< Of the characteristic, for value attributes. */
+    ble_gatts_attr_md_t   md;
+    uint16_t              max_len;
+    uint16_t              len;
+    uint8_t *             p_user;       /**< Value in application memory, BLE_GATTS_VLOC_USER. */
+    uint8_t               value[ATTR_VALUE_MAX_LEN];
+    uint16_t              cccd_handle;  /**< Of the characteristic, for value attributes. */
+} attr_t;
+
+typedef struct
+{
+    uint16_t handle;
+    uint16_t len;
+    uint8_t  data[ATTR_VALUE_MAX_LEN];
+} att_pdu_t;
+
+typedef struct
+{
+    att_pdu_t pdu;
+    bool      with_response;
+} central_write_t;
+
+typedef enum
+{
+    PROC_MTU,
+    PROC_DATA_LENGTH,
+    PROC_PHY,
+    PROC_CONN_PARAM,
+    PROC_DISCONNECT,
+    PROC_COUNT
+} proc_t;
+
+/**@brief An event buffer with room for the data of a write. */
+typedef union
+{
+    ble_evt_t evt;
+    uint8_t   raw[sizeof(ble_evt_t) + ATTR_VALUE_MAX_LEN];
+} evt_buf_t;
+
+extern nrf_sdh_ble_evt_observer_t const __start_sdh_ble_observers0[] __attribute__((weak));
+extern nrf_sdh_ble_evt_observer_t const __stop_sdh_ble_observers0[]  __attribute__((weak));
+extern nrf_sdh_ble_evt_observer_t const __start_sdh_ble_observers1[] __attribute__((weak));
+extern nrf_sdh_ble_evt_observer_t const __stop_sdh_ble_observers1[]  __attribute__((weak));
+extern nrf_sdh_ble_evt_observer_t const __start_sdh_ble_observers2[] __attribute__((weak));
+extern nrf_sdh_ble_evt_observer_t const __stop_sdh_ble_observers2[]  __attribute__((weak));
+extern nrf_sdh_ble_evt_observer_t const __start_sdh_ble_observers3[] __attribute__((weak));
+extern nrf_sdh_ble_evt_observer_t const __stop_sdh_ble_observers3[]  __attribute__((weak));
+
+STATIC_ASSERT(NRF_SDH_BLE_OBSERVER_PRIO_LEVELS == 4);
+
+static ble_uuid128_t         m_vs_uuids[VS_UUID_COUNT];
+static uint8_t               m_vs_uuid_count;
+static attr_t                m_attrs[ATTR_COUNT];
+static uint16_t              m_attr_count;
+static uint16_t              m_service_handle;  /**< Last service added, characteristics go there. */
+static bool                  m_advertising;
+static ble_gap_conn_params_t m_ppcp;            /**< Peripheral preferred connection parameters. */
+
+static sim_central_config_t m_central =
+{
+    .att_mtu           = 247,
+    .data_length       = 251,
+    .phy_2m            = true,
+    .conn_interval     = 24,
+    .conn_interval_min = 12,
+    .hvn_queue_size    = 1
+};
+
+static sim_central_notify_handler_t    m_notify_handler;
+static sim_central_write_rsp_handler_t m_write_rsp_handler;
+
+static struct
+{
+    uint16_t              handle;           /**< BLE_CONN_HANDLE_INVALID without a link. */
+    ble_gap_conn_params_t params;
+    uint16_t              att_mtu;
+    uint8_t               data_length;
+    uint8_t               phy;
+    uint64_t              next_event_ns;
+    uint32_t              conn_event;
+    uint16_t              latency_skipped;
+    att_pdu_t             hvn_queue[HVN_QUEUE_MAX];
+    uint8_t               hvn_head;
+    uint8_t               hvn_count;
+    central_write_t       writes[WRITE_QUEUE_MAX];
+    uint8_t               write_head;
+    uint8_t               write_count;
+    uint32_t              proc_event[PROC_COUNT];
+    uint16_t              mtu_request;
+    uint8_t               data_length_request;
+    uint8_t               phy_request;
+    ble_gap_conn_params_t conn_params_request;
+    uint8_t               disconnect_reason;
+} m_conn = { .handle = BLE_CONN_HANDLE_INVALID };
+
+static struct
+{
+    bool                          pending;
+    uint8_t                       type;
+    uint16_t                      handle;
+    uint16_t                      gatt_status;
+    ble_gatts_evt_write_t const * p_write;
+} m_auth;
+
+static sim_link_stats_t m_stats;
+
+
+void sim_ble_evt_dispatch(ble_evt_t const * p_ble_evt)
+{
+    static struct
+    {
+        nrf_sdh_ble_evt_observer_t const * p_start;
+        nrf_sdh_ble_evt_observer_t const * p_stop;
+    } const sections[NRF_SDH_BLE_OBSERVER_PRIO_LEVELS] =
+    {
+        { __start_sdh_ble_observers0, __stop_sdh_ble_observers0 },
+        { __start_sdh_ble_observers1, __stop_sdh_ble_observers1 },
+        { __start_sdh_ble_observers2, __stop_sdh_ble_observers2 },
+        { __start_sdh_ble_observers3, __stop_sdh_ble_observers3 }
+    };
+
+    for (uint8_t prio = 0; prio < NRF_SDH_BLE_OBSERVER_PRIO_LEVELS; prio++)
+    {
+        for (nrf_sdh_ble_evt_observer_t const * p_obs = sections[prio].p_start;
+             (p_obs != NULL) && (p_obs < sections[prio].p_stop);
+             p_obs++)
+        {
+            p_obs->handler(p_ble_evt, p_obs->p_context);
+        }
+    }
+}
+
+
+static void evt_init(evt_buf_t * p_buf, uint16_t evt_id)
+{
+    memset(p_buf, 0, sizeof(*p_buf));
+    p_buf->evt.header.evt_id  = evt_id;
+    p_buf->evt.header.evt_len = sizeof(ble_evt_t);
+}
+
+
+static attr_t * attr_get(uint16_t handle)
+{
+    if ((handle < ATTR_HANDLE_FIRST) || (handle >= ATTR_HANDLE_FIRST + m_attr_count))
+    {
+        return NULL;
+    }
+    return &m_attrs[handle - ATTR_HANDLE_FIRST];
+}
+
+
+static uint8_t * attr_value(attr_t * p_attr)
+{
+    return (p_attr->p_user != NULL) ? p_attr->p_user : p_attr->value;
+}
+
+
+static void attr_store(attr_t * p_attr, uint16_t offset, uint8_t const * p_data, uint16_t len)
+{
+    memcpy(&attr_value(p_attr)[offset], p_data, len);
+    p_attr->len = p_attr->md.vlen ? (offset + len) : MAX(p_attr->len, offset + len);
+}
+
+
+static uint16_t attr_add(attr_kind_t kind, ble_uuid_t const * p_uuid)
+{
+    attr_t * p_attr;
+
+    if (m_attr_count >= ATTR_COUNT)
+    {
+        return BLE_GATT_HANDLE_INVALID;
+    }
+
+    p_attr = &m_attrs[m_attr_count];
+    memset(p_attr, 0, sizeof(*p_attr));
+    p_attr->kind = kind;
+    if (p_uuid != NULL)
+    {
+        p_attr->uuid = *p_uuid;
+    }
+
+    return ATTR_HANDLE_FIRST + m_attr_count++;
+}
+
+
+static bool uuid_type_known(uint8_t type)
+{
+    return (type == BLE_UUID_TYPE_BLE)
+           || ((type >= BLE_UUID_TYPE_VENDOR_BEGIN) && (type < BLE_UUID_TYPE_VENDOR_BEGIN + m_vs_uuid_count));
+}
+
+
+uint32_t sd_ble_uuid_vs_add(ble_uuid128_t const * p_vs_uuid, uint8_t * p_uuid_type)
+{
+    for (uint8_t i = 0; i < m_vs_uuid_count; i++)
+    {
+        if (memcmp(&m_vs_uuids[i], p_vs_uuid, sizeof(*p_vs_uuid)) == 0)
+        {
+            *p_uuid_type = BLE_UUID_TYPE_VENDOR_BEGIN + i;
+            return NRF_SUCCESS;
+        }
+    }
+
+    if (m_vs_uuid_count >= VS_UUID_COUNT)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    m_vs_uuids[m_vs_uuid_count] = *p_vs_uuid;
+    *p_uuid_type                = BLE_UUID_TYPE_VENDOR_BEGIN + m_vs_uuid_count++;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gatts_service_add(uint8_t type, ble_uuid_t const * p_uuid, uint16_t * p_handle)
+{
+    if (type != BLE_GATTS_SRVC_TYPE_PRIMARY)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (!uuid_type_known(p_uuid->type))
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    *p_handle = attr_add(ATTR_SERVICE, p_uuid);
+    if (*p_handle == BLE_GATT_HANDLE_INVALID)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    m_service_handle = *p_handle;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gatts_characteristic_add(uint16_t                   service_handle,
+                                         ble_gatts_char_md_t const * p_char_md,
+                                         ble_gatts_attr_t const *    p_attr_char_value,
+                                         ble_gatts_char_handles_t *  p_handles)
+{
+    ble_gatts_attr_md_t const * p_md = p_attr_char_value->p_attr_md;
+    bool                        cccd = p_char_md->char_props.notify || p_char_md->char_props.indicate;
+    attr_t *                    p_value;
+
+    // Characteristics can only be added to the last service.
+    if ((service_handle == BLE_GATT_HANDLE_INVALID) || (service_handle != m_service_handle))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if ((p_attr_char_value->max_len == 0) || (p_attr_char_value->max_len > ATTR_VALUE_MAX_LEN)
+        || (p_attr_char_value->init_offs + p_attr_char_value->init_len > p_attr_char_value->max_len)
+        || ((p_md->vloc == BLE_GATTS_VLOC_USER) && (p_attr_char_value->p_value == NULL))
+        || (cccd && (p_char_md->p_cccd_md == NULL)))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (!uuid_type_known(p_attr_char_value->p_uuid->type))
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    if (m_attr_count + (cccd ? 3 : 2) > ATTR_COUNT)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    memset(p_handles, 0, sizeof(*p_handles));
+    (void)attr_add(ATTR_CHAR_DECL, NULL);
+    p_handles->value_handle = attr_add(ATTR_VALUE, p_attr_char_value->p_uuid);
+
+    p_value          = attr_get(p_handles->value_handle);
+    p_value->props   = p_char_md->char_props;
+    p_value->md      = *p_md;
+    p_value->max_len = p_attr_char_value->max_len;
+    p_value->len     = p_attr_char_value->init_len;
+    if (p_md->vloc == BLE_GATTS_VLOC_USER)
+    {
+        p_value->p_user = p_attr_char_value->p_value;
+    }
+    else if (p_attr_char_value->p_value != NULL)
+    {
+        memcpy(&p_value->value[p_attr_char_value->init_offs], p_attr_char_value->p_value,
+               p_attr_char_value->init_len);
+    }
+
+    if (cccd)
+    {
+        attr_t * p_cccd;
+
+        p_handles->cccd_handle = attr_add(ATTR_CCCD, NULL);
+        p_value->cccd_handle   = p_handles->cccd_handle;
+
+        p_cccd          = attr_get(p_handles->cccd_handle);
+        p_cccd->md      = *p_char_md->p_cccd_md;
+        p_cccd->max_len = 2;
+        p_cccd->len     = 2;
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gatts_value_set(uint16_t conn_handle, uint16_t handle, ble_gatts_value_t * p_value)
+{
+    attr_t * p_attr = attr_get(handle);
+
+    if ((p_attr == NULL) || (p_attr->kind != ATTR_VALUE))
+    {
+        return BLE_ERROR_INVALID_ATTR_HANDLE;
+    }
+    if (p_value->offset + p_value->len > p_attr->max_len)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    attr_store(p_attr, p_value->offset, p_value->p_value, p_value->len);
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gatts_value_get(uint16_t conn_handle, uint16_t handle, ble_gatts_value_t * p_value)
+{
+    attr_t * p_attr = attr_get(handle);
+    uint16_t len;
+
+    if (p_attr == NULL)
+    {
+        return BLE_ERROR_INVALID_ATTR_HANDLE;
+    }
+    if (p_value->offset > p_attr->len)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    len = MIN(p_value->len, p_attr->len - p_value->offset);
+    if (p_value->p_value != NULL)
+    {
+        memcpy(p_value->p_value, &attr_value(p_attr)[p_value->offset], len);
+    }
+    p_value->len = len;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gatts_hvx(uint16_t conn_handle, ble_gatts_hvx_params_t const * p_hvx_params)
+{
+    attr_t *    p_attr = attr_get(p_hvx_params->handle);
+    attr_t *    p_cccd;
+    att_pdu_t * p_pdu;
+    uint16_t    len;
+
+    if ((conn_handle == BLE_CONN_HANDLE_INVALID) || (conn_handle != m_conn.handle))
+    {
+        return BLE_ERROR_INVALID_CONN_HANDLE;
+    }
+    if ((p_attr == NULL) || (p_attr->kind != ATTR_VALUE) || (p_attr->cccd_handle == BLE_GATT_HANDLE_INVALID))
+    {
+        return BLE_ERROR_INVALID_ATTR_HANDLE;
+    }
+    if (p_hvx_params->type != BLE_GATT_HVX_NOTIFICATION)
+    {
+        sim_fail("Only notifications are simulated.");
+    }
+    if (p_hvx_params->offset != 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    p_cccd = attr_get(p_attr->cccd_handle);
+    if ((uint16_decode(p_cccd->value) & BLE_GATT_HVX_NOTIFICATION) == 0)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    len = (p_hvx_params->p_len != NULL) ? *p_hvx_params->p_len : p_attr->len;
+    if (len > p_attr->max_len)
+    {
+        return NRF_ERROR_DATA_SIZE;
+    }
+    if (m_conn.hvn_count >= m_central.hvn_queue_size)
+    {
+        m_stats.hvx_resources++;
+        return NRF_ERROR_RESOURCES;
+    }
+
+    if (p_hvx_params->p_data != NULL)
+    {
+        attr_store(p_attr, 0, p_hvx_params->p_data, len);
+    }
+
+    // Like the SoftDevice, a value longer than the ATT MTU allows is truncated.
+    len = MIN(len, m_conn.att_mtu - ATT_HEADER_LEN);
+    if (p_hvx_params->p_len != NULL)
+    {
+        *p_hvx_params->p_len = len;
+    }
+
+    p_pdu         = &m_conn.hvn_queue[(m_conn.hvn_head + m_conn.hvn_count++) % HVN_QUEUE_MAX];
+    p_pdu->handle = p_hvx_params->handle;
+    p_pdu->len    = len;
+    memcpy(p_pdu->data, attr_value(p_attr), len);
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gatts_rw_authorize_reply(uint16_t                                      conn_handle,
+                                         ble_gatts_rw_authorize_reply_params_t const * p_rw_authorize_reply_params)
+{
+    ble_gatts_authorize_params_t const * p_params;
+    attr_t *                             p_attr;
+
+    if ((conn_handle == BLE_CONN_HANDLE_INVALID) || (conn_handle != m_conn.handle))
+    {
+        return BLE_ERROR_INVALID_CONN_HANDLE;
+    }
+    if (!m_auth.pending || (p_rw_authorize_reply_params->type != m_auth.type))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    p_params = (m_auth.type == BLE_GATTS_AUTHORIZE_TYPE_READ) ? &p_rw_authorize_reply_params->params.read
+                                                              : &p_rw_authorize_reply_params->params.write;
+    p_attr   = attr_get(m_auth.handle);
+
+    if (p_params->update && (p_params->gatt_status == BLE_GATT_STATUS_SUCCESS))
+    {
+        if (m_auth.type == BLE_GATTS_AUTHORIZE_TYPE_READ)
+        {
+            if (p_params->offset + p_params->len > p_attr->max_len)
+            {
+                return NRF_ERROR_INVALID_PARAM;
+            }
+            attr_store(p_attr, p_params->offset, p_params->p_data, p_params->len);
+        }
+        else
+        {
+            attr_store(p_attr, m_auth.p_write->offset, m_auth.p_write->data, m_auth.p_write->len);
+        }
+    }
+
+    m_auth.pending     = false;
+    m_auth.gatt_status = p_params->gatt_status;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gatts_exchange_mtu_reply(uint16_t conn_handle, uint16_t server_rx_mtu)
+{
+    if ((conn_handle == BLE_CONN_HANDLE_INVALID) || (conn_handle != m_conn.handle))
+    {
+        return BLE_ERROR_INVALID_CONN_HANDLE;
+    }
+
+    m_conn.att_mtu = MAX(BLE_GATT_ATT_MTU_DEFAULT, MIN(server_rx_mtu, m_central.att_mtu));
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for an authorize request from the central, answered before the dispatch returns.
+ *
+ * @return  GATT status of the reply.
+ */
+static uint16_t authorize_request(evt_buf_t * p_buf, uint8_t type, uint16_t handle)
+{
+    p_buf->evt.evt.gatts_evt.params.authorize_request.type = type;
+
+    m_auth.pending = true;
+    m_auth.type    = type;
+    m_auth.handle  = handle;
+    m_auth.p_write = &p_buf->evt.evt.gatts_evt.params.authorize_request.request.write;
+
+    sim_ble_evt_dispatch(&p_buf->evt);
+
+    if (m_auth.pending)
+    {
+        sim_fail("Authorize request on handle 0x%04x not answered.", handle);
+    }
+    return m_auth.gatt_status;
+}
+
+
+static uint64_t interval_ns(void)
+{
+    return (uint64_t)m_conn.params.max_conn_interval * 1250000;
+}
+
+
+/**@brief Function for the air time of one ATT PDU from one side and the empty packets answering it. */
+static uint64_t pdu_air_time_ns(uint16_t att_len)
+{
+    uint16_t left     = att_len + L2CAP_HEADER_LEN;
+    uint8_t  overhead = (m_conn.phy == BLE_GAP_PHY_2MBPS) ? 11 : 10;    // Preamble, access address, header, CRC.
+    uint8_t  rate     = (m_conn.phy == BLE_GAP_PHY_2MBPS) ? 2 : 1;      // Bits per microsecond.
+    uint64_t time_ns  = 0;
+
+    while (left > 0)
+    {
+        uint16_t payload = MIN(left, m_conn.data_length);
+
+        time_ns += ((uint64_t)(payload + overhead) * 8 * 1000) / rate + T_IFS_NS
+                   + ((uint64_t)overhead * 8 * 1000) / rate + T_IFS_NS;
+        left    -= payload;
+    }
+
+    return time_ns;
+}
+
+
+static bool connected(void)
+{
+    return m_conn.handle != BLE_CONN_HANDLE_INVALID;
+}
+
+
+/**@brief Function for a write from the central arriving at the peripheral. */
+static void write_deliver(central_write_t const * p_write)
+{
+    attr_t *                p_attr    = attr_get(p_write->pdu.handle);
+    uint16_t                status    = BLE_GATT_STATUS_SUCCESS;
+    bool                    authorize;
+    evt_buf_t               buf;
+    ble_gatts_evt_write_t * p_evt_write;
+
+    evt_init(&buf, BLE_GATTS_EVT_WRITE);
+    buf.evt.evt.gatts_evt.conn_handle = m_conn.handle;
+
+    // Like the S140, wr_auth covers Write Requests only; a Write Command is stored and reported.
+    authorize = (p_attr != NULL) && (p_attr->kind == ATTR_VALUE) && p_attr->md.wr_auth && p_write->with_response;
+    if (authorize)
+    {
+        buf.evt.header.evt_id = BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST;
+        p_evt_write           = &buf.evt.evt.gatts_evt.params.authorize_request.request.write;
+    }
+    else
+    {
+        p_evt_write = &buf.evt.evt.gatts_evt.params.write;
+    }
+
+    p_evt_write->handle = p_write->pdu.handle;
+    p_evt_write->op     = p_write->with_response ? BLE_GATTS_OP_WRITE_REQ : BLE_GATTS_OP_WRITE_CMD;
+    p_evt_write->offset = 0;
+    p_evt_write->len    = p_write->pdu.len;
+    memcpy(p_evt_write->data, p_write->pdu.data, p_write->pdu.len);
+
+    if (p_attr == NULL)
+    {
+        status = BLE_GATT_STATUS_ATTERR_INVALID_HANDLE;
+    }
+    else if (p_attr->kind == ATTR_CCCD)
+    {
+        if (p_write->pdu.len != 2)
+        {
+            status = BLE_GATT_STATUS_ATTERR_INVALID_ATT_VAL_LENGTH;
+        }
+        else
+        {
+            attr_store(p_attr, 0, p_write->pdu.data, 2);
+            sim_ble_evt_dispatch(&buf.evt);
+        }
+    }
+    else if ((p_attr->kind != ATTR_VALUE)
+             || !(p_write->with_response ? p_attr->props.write : p_attr->props.write_wo_resp))
+    {
+        status = BLE_GATT_STATUS_ATTERR_WRITE_NOT_PERMITTED;
+    }
+    else if (p_write->pdu.len > p_attr->max_len)
+    {
+        status = BLE_GATT_STATUS_ATTERR_INVALID_ATT_VAL_LENGTH;
+    }
+    else if (authorize)
+    {
+        p_evt_write->uuid = p_attr->uuid;
+        status            = authorize_request(&buf, BLE_GATTS_AUTHORIZE_TYPE_WRITE, p_write->pdu.handle);
+    }
+    else
+    {
+        p_evt_write->uuid = p_attr->uuid;
+        attr_store(p_attr, 0, p_write->pdu.data, p_write->pdu.len);
+        sim_ble_evt_dispatch(&buf.evt);
+    }
+
+    if (p_write->with_response && (m_write_rsp_handler != NULL))
+    {
+        m_write_rsp_handler(p_write->pdu.handle, status);
+    }
+}
+
+
+static void link_down(uint8_t reason)
+{
+    evt_buf_t buf;
+
+    sim_event_cancel(m_conn.conn_event);
+    m_conn.conn_event = 0;
+    for (uint8_t i = 0; i < PROC_COUNT; i++)
+    {
+        sim_event_cancel(m_conn.proc_event[i]);
+        m_conn.proc_event[i] = 0;
+    }
+
+    m_conn.hvn_count   = 0;
+    m_conn.write_count = 0;
+
+    // Without bonding the CCCDs only live as long as the link.
+    for (uint16_t i = 0; i < m_attr_count; i++)
+    {
+        if (m_attrs[i].kind == ATTR_CCCD)
+        {
+            memset(m_attrs[i].value, 0, 2);
+        }
+    }
+
+    evt_init(&buf, BLE_GAP_EVT_DISCONNECTED);
+    buf.evt.evt.gap_evt.conn_handle                = m_conn.handle;
+    buf.evt.evt.gap_evt.params.disconnected.reason = reason;
+
+    m_conn.handle = BLE_CONN_HANDLE_INVALID;
+    sim_ble_evt_dispatch(&buf.evt);
+}
+
+
+/**@brief Function for a connection event, in the SoftDevice interrupt. */
+static void conn_event(void * p_context)
+{
+    uint64_t  budget_ns = MIN((uint64_t)NRF_SDH_BLE_GAP_EVENT_LENGTH * 1250000, interval_ns());
+    uint64_t  used_ns   = 0;
+    uint8_t   sent      = 0;
+    evt_buf_t buf;
+
+    m_conn.next_event_ns += interval_ns();
+    m_conn.conn_event     = sim_event_at(m_conn.next_event_ns, conn_event, NULL);
+
+    if ((m_conn.hvn_count == 0) && (m_conn.latency_skipped < m_conn.params.slave_latency))
+    {
+        m_conn.latency_skipped++;
+        m_stats.conn_events_idle++;
+        return;
+    }
+    m_conn.latency_skipped = 0;
+    m_stats.conn_events++;
+
+    // The central sends first, what it has queued goes before the peripheral's notifications.
+    while (connected() && (m_conn.write_count > 0))
+    {
+        central_write_t write = m_conn.writes[m_conn.write_head];
+        uint64_t        time  = pdu_air_time_ns(write.pdu.len + ATT_HEADER_LEN);
+
+        if ((used_ns > 0) && (used_ns + time > budget_ns))
+        {
+            break;
+        }
+        used_ns          += time;
+        m_conn.write_head = (m_conn.write_head + 1) % WRITE_QUEUE_MAX;
+        m_conn.write_count--;
+        write_deliver(&write);
+    }
+
+    while (connected() && (m_conn.hvn_count > 0))
+    {
+        att_pdu_t pdu  = m_conn.hvn_queue[m_conn.hvn_head];
+        uint64_t  time = pdu_air_time_ns(pdu.len + ATT_HEADER_LEN);
+
+        if ((used_ns > 0) && (used_ns + time > budget_ns))
+        {
+            break;
+        }
+        used_ns        += time;
+        m_conn.hvn_head = (m_conn.hvn_head + 1) % HVN_QUEUE_MAX;
+        m_conn.hvn_count--;
+        sent++;
+
+        m_stats.notifications++;
+        m_stats.bytes += pdu.len;
+        if (m_notify_handler != NULL)
+        {
+            m_notify_handler(pdu.handle, pdu.data, pdu.len);
+        }
+    }
+
+    if (connected() && (sent > 0))
+    {
+        evt_init(&buf, BLE_GATTS_EVT_HVN_TX_COMPLETE);
+        buf.evt.evt.gatts_evt.conn_handle                  = m_conn.handle;
+        buf.evt.evt.gatts_evt.params.hvn_tx_complete.count = sent;
+        sim_ble_evt_dispatch(&buf.evt);
+    }
+}
+
+
+/**@brief Function for the completion of a link procedure, in the SoftDevice interrupt. */
+static void proc_complete(void * p_context)
+{
+    proc_t    proc = (proc_t)(uintptr_t)p_context;
+    evt_buf_t buf;
+
+    m_conn.proc_event[proc] = 0;
+
+    switch (proc)
+    {
+        case PROC_MTU:
+            m_conn.att_mtu = MAX(BLE_GATT_ATT_MTU_DEFAULT, MIN(m_conn.mtu_request, m_central.att_mtu));
+            evt_init(&buf, BLE_GATTC_EVT_EXCHANGE_MTU_RSP);
+            buf.evt.evt.gattc_evt.conn_handle                             = m_conn.handle;
+            buf.evt.evt.gattc_evt.params.exchange_mtu_rsp.server_rx_mtu = m_central.att_mtu;
+            break;
+
+        case PROC_DATA_LENGTH:
+        {
+            ble_gap_data_length_params_t * p_params;
+
+            m_conn.data_length = MAX(BLE_GAP_DATA_LENGTH_DEFAULT,
+                                     MIN(m_conn.data_length_request, m_central.data_length));
+            evt_init(&buf, BLE_GAP_EVT_DATA_LENGTH_UPDATE);
+            buf.evt.evt.gap_evt.conn_handle = m_conn.handle;
+            p_params                 = &buf.evt.evt.gap_evt.params.data_length_update.effective_params;
+            p_params->max_tx_octets  = m_conn.data_length;
+            p_params->max_rx_octets  = m_conn.data_length;
+            p_params->max_tx_time_us = (m_conn.data_length + 14) * 8;
+            p_params->max_rx_time_us = (m_conn.data_length + 14) * 8;
+        } break;
+
+        case PROC_PHY:
+            m_conn.phy = m_conn.phy_request;
+            evt_init(&buf, BLE_GAP_EVT_PHY_UPDATE);
+            buf.evt.evt.gap_evt.conn_handle              = m_conn.handle;
+            buf.evt.evt.gap_evt.params.phy_update.status = BLE_HCI_STATUS_CODE_SUCCESS;
+            buf.evt.evt.gap_evt.params.phy_update.tx_phy = m_conn.phy;
+            buf.evt.evt.gap_evt.params.phy_update.rx_phy = m_conn.phy;
+            break;
+
+        case PROC_CONN_PARAM:
+            // The new interval starts at the instant, which is now.
+            m_conn.params = m_conn.conn_params_request;
+            sim_event_cancel(m_conn.conn_event);
+            m_conn.next_event_ns = sim_time_ns() + interval_ns();
+            m_conn.conn_event    = sim_event_at(m_conn.next_event_ns, conn_event, NULL);
+
+            evt_init(&buf, BLE_GAP_EVT_CONN_PARAM_UPDATE);
+            buf.evt.evt.gap_evt.conn_handle                         = m_conn.handle;
+            buf.evt.evt.gap_evt.params.conn_param_update.conn_params = m_conn.params;
+            break;
+
+        case PROC_DISCONNECT:
+            link_down(m_conn.disconnect_reason);
+            return;
+
+        default:
+            return;
+    }
+
+    sim_ble_evt_dispatch(&buf.evt);
+}
+
+
+/**@brief Function for starting a link procedure.
+ *
+ * @return  NRF_SUCCESS, or the error of the SoftDevice call starting it.
+ */
+static uint32_t proc_start(uint16_t conn_handle, proc_t proc, uint32_t intervals)
+{
+    if ((conn_handle == BLE_CONN_HANDLE_INVALID) || (conn_handle != m_conn.handle))
+    {
+        return BLE_ERROR_INVALID_CONN_HANDLE;
+    }
+    if (m_conn.proc_event[proc] != 0)
+    {
+        return NRF_ERROR_BUSY;
+    }
+
+    m_conn.proc_event[proc] = sim_event_at(sim_time_ns() + intervals * interval_ns(),
+                                           proc_complete,
+                                           (void *)(uintptr_t)proc);
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gap_device_name_set(ble_gap_conn_sec_mode_t const * p_write_perm,
+                                    uint8_t const * p_dev_name, uint16_t len)
+{
+    return (p_dev_name == NULL) ? NRF_ERROR_NULL : NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gap_appearance_set(uint16_t appearance)
+{
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gap_ppcp_set(ble_gap_conn_params_t const * p_conn_params)
+{
+    if (p_conn_params->min_conn_interval > p_conn_params->max_conn_interval)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    m_ppcp = *p_conn_params;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gap_ppcp_get(ble_gap_conn_params_t * p_conn_params)
+{
+    *p_conn_params = m_ppcp;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gap_phy_update(uint16_t conn_handle, ble_gap_phys_t const * p_gap_phys)
+{
+    uint32_t err_code = proc_start(conn_handle, PROC_PHY, PROC_PHY_INTERVALS);
+    bool     want_2m  = (p_gap_phys->tx_phys == BLE_GAP_PHY_AUTO) || (p_gap_phys->tx_phys & BLE_GAP_PHY_2MBPS);
+
+    if (err_code == NRF_SUCCESS)
+    {
+        m_conn.phy_request = (want_2m && m_central.phy_2m) ? BLE_GAP_PHY_2MBPS : BLE_GAP_PHY_1MBPS;
+    }
+    return err_code;
+}
+
+
+uint32_t sd_ble_gap_disconnect(uint16_t conn_handle, uint8_t hci_status_code)
+{
+    uint32_t err_code = proc_start(conn_handle, PROC_DISCONNECT, PROC_DISCONNECT_INTERVALS);
+
+    if (err_code == NRF_ERROR_BUSY)
+    {
+        // Already disconnecting.
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (err_code == NRF_SUCCESS)
+    {
+        m_conn.disconnect_reason = BLE_HCI_LOCAL_HOST_TERMINATED_CONNECTION;
+    }
+    return err_code;
+}
+
+
+uint32_t sd_ble_gap_conn_param_update(uint16_t conn_handle, ble_gap_conn_params_t const * p_conn_params)
+{
+    uint32_t err_code;
+
+    if ((p_conn_params != NULL) && (p_conn_params->min_conn_interval > p_conn_params->max_conn_interval))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    err_code = proc_start(conn_handle, PROC_CONN_PARAM, PROC_CONN_PARAM_INTERVALS);
+    if ((err_code == NRF_SUCCESS) && (p_conn_params != NULL))
+    {
+        // The central grants the shortest interval asked for that it supports.
+        m_conn.conn_params_request                   = *p_conn_params;
+        m_conn.conn_params_request.min_conn_interval = MAX(p_conn_params->min_conn_interval,
+                                                           m_central.conn_interval_min);
+        m_conn.conn_params_request.max_conn_interval = m_conn.conn_params_request.min_conn_interval;
+    }
+    return err_code;
+}
+
+
+uint32_t sd_ble_gap_data_length_update(uint16_t                                 conn_handle,
+                                       ble_gap_data_length_params_t const *     p_dl_params,
+                                       ble_gap_data_length_limitation_t *       p_dl_limitation)
+{
+    uint32_t err_code = proc_start(conn_handle, PROC_DATA_LENGTH, PROC_DATA_LENGTH_INTERVALS);
+
+    if (err_code == NRF_SUCCESS)
+    {
+        m_conn.data_length_request = (p_dl_params != NULL) ? MIN(p_dl_params->max_tx_octets, 251) : 251;
+    }
+    return err_code;
+}
+
+
+uint32_t sd_ble_gattc_exchange_mtu_request(uint16_t conn_handle, uint16_t client_rx_mtu)
+{
+    uint32_t err_code;
+
+    if ((client_rx_mtu < BLE_GATT_ATT_MTU_DEFAULT) || (client_rx_mtu > NRF_SDH_BLE_GATT_MAX_MTU_SIZE))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    err_code = proc_start(conn_handle, PROC_MTU, PROC_MTU_INTERVALS);
+    if (err_code == NRF_SUCCESS)
+    {
+        m_conn.mtu_request = client_rx_mtu;
+    }
+    return err_code;
+}
+
+
+void sim_advertising_set(bool advertising)
+{
+    m_advertising = advertising;
+}
+
+
+void sim_central_config_set(sim_central_config_t const * p_config)
+{
+    if ((p_config->hvn_queue_size == 0) || (p_config->hvn_queue_size > HVN_QUEUE_MAX))
+    {
+        sim_fail("hvn_queue_size %u not simulated.", p_config->hvn_queue_size);
+    }
+    m_central = *p_config;
+}
+
+
+void sim_central_connect(void)
+{
+    evt_buf_t buf;
+
+    if (!m_advertising || connected())
+    {
+        sim_fail("Central connecting while the peripheral is not advertising.");
+    }
+
+    m_advertising = false;
+
+    memset(&m_conn, 0, sizeof(m_conn));
+    m_conn.handle                   = CONN_HANDLE;
+    m_conn.params.min_conn_interval = m_central.conn_interval;
+    m_conn.params.max_conn_interval = m_central.conn_interval;
+    m_conn.params.slave_latency     = 0;
+    m_conn.params.conn_sup_timeout  = 400;
+    m_conn.att_mtu                  = BLE_GATT_ATT_MTU_DEFAULT;
+    m_conn.data_length              = BLE_GAP_DATA_LENGTH_DEFAULT;
+    m_conn.phy                      = BLE_GAP_PHY_1MBPS;
+    m_conn.next_event_ns            = sim_time_ns() + interval_ns();
+    m_conn.conn_event               = sim_event_at(m_conn.next_event_ns, conn_event, NULL);
+
+    evt_init(&buf, BLE_GAP_EVT_CONNECTED);
+    buf.evt.evt.gap_evt.conn_handle                   = m_conn.handle;
+    buf.evt.evt.gap_evt.params.connected.role         = 1;  // BLE_GAP_ROLE_PERIPH
+    buf.evt.evt.gap_evt.params.connected.conn_params  = m_conn.params;
+    sim_ble_evt_dispatch(&buf.evt);
+}
+
+
+void sim_central_disconnect(void)
+{
+    if (connected())
+    {
+        link_down(BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+    }
+}
+
+
+uint16_t sim_central_handle_find(uint16_t uuid, bool cccd)
+{
+    for (uint16_t i = 0; i < m_attr_count; i++)
+    {
+        if ((m_attrs[i].kind == ATTR_VALUE) && (m_attrs[i].uuid.uuid == uuid))
+        {
+            return cccd ? m_attrs[i].cccd_handle : (ATTR_HANDLE_FIRST + i);
+        }
+    }
+
+    sim_fail("No characteristic with UUID 0x%04x.", uuid);
+    return BLE_GATT_HANDLE_INVALID;
+}
+
+
+void sim_central_notify_handler_set(sim_central_notify_handler_t handler)
+{
+    m_notify_handler = handler;
+}
+
+
+void sim_central_write_rsp_handler_set(sim_central_write_rsp_handler_t handler)
+{
+    m_write_rsp_handler = handler;
+}
+
+
+void sim_central_write(uint16_t handle, uint8_t const * p_data, uint16_t len, bool with_response)
+{
+    central_write_t * p_write;
+
+    if (!connected())
+    {
+        sim_fail("Central writing without a link.");
+    }
+    if ((m_conn.write_count >= WRITE_QUEUE_MAX) || (len > m_conn.att_mtu - ATT_HEADER_LEN))
+    {
+        sim_fail("Central write of %u bytes does not fit.", len);
+    }
+
+    p_write                = &m_conn.writes[(m_conn.write_head + m_conn.write_count++) % WRITE_QUEUE_MAX];
+    p_write->pdu.handle    = handle;
+    p_write->pdu.len       = len;
+    p_write->with_response = with_response;
+    memcpy(p_write->pdu.data, p_data, len);
+}
+
+
+void sim_central_subscribe(uint16_t uuid, bool enable)
+{
+    uint8_t cccd[2];
+
+    (void)uint16_encode(enable ? BLE_GATT_HVX_NOTIFICATION : 0, cccd);
+    sim_central_write(sim_central_handle_find(uuid, true), cccd, sizeof(cccd), true);
+}
+
+
+uint16_t sim_central_read(uint16_t handle, uint8_t * p_buf, uint16_t max_len)
+{
+    attr_t *  p_attr = attr_get(handle);
+    evt_buf_t buf;
+    uint16_t  len;
+
+    if (!connected() || (p_attr == NULL)
+        || ((p_attr->kind == ATTR_VALUE) && !p_attr->props.read))
+    {
+        return 0;
+    }
+
+    if ((p_attr->kind == ATTR_VALUE) && p_attr->md.rd_auth)
+    {
+        evt_init(&buf, BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST);
+        buf.evt.evt.gatts_evt.conn_handle                                 = m_conn.handle;
+        buf.evt.evt.gatts_evt.params.authorize_request.request.read.handle = handle;
+        buf.evt.evt.gatts_evt.params.authorize_request.request.read.uuid   = p_attr->uuid;
+        buf.evt.evt.gatts_evt.params.authorize_request.request.read.offset = 0;
+
+        if (authorize_request(&buf, BLE_GATTS_AUTHORIZE_TYPE_READ, handle) != BLE_GATT_STATUS_SUCCESS)
+        {
+            return 0;
+        }
+    }
+
+    len = MIN(max_len, p_attr->len);
+    memcpy(p_buf, attr_value(p_attr), len);
+    return len;
+}
+
+
+void sim_link_stats_get(sim_link_stats_t * p_stats)
+{
+    *p_stats               = m_stats;
+    p_stats->att_mtu       = m_conn.att_mtu;
+    p_stats->data_length   = m_conn.data_length;
+    p_stats->phy           = m_conn.phy;
+    p_stats->conn_interval = m_conn.params.max_conn_interval;
+    p_stats->slave_latency = m_conn.params.slave_latency;
+}
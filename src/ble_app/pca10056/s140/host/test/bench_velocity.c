@@ -0,0 +1,153 @@
+/**@file
+ * @brief Host benchmark of the velocity estimator, with a check of slow steady motion.
+ *
+ * @details The benchmark feeds pseudo random sprint reports through sled_velocity_update and
+ *          prints the time per report, and the TSC cycles per report on x86. Host numbers only
+ *          rank changes to the filter; the Cortex-M4 figure comes from the SLED_PROF_POWER
+ *          profile counter on the target.
+ *
+ *          The check replays steady 300 and 600 counts/s in the fastest range, where most reports
+ *          carry no count. The estimate must never drop to rest while the sled moves and must
+ *          settle close to the true speed.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "sdk_common.h"
+#include "sled_velocity.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define TAU_US          50000       /**< QENC_VELOCITY_TAU_US in main.c. */
+#define BENCH_REPORTS   20000000
+#define BENCH_PATTERN   4096        /**< Precomputed reports, a power of two. */
+#define STEADY_US       2000000     /**< Duration of each steady speed run. */
+#define SETTLE_US       500000      /**< Time the filter gets to settle before it is checked. */
+#define STEADY_TOL      0.05        /**< Largest relative deviation from the true speed once settled. */
+
+static const uint32_t m_period_us[] = {128 * 10, 256 * 40, 512 * 40};
+
+static int32_t  m_counts[BENCH_PATTERN];
+static uint32_t m_rng = 12345;
+
+static volatile int32_t m_sink;     /**< Keeps the compiler from dropping the updates. */
+
+
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+
+static uint64_t cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+
+static void bench(sled_velocity_t * p_vel)
+{
+    uint64_t t0;
+    uint64_t c0;
+    uint64_t ns;
+    uint64_t cyc;
+
+    // Sprint reports in range 0: up to 16 counts per 1.28 ms, about 12 m/s.
+    for (uint32_t i = 0; i < BENCH_PATTERN; i++)
+    {
+        m_rng       = m_rng * 1664525 + 1013904223;
+        m_counts[i] = (int32_t)((m_rng >> 16) % 17);
+    }
+
+    sled_velocity_reset(p_vel);
+    t0 = time_ns();
+    c0 = cycles();
+    for (uint32_t i = 0; i < BENCH_REPORTS; i++)
+    {
+        sled_velocity_update(p_vel, 0, m_counts[i & (BENCH_PATTERN - 1)], m_period_us[0]);
+    }
+    cyc = cycles() - c0;
+    ns  = time_ns() - t0;
+    m_sink = p_vel->vel_q16;
+
+    printf("sled_velocity_update: %.2f ns per report", (double)ns / BENCH_REPORTS);
+    if (cyc != 0)
+    {
+        printf(", %.1f TSC cycles per report", (double)cyc / BENCH_REPORTS);
+    }
+    printf("\n");
+}
+
+
+/**@brief Function for replaying a steady speed in range 0, whole counts as the QDEC reports them.
+ *
+ * @return  Number of failed checks.
+ */
+static int steady(sled_velocity_t * p_vel, uint32_t counts_per_s)
+{
+    uint32_t period_us = m_period_us[0];
+    uint64_t t_us      = 0;
+    int64_t  counted   = 0;
+    double   dev_max   = 0;
+    uint32_t rest      = 0;
+
+    sled_velocity_reset(p_vel);
+
+    while (t_us < STEADY_US)
+    {
+        int64_t counts;
+
+        t_us  += period_us;
+        counts = (int64_t)((t_us * counts_per_s) / 1000000) - counted;
+        counted += counts;
+
+        sled_velocity_update(p_vel, 0, (int32_t)counts, period_us);
+
+        if (t_us >= SETTLE_US)
+        {
+            double vel = p_vel->vel_q16 / 65536.0;
+
+            rest    += (p_vel->vel_q16 == 0);
+            dev_max  = MAX(dev_max, ABS(vel - counts_per_s) / counts_per_s);
+        }
+    }
+
+    printf("%4u counts/s: %u reports at rest, worst deviation %.1f %%\n",
+           counts_per_s, rest, dev_max * 100);
+
+    return (rest != 0) + (dev_max > STEADY_TOL);
+}
+
+
+int main(void)
+{
+    sled_velocity_t vel;
+    int             failures = 0;
+
+    if (sled_velocity_init(&vel, m_period_us, sizeof(m_period_us) / sizeof(m_period_us[0]), TAU_US)
+        != NRF_SUCCESS)
+    {
+        printf("init failed\n");
+        return EXIT_FAILURE;
+    }
+
+    failures += steady(&vel, 300);
+    failures += steady(&vel, 600);
+    bench(&vel);
+
+    if (failures != 0)
+    {
+        printf("%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,94 @@
+/**@file
+ * @brief Host test replaying millions of synthetic QDEC reports through the odometer.
+ *
+ * @details The reference distance is computed from the exact count sum in 128-bit arithmetic, so
+ *          any drift or rounding in the odometer shows up as a mismatch. The float accumulator the
+ *          odometer replaced is run alongside, and its error is reported for comparison.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "sdk_common.h"
+#include "odometer.h"
+
+#define CPR             1024            /**< Encoder counts per revolution, as in main.c. */
+#define REPORTS         20000000        /**< About 7 hours of reports at 1.28 ms. */
+#define CHECK_INTERVAL  100000          /**< Reports between two comparisons. */
+#define SESSION_RESET   (REPORTS / 2)   /**< Report at which a new session starts. */
+
+static int      m_failures;
+static uint32_t m_rng = 12345;
+
+/**@brief Deterministic pseudo random counts of one report, mostly forward with some pushing back. */
+static int32_t report_counts(void)
+{
+    m_rng = m_rng * 1664525 + 1013904223;
+    return (int32_t)((m_rng >> 16) % 48) - 6;
+}
+
+/**@brief Reference conversion, rounded toward zero like the odometer. */
+static int64_t mm_ref(int64_t counts)
+{
+    return (int64_t)(((__int128)counts * ODOMETER_UM_PER_REV) / ((__int128)CPR * 1000));
+}
+
+static void check(char const * p_what, int64_t got, int64_t expected)
+{
+    if (got != expected)
+    {
+        if (m_failures++ < 10)
+        {
+            printf("%s: %lld mm, expected %lld mm\n", p_what, (long long)got, (long long)expected);
+        }
+    }
+}
+
+int main(void)
+{
+    odometer_t odo;
+    int64_t    session  = 0;
+    int64_t    lifetime = 0;
+    float      total_f  = 0;
+    int64_t    total    = 0;
+
+    if (odometer_init(&odo, CPR) != NRF_SUCCESS)
+    {
+        printf("init failed\n");
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t i = 1; i <= REPORTS; i++)
+    {
+        int32_t counts = report_counts();
+
+        odometer_add(&odo, counts);
+        session  += counts;
+        lifetime += ABS(counts);
+        total    += counts;
+        total_f  += counts;
+
+        if (i == SESSION_RESET)
+        {
+            odometer_session_reset(&odo);
+            session = 0;
+        }
+        if ((i % CHECK_INTERVAL) == 0)
+        {
+            check("session", odometer_session_mm(&odo), mm_ref(session));
+            check("lifetime", odometer_lifetime_mm(&odo), mm_ref(lifetime));
+        }
+    }
+
+    printf("%u reports, lifetime %lld mm, net %lld counts\n",
+           REPORTS, (long long)odometer_lifetime_mm(&odo), (long long)total);
+    printf("float accumulator: %.0f counts, off by %lld counts (%lld mm)\n",
+           total_f, (long long)((int64_t)total_f - total),
+           (long long)(mm_ref((int64_t)total_f) - mm_ref(total)));
+
+    // Far beyond any real sled: the conversion must not overflow near the limits of the counters.
+    odo.session_counts = INT64_MAX;
+    check("session at INT64_MAX", odometer_session_mm(&odo), mm_ref(INT64_MAX));
+    odo.session_counts = -INT64_MAX;
+    check("session at -INT64_MAX", odometer_session_mm(&odo), mm_ref(-INT64_MAX));
+
+    return (m_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
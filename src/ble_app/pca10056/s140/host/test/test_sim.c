@@ -0,0 +1,650 @@
+/**@file
+ * @brief Host test running the whole application on the simulated chip, one scenario per run.
+ *
+ * @details A scenario schedules what the rider and the central do, runs the unmodified firmware
+ *          until its end time and checks what came out: the published snapshots, the PWM output
+ *          and what the central received. Every run is deterministic.
+ *
+ *          test_sim <sprint|commands|park|link|power|kick> [-v]
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdk_common.h"
+#include "ble_sls.h"
+#include "ble_dgs.h"
+#include "odometer.h"
+#include "pwm_controller.h"
+#include "qdec_acq.h"
+#include "sled_snapshot.h"
+#include "sim.h"
+
+#define CPR                 1024        /**< Encoder counts per revolution, QENC_COUNTS_PER_REV in main.c. */
+#define PWM_PERIOD_MS       20
+#define QDEC_FAST_SAMPLES_S (1000000 / QDEC_ACQ_FAST_SAMPLE_US)
+
+#define SPRINT_ACCEL_STEP_MS    100     /**< Speed steps of a rider accelerating at 4 m/s^2. */
+#define SPRINT_ACCEL_STEP_MM_S  400
+
+#define POWER_TARGET_DW     30          /**< Constant power target, 0.1 W. */
+#define POWER_FREE_MM_S     9000        /**< Speed the rider holds without resistance. */
+#define POWER_STEP_MS       10          /**< Flywheel model step. */
+#define POWER_TAU_MS        500         /**< Time the flywheel takes to follow the brake. */
+#define POWER_SETTLE_S      8           /**< Time the loop gets before power is checked. */
+#define POWER_TOL           0.1         /**< Largest relative deviation of the settled power. */
+
+#define COUNTERS_COALESCED_OFFSET   28  /**< Byte offset of tx_stats.coalesced in the DGS Counters value. */
+#define COUNTERS_SATURATED_OFFSET   52  /**< Byte offset of the ACCDBL saturated reports in the DGS Counters value. */
+
+int sled_app_main(void);
+void __real_sled_snapshot_publish(sled_snapshot_t * p_snap, sled_snapshot_data_t const * p_data);
+
+typedef struct
+{
+    char const * p_name;
+    void      (* setup)(void);
+    uint64_t     end_ns;
+    void      (* check)(void);
+} scenario_t;
+
+static int                  m_failures;
+static sled_snapshot_data_t m_snap;             /**< Latest published snapshot. */
+static int64_t              m_offset_min_us;    /**< Smallest simulated time minus snapshot time. */
+static int64_t              m_offset_max_us;
+static bool                 m_offset_valid;
+
+static uint64_t             m_window_start_ns;  /**< Stream latency and throughput are measured in this window. */
+static uint64_t             m_window_end_ns;
+static uint32_t             m_stream_recs;
+static uint32_t             m_stream_bytes;
+static int32_t              m_stream_latency_max_ticks;
+
+static uint16_t             m_pwm_status[2];    /**< Last command status: opcode and ATT status. */
+static uint16_t             m_write_rsp_status;
+static uint64_t             m_write_rsp_ns;
+static uint16_t             m_pwm_target;       /**< Channel 0 value whose arrival time is recorded. */
+static uint64_t             m_pwm_target_ns;
+static bool                 m_profile_seen[2];  /**< SET_PROFILE points seen on channels 0 and 1. */
+static bool                 m_mode_seen;        /**< PWM_LEFT waveform seen. */
+static uint32_t             m_samples_mark;
+static uint32_t             m_samples_pinned;
+static uint32_t             m_samples_auto;
+static uint32_t             m_coalesced;
+static uint32_t             m_accdbl_saturated;
+static double               m_flywheel_mm_s;
+static double               m_power_min;        /**< Settled power range, in watts. */
+static double               m_power_max;
+
+
+#define CHECK(_cond, ...)                       \
+    do                                          \
+    {                                           \
+        if (!(_cond))                           \
+        {                                       \
+            printf("CHECK failed: " __VA_ARGS__); \
+            printf("\n");                       \
+            m_failures++;                       \
+        }                                       \
+    } while (0)
+
+
+/**@brief Records every snapshot and how far its clock is from the simulated one. */
+void __wrap_sled_snapshot_publish(sled_snapshot_t * p_snap, sled_snapshot_data_t const * p_data)
+{
+    int64_t offset_us = (int64_t)(sim_time_ns() / 1000) - (int64_t)p_data->time_us;
+
+    m_snap = *p_data;
+    if (!m_offset_valid)
+    {
+        m_offset_min_us = offset_us;
+        m_offset_max_us = offset_us;
+        m_offset_valid  = true;
+    }
+    m_offset_min_us = MIN(m_offset_min_us, offset_us);
+    m_offset_max_us = MAX(m_offset_max_us, offset_us);
+
+    __real_sled_snapshot_publish(p_snap, p_data);
+}
+
+
+/**@brief Distance of the whole counts the encoder moved, rounded toward zero like the odometer. */
+static int64_t truth_mm(void)
+{
+    int64_t counts = (int64_t)floor(sim_encoder_position_get());
+
+    return (counts * ODOMETER_UM_PER_REV) / (CPR * 1000);
+}
+
+
+static void on_notify(uint16_t handle, uint8_t const * p_data, uint16_t len)
+{
+    uint64_t now = sim_time_ns();
+
+    if (handle == sim_central_handle_find(SLED_PWM_CHAR_UUID, false))
+    {
+        m_pwm_status[0] = p_data[1];
+        m_pwm_status[1] = uint16_decode(&p_data[2]);
+        return;
+    }
+    if ((handle != sim_central_handle_find(SLED_STREAM_CHAR_UUID, false))
+        || (now < m_window_start_ns) || (now > m_window_end_ns) || !m_offset_valid)
+    {
+        return;
+    }
+
+    // Record timestamps are on the snapshot clock, the earliest publish sets its offset.
+    uint16_t now_ticks = (uint16_t)(((now / 1000 - m_offset_min_us) * BLE_SLS_STREAM_TICK_HZ) / 1000000);
+
+    for (uint16_t i = BLE_SLS_STREAM_HDR_LEN; i + BLE_SLS_STREAM_REC_LEN <= len; i += BLE_SLS_STREAM_REC_LEN)
+    {
+        int32_t latency = (uint16_t)(now_ticks - uint16_decode(&p_data[i]));
+
+        m_stream_latency_max_ticks = MAX(m_stream_latency_max_ticks, latency);
+        m_stream_recs++;
+    }
+    m_stream_bytes += len;
+}
+
+
+static void on_write_rsp(uint16_t handle, uint16_t gatt_status)
+{
+    m_write_rsp_status = gatt_status;
+    m_write_rsp_ns     = sim_time_ns();
+}
+
+
+static void on_pwm(uint16_t const * p_values)
+{
+    if ((m_pwm_target != 0) && (m_pwm_target_ns == 0) && (p_values[0] == m_pwm_target))
+    {
+        m_pwm_target_ns = sim_time_ns();
+    }
+    m_profile_seen[0] |= (p_values[0] == 1000) && (p_values[1] == 2000);
+    m_profile_seen[1] |= (p_values[0] == 3000) && (p_values[1] == 4000);
+    m_mode_seen       |= (p_values[0] == 7500) && (p_values[1] == 2000) && (p_values[2] == 7500);
+}
+
+
+static void at(uint64_t time_ns, sim_event_handler_t handler, void * p_context)
+{
+    (void)sim_event_at(time_ns, handler, p_context);
+}
+
+
+static void speed_set(void * p_context)
+{
+    // Speed in mm/s, converted to counts per second.
+    double mm_s = (double)(intptr_t)p_context;
+
+    sim_encoder_speed_set(mm_s * 1000 * CPR / ODOMETER_UM_PER_REV);
+}
+
+
+static void speed_at(uint64_t time_ns, int32_t mm_s)
+{
+    at(time_ns, speed_set, (void *)(intptr_t)mm_s);
+}
+
+
+/**@brief Function for a rider accelerating or braking at SPRINT_ACCEL_MM_S2 from one speed to another. */
+static void speed_ramp(uint64_t time_ns, int32_t from_mm_s, int32_t to_mm_s)
+{
+    int32_t  step  = (to_mm_s > from_mm_s) ? SPRINT_ACCEL_STEP_MM_S : -SPRINT_ACCEL_STEP_MM_S;
+    uint32_t steps = (uint32_t)ABS(to_mm_s - from_mm_s) / SPRINT_ACCEL_STEP_MM_S;
+
+    for (uint32_t i = 1; i <= steps; i++)
+    {
+        speed_at(time_ns + SIM_MS(SPRINT_ACCEL_STEP_MS) * (i - 1), from_mm_s + step * (int32_t)i);
+    }
+    speed_at(time_ns + SIM_MS(SPRINT_ACCEL_STEP_MS) * steps, to_mm_s);
+}
+
+
+static void connect(void * p_context)
+{
+    sim_central_connect();
+}
+
+
+static void subscribe(void * p_context)
+{
+    sim_central_subscribe((uint16_t)(uintptr_t)p_context, true);
+}
+
+
+static void link_up(uint64_t time_ns, uint16_t const * p_uuids, uint8_t count)
+{
+    sim_central_notify_handler_set(on_notify);
+    sim_central_write_rsp_handler_set(on_write_rsp);
+    at(time_ns, connect, NULL);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        at(time_ns + SIM_MS(100), subscribe, (void *)(uintptr_t)p_uuids[i]);
+    }
+}
+
+
+static void cmd_write(uint8_t const * p_cmd, uint16_t len, bool with_response)
+{
+    m_write_rsp_status = 0xFFFF;
+    sim_central_write(sim_central_handle_find(SLED_PWM_CHAR_UUID, false), p_cmd, len, with_response);
+}
+
+
+static void counters_read(void * p_context)
+{
+    uint8_t  buf[BLE_DGS_VALUE_MAX_LEN];
+    uint16_t len = sim_central_read(sim_central_handle_find(SLED_DIAG_COUNTERS_CHAR_UUID, false),
+                                    buf, sizeof(buf));
+
+    CHECK(len == BLE_DGS_COUNTERS_LEN, "DGS Counters read %u bytes", len);
+    if (len == BLE_DGS_COUNTERS_LEN)
+    {
+        m_coalesced        = uint32_decode(&buf[COUNTERS_COALESCED_OFFSET]);
+        m_accdbl_saturated = uint32_decode(&buf[COUNTERS_SATURATED_OFFSET]);
+    }
+}
+
+
+/* Sprint: 0 to 8 m/s, hold, stop, rest. */
+
+static void sprint_setup(void)
+{
+    static uint16_t const uuids[] = { SLED_VALUE_CHAR_UUID, SLED_STREAM_CHAR_UUID };
+
+    link_up(SIM_S(1), uuids, ARRAY_SIZE(uuids));
+    speed_ramp(SIM_S(2), 0, 8000);
+    speed_ramp(SIM_S(7), 8000, 0);
+
+    // The link has switched to the active interval one second into the sprint.
+    m_window_start_ns = SIM_S(3) + SIM_MS(500);
+    m_window_end_ns   = SIM_S(7);
+}
+
+
+static void sprint_check(void)
+{
+    sim_link_stats_t link;
+    sim_qdec_stats_t qdec;
+    double           window_s = (m_window_end_ns - m_window_start_ns) / 1e9;
+
+    sim_link_stats_get(&link);
+    sim_qdec_stats_get(&qdec);
+
+    printf("distance %lld mm, truth %lld mm\n", (long long)m_snap.session_mm, (long long)truth_mm());
+    printf("stream %u records, %.0f B/s, latency max %d ms\n",
+           m_stream_recs, m_stream_bytes / window_s, m_stream_latency_max_ticks * 1000 / BLE_SLS_STREAM_TICK_HZ);
+    printf("link mtu %u, dl %u, phy %u, interval %u, %u notifications, %u events, %u skipped\n",
+           link.att_mtu, link.data_length, link.phy, link.conn_interval, link.notifications,
+           link.conn_events, link.conn_events_idle);
+
+    CHECK(m_snap.session_mm == truth_mm(), "distance does not match the encoder");
+    CHECK(qdec.overspeed == 0, "%u QDEC samples overspeed", qdec.overspeed);
+    CHECK((m_snap.power_q16 == 0) && !m_snap.moving, "power %u not back to zero", m_snap.power_q16);
+    CHECK(!sim_qdec_is_enabled(), "QDEC sampling still running at rest");
+    CHECK(m_stream_recs > 0, "no stream records");
+    CHECK(m_stream_latency_max_ticks * 1000 / BLE_SLS_STREAM_TICK_HZ <= 150,
+          "stream latency above 150 ms");
+    CHECK((link.att_mtu == 247) && (link.phy == BLE_GAP_PHY_2MBPS), "link not upgraded");
+}
+
+
+/* Commands: every Sled PWM opcode while the central watches the PWM output. */
+
+static void value_write(void * p_context)
+{
+    static uint8_t const value[sizeof(ble_sls_sled_value_t)] = { 0 };
+
+    m_write_rsp_status = 0xFFFF;
+    sim_central_write(sim_central_handle_find(SLED_VALUE_CHAR_UUID, false), value, sizeof(value), true);
+}
+
+
+static void cmd_duty(void * p_context)
+{
+    static uint8_t const cmd[] = { BLE_SLS_CMD_SET_DUTY | BLE_SLS_CMD_FLAG_SEQ, 1, 0x88, 0x13, 200, 0 };
+
+    CHECK(m_write_rsp_status == BLE_GATT_STATUS_ATTERR_WRITE_NOT_PERMITTED, "Sled Value write status 0x%04x",
+          m_write_rsp_status);
+
+    m_pwm_target = 5000;
+    cmd_write(cmd, sizeof(cmd), true);
+}
+
+
+static void cmd_duty_burst(void * p_context)
+{
+    // Two levels in one connection event, both within one PWM period. Without response, so the
+    // SET_DUTY write response stays for cmd_invalid to check.
+    static uint8_t const cmd[2][5] =
+    {
+        { BLE_SLS_CMD_SET_DUTY, 0xE8, 0x03, 0, 0 },
+        { BLE_SLS_CMD_SET_DUTY, 0xD0, 0x07, 0, 0 }
+    };
+    uint16_t handle = sim_central_handle_find(SLED_PWM_CHAR_UUID, false);
+
+    sim_central_write(handle, cmd[0], sizeof(cmd[0]), false);
+    sim_central_write(handle, cmd[1], sizeof(cmd[1]), false);
+}
+
+
+static void cmd_duty_burst_check(void * p_context)
+{
+    sim_pwm_stats_t pwm;
+
+    sim_pwm_stats_get(&pwm);
+    CHECK(sim_pwm_value_get(0) == 2000, "last of two levels not applied, duty %u", sim_pwm_value_get(0));
+    CHECK(pwm.seqstarts_lost == 0, "%u PWM sequence starts replaced before they played", pwm.seqstarts_lost);
+}
+
+
+static void cmd_invalid(void * p_context)
+{
+    static uint8_t const cmd[] = { 0x7F };
+
+    CHECK(m_write_rsp_status == BLE_GATT_STATUS_SUCCESS, "SET_DUTY status 0x%04x", m_write_rsp_status);
+    CHECK(m_pwm_target_ns != 0, "duty never reached");
+    if (m_pwm_target_ns != 0)
+    {
+        uint64_t ramp_ms = (m_pwm_target_ns - m_write_rsp_ns) / 1000000;
+
+        printf("duty ramp done %llu ms after the write\n", (unsigned long long)ramp_ms);
+        CHECK((ramp_ms >= 200 - PWM_PERIOD_MS) && (ramp_ms <= 200 + 2 * PWM_PERIOD_MS), "ramp %llu ms",
+              (unsigned long long)ramp_ms);
+    }
+    CHECK((m_pwm_status[0] == BLE_SLS_CMD_SET_DUTY) && (m_pwm_status[1] == BLE_GATT_STATUS_SUCCESS),
+          "SET_DUTY status notification");
+
+    cmd_write(cmd, sizeof(cmd), true);
+}
+
+
+static void cmd_mode(void * p_context)
+{
+    // A Write Command: no write response, the status comes back as a notification.
+    static uint8_t const cmd[] = { BLE_SLS_CMD_SET_MODE | BLE_SLS_CMD_FLAG_SEQ, 2, PWM_LEFT };
+
+    CHECK(m_write_rsp_status == BLE_SLS_ATTERR_UNKNOWN_OPCODE, "invalid opcode status 0x%04x",
+          m_write_rsp_status);
+
+    cmd_write(cmd, sizeof(cmd), false);
+}
+
+
+static void cmd_profile(void * p_context)
+{
+    static uint8_t const cmd[] =
+    {
+        BLE_SLS_CMD_SET_PROFILE, 2,
+        0xE8, 0x03, 0xD0, 0x07, 10, 0,
+        0xB8, 0x0B, 0xA0, 0x0F, 10, 0
+    };
+
+    CHECK(m_mode_seen, "SET_MODE output never seen");
+    CHECK(m_write_rsp_status == 0xFFFF, "write response 0x%04x to a Write Command", m_write_rsp_status);
+    CHECK((m_pwm_status[0] == BLE_SLS_CMD_SET_MODE) && (m_pwm_status[1] == BLE_GATT_STATUS_SUCCESS),
+          "SET_MODE status notification");
+
+    cmd_write(cmd, sizeof(cmd), true);
+}
+
+
+static void samples_mark(void * p_context)
+{
+    sim_qdec_stats_t qdec;
+
+    sim_qdec_stats_get(&qdec);
+    m_samples_mark = qdec.samples;
+}
+
+
+static void samples_count(void * p_context)
+{
+    sim_qdec_stats_t qdec;
+
+    sim_qdec_stats_get(&qdec);
+    *(uint32_t *)p_context = qdec.samples - m_samples_mark;
+}
+
+
+static void cmd_power(void * p_context)
+{
+    uint8_t cmd[3] = { BLE_SLS_CMD_SET_POWER };
+
+    (void)uint16_encode((uint16_t)(uintptr_t)p_context, &cmd[1]);
+    cmd_write(cmd, sizeof(cmd), true);
+}
+
+
+static void commands_setup(void)
+{
+    static uint16_t const uuids[] = { SLED_PWM_CHAR_UUID };
+
+    sim_pwm_handler_set(on_pwm);
+    link_up(SIM_S(1), uuids, ARRAY_SIZE(uuids));
+    at(SIM_S(1) + SIM_MS(500), value_write, NULL);
+    at(SIM_S(2), cmd_duty, NULL);
+    at(SIM_S(2) + SIM_MS(500), cmd_duty_burst, NULL);
+    at(SIM_S(2) + SIM_MS(700), cmd_duty_burst_check, NULL);
+    at(SIM_S(3), cmd_invalid, NULL);
+    at(SIM_S(4), cmd_mode, NULL);
+    at(SIM_S(5), cmd_profile, NULL);
+
+    // A slow pedal: the fastest range only while the constant power loop runs.
+    speed_at(SIM_S(6), 300);
+    at(SIM_S(7), cmd_power, (void *)1000);
+    at(SIM_S(8), samples_mark, NULL);
+    at(SIM_S(9), samples_count, &m_samples_pinned);
+    at(SIM_S(9), cmd_power, (void *)0);
+    at(SIM_S(10), samples_mark, NULL);
+    at(SIM_S(11), samples_count, &m_samples_auto);
+}
+
+
+static void commands_check(void)
+{
+    printf("QDEC samples per second: %u in constant power, %u auto-ranging\n", m_samples_pinned, m_samples_auto);
+
+    CHECK(m_profile_seen[0] && m_profile_seen[1], "SET_PROFILE points never seen");
+    CHECK(m_write_rsp_status == BLE_GATT_STATUS_SUCCESS, "SET_POWER status 0x%04x", m_write_rsp_status);
+    CHECK(m_samples_pinned + 1 >= QDEC_FAST_SAMPLES_S, "constant power left the fastest range");
+    CHECK(m_samples_auto < QDEC_FAST_SAMPLES_S / 2, "auto-ranging stayed in the fastest range");
+}
+
+
+/* Power: constant power mode against a rider whose speed drops with the brake duty. */
+
+static void flywheel_step(void * p_context)
+{
+    // The rider keeps the same effort, full duty halves the speed it can hold.
+    double duty  = (double)sim_pwm_value_get(0) / PWM_TOP_VALUE;
+    double speed = POWER_FREE_MM_S * (1 - duty / 2);
+
+    m_flywheel_mm_s += (speed - m_flywheel_mm_s) * POWER_STEP_MS / POWER_TAU_MS;
+    sim_encoder_speed_set(m_flywheel_mm_s * 1000 * CPR / ODOMETER_UM_PER_REV);
+
+    if (sim_time_ns() >= SIM_S(POWER_SETTLE_S))
+    {
+        double power = m_snap.power_q16 / 65536.0;
+
+        m_power_min = (m_power_max == 0) ? power : MIN(m_power_min, power);
+        m_power_max = MAX(m_power_max, power);
+    }
+    at(sim_time_ns() + SIM_MS(POWER_STEP_MS), flywheel_step, NULL);
+}
+
+
+static void power_setup(void)
+{
+    static uint16_t const uuids[] = { SLED_PWM_CHAR_UUID };
+
+    link_up(SIM_S(1), uuids, ARRAY_SIZE(uuids));
+    at(SIM_S(2), flywheel_step, NULL);
+    at(SIM_S(2), cmd_power, (void *)POWER_TARGET_DW);
+}
+
+
+static void power_check(void)
+{
+    double          target = POWER_TARGET_DW / 10.0;
+    sim_pwm_stats_t pwm;
+
+    sim_pwm_stats_get(&pwm);
+
+    printf("settled power %.2f to %.2f W for %.2f W, duty %u\n", m_power_min, m_power_max, target,
+           sim_pwm_value_get(0));
+    printf("%u PWM sequence starts, %u replaced before they played\n", pwm.seqstarts, pwm.seqstarts_lost);
+
+    CHECK(m_write_rsp_status == BLE_GATT_STATUS_SUCCESS, "SET_POWER status 0x%04x", m_write_rsp_status);
+    CHECK((m_power_min >= target * (1 - POWER_TOL)) && (m_power_max <= target * (1 + POWER_TOL)),
+          "power not held at the target");
+    CHECK(pwm.seqstarts_lost == 0, "PWM sequence starts replaced before they played");
+    CHECK(pwm.seqstarts <= (SIM_S(12) - SIM_S(2)) / SIM_MS(PWM_PERIOD_MS), "more than one swap per PWM period");
+}
+
+
+/* Kick: a sudden pull from a slow roll, faster than the slow range can follow. */
+
+static void kick_setup(void)
+{
+    link_up(SIM_MS(500), NULL, 0);
+    speed_at(SIM_S(1), 300);
+    speed_at(SIM_S(3), 3500);
+    speed_at(SIM_S(3) + SIM_MS(200), 0);
+    at(SIM_S(5), counters_read, NULL);
+}
+
+
+static void kick_check(void)
+{
+    qdec_acq_stats_t acq;
+
+    qdec_acq_stats_get(&acq);
+    printf("distance %lld mm, truth %lld mm, %u ACCDBL saturated reports\n",
+           (long long)m_snap.session_mm, (long long)truth_mm(), acq.accdbl_saturated);
+
+    // Only the report that saw the kick saturates, it loses at most two counts for each of the
+    // 40 samples beyond the 15 ACCDBL holds.
+    CHECK(acq.accdbl_saturated == 1, "%u saturated reports, the range did not switch", acq.accdbl_saturated);
+    CHECK(m_accdbl_saturated == acq.accdbl_saturated, "DGS Counters report %u saturated reports",
+          m_accdbl_saturated);
+    CHECK(truth_mm() - m_snap.session_mm <= (2 * (40 - 15) * ODOMETER_UM_PER_REV) / (CPR * 1000) + 1,
+          "distance lost beyond one saturated report");
+}
+
+
+/* Park: the sled rests for longer than one RTC wrap between two sprints. */
+
+static void park_setup(void)
+{
+    static uint16_t const uuids[] = { SLED_VALUE_CHAR_UUID };
+
+    link_up(SIM_MS(500), uuids, ARRAY_SIZE(uuids));
+    speed_ramp(SIM_S(1), 0, 2000);
+    speed_ramp(SIM_S(3), 2000, 0);
+    speed_ramp(SIM_S(1200), 0, 2000);
+    speed_ramp(SIM_S(1202), 2000, 0);
+}
+
+
+static void park_check(void)
+{
+    qdec_acq_stats_t acq;
+    sim_qdec_stats_t qdec;
+
+    qdec_acq_stats_get(&acq);
+    sim_qdec_stats_get(&qdec);
+
+    printf("distance %lld mm, truth %lld mm, %u sleeps, %u wakes\n",
+           (long long)m_snap.session_mm, (long long)truth_mm(), acq.sleeps, qdec.wakes);
+    printf("snapshot clock behind by %lld to %lld us\n", (long long)m_offset_min_us, (long long)m_offset_max_us);
+
+    // The edge that wakes sampling comes before the QDEC starts, so every wake misses one count.
+    CHECK(ABS(m_snap.session_mm - truth_mm()) <= qdec.wakes, "distance off by more than a count per wake");
+    CHECK(acq.sleeps == 2, "%u sleeps", acq.sleeps);
+    CHECK(qdec.wakes > 0, "never woken by the encoder");
+    CHECK(m_snap.time_us > 1200 * 1000000ULL, "snapshot clock lost the rest");
+    CHECK(m_offset_max_us - m_offset_min_us <= 2000, "snapshot clock drifted across the rest");
+}
+
+
+/* Link: a slow legacy central that cannot keep up with the stream. */
+
+static void link_setup(void)
+{
+    static uint16_t const uuids[] = { SLED_VALUE_CHAR_UUID, SLED_STREAM_CHAR_UUID };
+    sim_central_config_t const central =
+    {
+        .att_mtu           = BLE_GATT_ATT_MTU_DEFAULT,
+        .data_length       = BLE_GAP_DATA_LENGTH_DEFAULT,
+        .phy_2m            = false,
+        .conn_interval     = MSEC_TO_UNITS(50, UNIT_1_25_MS),
+        .conn_interval_min = MSEC_TO_UNITS(50, UNIT_1_25_MS),
+        .hvn_queue_size    = 1
+    };
+
+    sim_central_config_set(&central);
+    link_up(SIM_S(1), uuids, ARRAY_SIZE(uuids));
+    speed_ramp(SIM_S(2), 0, 10000);
+    speed_ramp(SIM_S(10), 10000, 0);
+    at(SIM_S(15) - SIM_MS(1), counters_read, NULL);
+}
+
+
+static void link_check(void)
+{
+    sim_link_stats_t link;
+
+    sim_link_stats_get(&link);
+    printf("distance %lld mm, truth %lld mm\n", (long long)m_snap.session_mm, (long long)truth_mm());
+    printf("%u notifications, %u refused with a full queue, %u samples coalesced\n",
+           link.notifications, link.hvx_resources, m_coalesced);
+
+    CHECK(m_coalesced > 0, "nothing coalesced");
+    CHECK(m_snap.session_mm == truth_mm(), "distance does not match the encoder");
+}
+
+
+static scenario_t const m_scenarios[] =
+{
+    { "sprint",   sprint_setup,   SIM_S(15),   sprint_check   },
+    { "commands", commands_setup, SIM_S(12),   commands_check },
+    { "park",     park_setup,     SIM_S(1210), park_check     },
+    { "link",     link_setup,     SIM_S(15),   link_check     },
+    { "power",    power_setup,    SIM_S(12),   power_check    },
+    { "kick",     kick_setup,     SIM_S(6),    kick_check     },
+};
+
+
+int main(int argc, char ** argv)
+{
+    scenario_t const * p_scenario = NULL;
+    sim_result_t       result;
+
+    for (uint32_t i = 0; (argc > 1) && (i < ARRAY_SIZE(m_scenarios)); i++)
+    {
+        if (strcmp(argv[1], m_scenarios[i].p_name) == 0)
+        {
+            p_scenario = &m_scenarios[i];
+        }
+    }
+    if (p_scenario == NULL)
+    {
+        printf("usage: test_sim <sprint|commands|park|link|power|kick> [-v]\n");
+        return EXIT_FAILURE;
+    }
+
+    sim_verbose_set((argc > 2) && (strcmp(argv[2], "-v") == 0));
+    p_scenario->setup();
+
+    result = sim_run(sled_app_main, p_scenario->end_ns);
+    CHECK(result == SIM_RESULT_END, "run ended with %d", result);
+    if (result == SIM_RESULT_END)
+    {
+        p_scenario->check();
+    }
+
+    printf("%s: %s\n", p_scenario->p_name, (m_failures == 0) ? "passed" : "FAILED");
+    return (m_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,83 @@
+/**@file
+ * @brief Host test of the fixed-point power kernel against the floating point formula it replaced.
+ *
+ * @details The reference is the original main loop computation in double precision,
+ *          P = 0.001735 * (v * 2pi / cpr)^2 with v in counts per second. Every acquisition range
+ *          is swept from rest to well past the top sprint speed in both directions, and the worst
+ *          absolute and relative errors are reported per range.
+ *
+ *          The kernel truncates the velocity to 1/256 count per report period, so with n counts per
+ *          period and power_k watts per (count per period)^2 it loses at most power_k * 2n / 256.
+ *          power_k is computed in single precision and rounded to 28 fractional bits, which adds
+ *          a relative error below 2e-6, and the two partial products each truncate by 2^-16 W
+ *          when the result is formed in Q16.16. The test enforces the sum of these terms.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "sdk_common.h"
+#include "sled_metrics.h"
+
+#define CPR             1024        /**< Encoder counts per revolution, as in main.c. */
+#define SPEED_MAX_CPS   40000       /**< Sweep limit, three times the 12 m/s sprint speed. */
+#define SPEED_STEP_CPS  0.25        /**< Sweep step. */
+
+static const uint32_t m_period_us[] = {128 * 10, 256 * 40, 512 * 40};
+
+/**@brief The floating point formula of the original main loop, in watts. */
+static double power_ref(double counts_per_s)
+{
+    double rad_per_s = counts_per_s * (1.0 / CPR) * 2 * M_PI;
+
+    return pow(rad_per_s, 2) * 0.001735;
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    for (size_t r = 0; r < sizeof(m_period_us) / sizeof(m_period_us[0]); r++)
+    {
+        sled_metrics_t metrics;
+        double         max_abs = 0;
+        double         max_rel = 0;
+        double         k_ref;
+
+        if (sled_metrics_init(&metrics, CPR, m_period_us[r]) != NRF_SUCCESS)
+        {
+            printf("range %zu: init failed\n", r);
+            return EXIT_FAILURE;
+        }
+
+        // Watts per (count per period)^2, the constant the kernel quantizes.
+        k_ref = power_ref(1e6 / m_period_us[r]);
+
+        for (double v = -SPEED_MAX_CPS; v <= SPEED_MAX_CPS; v += SPEED_STEP_CPS)
+        {
+            int32_t  vel_q16 = (int32_t)(v * 65536.0);
+            double   ref     = power_ref(vel_q16 / 65536.0);
+            double   got     = SLED_METRICS_Q16_TO_FLOAT(sled_metrics_power_vel_q16(&metrics, vel_q16));
+            double   n       = fabs(v) * m_period_us[r] / 1e6;
+            double   bound   = k_ref * 2 * n / 256 + ref * 2e-6 + 3.0 / 65536;
+            double   err     = fabs(got - ref);
+
+            if (err > bound)
+            {
+                if (failures++ < 10)
+                {
+                    printf("range %zu: %.2f counts/s gives %.6f W, expected %.6f W\n", r, v, got, ref);
+                }
+            }
+            max_abs = MAX(max_abs, err);
+            if (ref > 1.0)
+            {
+                max_rel = MAX(max_rel, err / ref);
+            }
+        }
+
+        printf("range %zu (%5u us): max error %.6f W, %.2e relative above 1 W\n",
+               r, (unsigned)m_period_us[r], max_abs, max_rel);
+    }
+
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,156 @@
+#include "sdk_common.h"
+#include "ble_dgs.h"
+#include "ble_sls.h"
+#include "nrf_log.h"
+#include <string.h>
+
+static uint16_t const m_char_uuids[BLE_DGS_CHAR_COUNT] =
+{
+    [BLE_DGS_CHAR_PROFILE]  = SLED_DIAG_PROFILE_CHAR_UUID,
+    [BLE_DGS_CHAR_COUNTERS] = SLED_DIAG_COUNTERS_CHAR_UUID
+};
+
+
+/**@brief Function for adding one read only diagnostics characteristic.
+ *
+ * @param[in]   p_dgs       Diagnostics Service structure.
+ * @param[in]   uuid_type   Vendor UUID type of the Sled Service base.
+ * @param[in]   characteristic  Characteristic to add.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+static ret_code_t diag_char_add(ble_dgs_t * p_dgs, uint8_t uuid_type, ble_dgs_char_t characteristic)
+{
+    ble_gatts_char_md_t char_md;
+    ble_gatts_attr_md_t attr_md;
+    ble_gatts_attr_t    attr_char_value;
+    ble_uuid_t          ble_uuid;
+
+    memset(&char_md, 0, sizeof(char_md));
+    char_md.char_props.read = 1;
+
+    memset(&attr_md, 0, sizeof(attr_md));
+    BLE_GAP_CONN_SEC_MODE_SET_OPEN(&attr_md.read_perm);
+    BLE_GAP_CONN_SEC_MODE_SET_NO_ACCESS(&attr_md.write_perm);
+    attr_md.vloc    = BLE_GATTS_VLOC_STACK;
+    attr_md.rd_auth = 1;    // The value is built when it is read, see on_read_authorize.
+    attr_md.wr_auth = 0;
+    attr_md.vlen    = 1;
+
+    ble_uuid.type = uuid_type;
+    ble_uuid.uuid = m_char_uuids[characteristic];
+
+    memset(&attr_char_value, 0, sizeof(attr_char_value));
+    attr_char_value.p_uuid    = &ble_uuid;
+    attr_char_value.p_attr_md = &attr_md;
+    attr_char_value.init_len  = 0;
+    attr_char_value.max_len   = BLE_DGS_VALUE_MAX_LEN;
+
+    return sd_ble_gatts_characteristic_add(p_dgs->service_handle, &char_md, &attr_char_value,
+                                           &p_dgs->char_handles[characteristic]);
+}
+
+
+ret_code_t ble_dgs_init(ble_dgs_t * p_dgs, ble_dgs_init_t const * p_dgs_init)
+{
+    ret_code_t    err_code;
+    ble_uuid_t    ble_uuid;
+    ble_uuid128_t base_uuid = {SLED_SERVICE_UUID_BASE};
+
+    VERIFY_PARAM_NOT_NULL(p_dgs);
+    VERIFY_PARAM_NOT_NULL(p_dgs_init);
+    VERIFY_PARAM_NOT_NULL(p_dgs_init->read_handler);
+
+    p_dgs->read_handler = p_dgs_init->read_handler;
+
+    // The base is already registered by the Sled Service, the stack returns the same UUID type.
+    err_code = sd_ble_uuid_vs_add(&base_uuid, &ble_uuid.type);
+    VERIFY_SUCCESS(err_code);
+
+    ble_uuid.uuid = SLED_DIAG_SERVICE_UUID;
+
+    err_code = sd_ble_gatts_service_add(BLE_GATTS_SRVC_TYPE_PRIMARY, &ble_uuid, &p_dgs->service_handle);
+    VERIFY_SUCCESS(err_code);
+
+    for (uint8_t i = 0; i < BLE_DGS_CHAR_COUNT; i++)
+    {
+        err_code = diag_char_add(p_dgs, ble_uuid.type, (ble_dgs_char_t)i);
+        VERIFY_SUCCESS(err_code);
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for handling a read of a diagnostics characteristic.
+ *
+ * @details A read at offset 0 takes a fresh snapshot into the attribute. Long reads continuing
+ *          at a higher offset are served from that snapshot, so the client sees one consistent
+ *          value across several ATT reads.
+ */
+static void on_read_authorize(ble_dgs_t * p_dgs, ble_evt_t const * p_ble_evt)
+{
+    ble_gatts_evt_rw_authorize_request_t const * p_auth_req =
+        &p_ble_evt->evt.gatts_evt.params.authorize_request;
+    ble_gatts_rw_authorize_reply_params_t        reply;
+    uint8_t                                      value[BLE_DGS_VALUE_MAX_LEN];
+    uint8_t                                      i;
+    ret_code_t                                   err_code;
+
+    if (p_auth_req->type != BLE_GATTS_AUTHORIZE_TYPE_READ)
+    {
+        return;
+    }
+
+    for (i = 0; i < BLE_DGS_CHAR_COUNT; i++)
+    {
+        if (p_auth_req->request.read.handle == p_dgs->char_handles[i].value_handle)
+        {
+            break;
+        }
+    }
+    if (i == BLE_DGS_CHAR_COUNT)
+    {
+        return;
+    }
+
+    memset(&reply, 0, sizeof(reply));
+    reply.type                    = BLE_GATTS_AUTHORIZE_TYPE_READ;
+    reply.params.read.gatt_status = BLE_GATT_STATUS_SUCCESS;
+
+    if (p_auth_req->request.read.offset == 0)
+    {
+        reply.params.read.update = 1;
+        reply.params.read.offset = 0;
+        reply.params.read.len    = p_dgs->read_handler((ble_dgs_char_t)i, value);
+        reply.params.read.p_data = value;
+    }
+
+    err_code = sd_ble_gatts_rw_authorize_reply(p_ble_evt->evt.gatts_evt.conn_handle, &reply);
+    if (err_code != NRF_SUCCESS)
+    {
+        // The link went away, there is nobody left to answer.
+        NRF_LOG_WARNING("Diagnostics read reply failed: %d", err_code);
+    }
+}
+
+
+void ble_dgs_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    ble_dgs_t * p_dgs = (ble_dgs_t *)p_context;
+
+    if ((p_dgs == NULL) || (p_ble_evt == NULL))
+    {
+        return;
+    }
+
+    switch (p_ble_evt->header.evt_id)
+    {
+        case BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST:
+            on_read_authorize(p_dgs, p_ble_evt);
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef BLE_DGS_H__
+#define BLE_DGS_H__
+
+#include <stdint.h>
+#include "ble.h"
+#include "ble_srv_common.h"
+#include "nrf_sdh_ble.h"
+#include "sdk_errors.h"
+
+#define BLE_DGS_DEF(_name)                                                        \
+static ble_dgs_t _name;                                                           \
+NRF_SDH_BLE_OBSERVER(_name ## _obs,                                               \
+                    BLE_HRS_BLE_OBSERVER_PRIO,                                    \
+                    ble_dgs_on_ble_evt, &_name)
+
+#define SLED_DIAG_SERVICE_UUID      0x1410  /**< Diagnostics Service, on the vendor base of the Sled Service. */
+#define SLED_DIAG_PROFILE_CHAR_UUID 0x1411
+#define SLED_DIAG_COUNTERS_CHAR_UUID 0x1412
+
+#define BLE_DGS_VALUE_MAX_LEN       128     /**< Longest value a diagnostics characteristic can hold. */
+
+/**@brief Length of the Counters value.
+ *
+ * @details Little endian, fits a single ATT read once the ATT MTU is 57 or more:
+ *          uint32 QDEC reports, uint32 ACCDBL sum, uint32 QDEC FIFO overflows, uint32 QDEC sleeps,
+ *          uint32 hvx queued, uint32 hvx sent, uint32 hvx deferred, uint32 samples coalesced,
+ *          uint32 samples dropped, uint32 command sequence gaps,
+ *          uint8 TX queue high-water mark, uint8 scheduler queue high-water mark,
+ *          uint16 ATT MTU, uint16 data length, uint8 TX PHY, uint8 RX PHY,
+ *          uint16 connection interval (1.25 ms units), uint16 slave latency,
+ *          uint32 QDEC reports with a saturated ACCDBL.
+ */
+#define BLE_DGS_COUNTERS_LEN        56
+
+/**@brief Diagnostics characteristics. */
+typedef enum
+{
+    BLE_DGS_CHAR_PROFILE,       /**< CPU profile, see sled_prof_encode. */
+    BLE_DGS_CHAR_COUNTERS,      /**< Pipeline and link counters, see @ref BLE_DGS_COUNTERS_LEN. */
+    BLE_DGS_CHAR_COUNT
+} ble_dgs_char_t;
+
+/**@brief Read handler type, fills the value of a characteristic when a client reads it.
+ *
+ * @details Called in SoftDevice context.
+ *
+ * @param[in]   characteristic  Characteristic being read.
+ * @param[out]  p_buf           Buffer of @ref BLE_DGS_VALUE_MAX_LEN bytes.
+ *
+ * @return      Length of the value.
+ */
+typedef uint16_t (*ble_dgs_read_handler_t) (ble_dgs_char_t characteristic, uint8_t * p_buf);
+
+/**@brief Diagnostics Service init structure. */
+typedef struct
+{
+    ble_dgs_read_handler_t read_handler;    /**< Provides the values, must not be NULL. */
+} ble_dgs_init_t;
+
+/**@brief Diagnostics Service structure.
+ *
+ * @details All values are read only and built on demand through read authorization, so the
+ *          service costs nothing until a client reads it.
+ */
+typedef struct
+{
+    uint16_t                 service_handle;
+    ble_gatts_char_handles_t char_handles[BLE_DGS_CHAR_COUNT];
+    ble_dgs_read_handler_t   read_handler;
+} ble_dgs_t;
+
+/**@brief Function for initializing the Diagnostics Service.
+ *
+ * @param[out]  p_dgs       Diagnostics Service structure.
+ * @param[in]   p_dgs_init  Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+ret_code_t ble_dgs_init(ble_dgs_t * p_dgs, ble_dgs_init_t const * p_dgs_init);
+
+/**@brief Function for handling the Application's BLE Stack events.
+ *
+ * @param[in]   p_ble_evt  Event received from the BLE stack.
+ * @param[in]   p_context  Diagnostics Service structure.
+ */
+void ble_dgs_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context);
+
+#endif /* BLE_DGS_H__ */
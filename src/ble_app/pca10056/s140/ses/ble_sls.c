@@ -4,6 +4,7 @@
 #include "nrf_gpio.h"
 #include "boards.h"
 #include "nrf_log.h"
+#include "app_util_platform.h"
 #include <string.h>
 
 uint32_t ble_sls_init(ble_sls_t * p_sls, const ble_sls_init_t * p_sls_init)
@@ -19,6 +20,21 @@ uint32_t ble_sls_init(ble_sls_t * p_sls, const ble_sls_init_t * p_sls_init)
   // Initialize the service structure
   p_sls->evt_handler = p_sls_init->evt_handler;
   p_sls->conn_handle = BLE_CONN_HANDLE_INVALID;
+  memset(&p_sls->sled_value_attr, 0, sizeof(p_sls->sled_value_attr));
+  memset(p_sls->sled_value_buf, 0, sizeof(p_sls->sled_value_buf));
+  p_sls->sled_value_front   = 0;
+  p_sls->sled_value_pending = false;
+  p_sls->stream_enabled     = false;
+  p_sls->stream_max_len     = BLE_GATT_ATT_MTU_DEFAULT - BLE_SLS_HVX_OVERHEAD;
+  p_sls->stream_max_latency = p_sls_init->stream_max_latency;
+  p_sls->stream_seq         = 0;
+  p_sls->stream_len         = 0;
+  p_sls->stream_pending     = false;
+  p_sls->cmd_status_enabled = false;
+  p_sls->cmd_seq_valid      = false;
+  p_sls->cmd_seq_next       = 0;
+  p_sls->cmd_seq_gaps       = 0;
+  memset(&p_sls->tx_stats, 0, sizeof(p_sls->tx_stats));
   
   // Add Sled Service UUID
   ble_uuid128_t base_uuid = {SLED_SERVICE_UUID_BASE};
@@ -35,11 +51,14 @@ uint32_t ble_sls_init(ble_sls_t * p_sls, const ble_sls_init_t * p_sls_init)
     return err_code;
   }
 
-  p_sls->char_pwm_value_write_handler = p_sls_init->char_pwm_value_write_handler;
+  p_sls->cmd_handler = p_sls_init->cmd_handler;
 
   // Add Sled Value characteristic
   err_code = sled_value_char_add(p_sls, p_sls_init);
+  VERIFY_SUCCESS(err_code);
   err_code = sled_pwm_char_add(p_sls, p_sls_init);
+  VERIFY_SUCCESS(err_code);
+  err_code = sled_stream_char_add(p_sls, p_sls_init);
 
   return err_code;
 }
@@ -64,7 +83,6 @@ static uint32_t sled_value_char_add(ble_sls_t * p_sls, const ble_sls_init_t * p_
     memset(&char_md, 0, sizeof(char_md));
 
     char_md.char_props.read   = 1;
-    char_md.char_props.write  = 1;
     char_md.p_char_user_desc  = NULL;
     char_md.p_char_pf         = NULL;
     char_md.p_user_desc_md    = NULL;
@@ -85,8 +103,8 @@ static uint32_t sled_value_char_add(ble_sls_t * p_sls, const ble_sls_init_t * p_
     memset(&attr_md, 0, sizeof(attr_md));
 
     attr_md.read_perm  = p_sls_init->sled_value_char_attr_md.read_perm;
-    attr_md.write_perm = p_sls_init->sled_value_char_attr_md.write_perm;
-    attr_md.vloc       = BLE_GATTS_VLOC_STACK;
+    BLE_GAP_CONN_SEC_MODE_SET_NO_ACCESS(&attr_md.write_perm);
+    attr_md.vloc       = BLE_GATTS_VLOC_USER;
     attr_md.rd_auth    = 0;
     attr_md.wr_auth    = 0;
     attr_md.vlen       = 0;
@@ -98,9 +116,10 @@ static uint32_t sled_value_char_add(ble_sls_t * p_sls, const ble_sls_init_t * p_
 
     attr_char_value.p_uuid    = &ble_uuid;
     attr_char_value.p_attr_md = &attr_md;
-    attr_char_value.init_len  = sizeof(uint8_t);
+    attr_char_value.init_len  = sizeof(ble_sls_sled_value_t);
     attr_char_value.init_offs = 0;
-    attr_char_value.max_len   = sizeof(uint64_t);  // Size of characteristic
+    attr_char_value.max_len   = sizeof(ble_sls_sled_value_t);  // Size of characteristic
+    attr_char_value.p_value   = (uint8_t *) &p_sls->sled_value_attr;
 
     err_code = sd_ble_gatts_characteristic_add(p_sls->service_handle, &char_md,
                                                &attr_char_value,
@@ -126,6 +145,7 @@ static uint32_t sled_pwm_char_add(ble_sls_t * p_sls, const ble_sls_init_t * p_sl
 
     char_md.char_props.read   = 1;
     char_md.char_props.write  = 1;
+    char_md.char_props.write_wo_resp = 1;   // Low latency control, see on_write.
     char_md.p_char_user_desc  = NULL;
     char_md.p_char_pf         = NULL;
     char_md.p_user_desc_md    = NULL;
@@ -149,8 +169,8 @@ static uint32_t sled_pwm_char_add(ble_sls_t * p_sls, const ble_sls_init_t * p_sl
     attr_md.write_perm = p_sls_init->sled_value_char_attr_md.write_perm;
     attr_md.vloc       = BLE_GATTS_VLOC_STACK;
     attr_md.rd_auth    = 0;
-    attr_md.wr_auth    = 0;
-    attr_md.vlen       = 0;
+    attr_md.wr_auth    = 1;     // Write Requests are validated in on_rw_authorize_request.
+    attr_md.vlen       = 1;
 
     ble_uuid.type = p_sls->uuid_type;
     ble_uuid.uuid = SLED_PWM_CHAR_UUID;
@@ -161,7 +181,7 @@ static uint32_t sled_pwm_char_add(ble_sls_t * p_sls, const ble_sls_init_t * p_sl
     attr_char_value.p_attr_md = &attr_md;
     attr_char_value.init_len  = sizeof(uint8_t);
     attr_char_value.init_offs = 0;
-    attr_char_value.max_len   = sizeof(uint32_t);  // Size of characteristic
+    attr_char_value.max_len   = BLE_SLS_CMD_MAX_LEN;
 
     err_code = sd_ble_gatts_characteristic_add(p_sls->service_handle, &char_md,
                                                &attr_char_value,
@@ -173,6 +193,57 @@ static uint32_t sled_pwm_char_add(ble_sls_t * p_sls, const ble_sls_init_t * p_sl
     return NRF_SUCCESS;
 }
 
+/**@brief Function for adding the Sled Stream characteristic.
+ *
+ * @details Notify only, variable length so each notification can carry as many records as the
+ *          ATT MTU allows.
+ *
+ * @param[in]   p_sls        Sled Service structure.
+ * @param[in]   p_sls_init   Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+static uint32_t sled_stream_char_add(ble_sls_t * p_sls, const ble_sls_init_t * p_sls_init)
+{
+    ble_gatts_char_md_t char_md;
+    ble_gatts_attr_md_t cccd_md;
+    ble_gatts_attr_t    attr_char_value;
+    ble_uuid_t          ble_uuid;
+    ble_gatts_attr_md_t attr_md;
+
+    memset(&char_md, 0, sizeof(char_md));
+    memset(&cccd_md, 0, sizeof(cccd_md));
+
+    BLE_GAP_CONN_SEC_MODE_SET_OPEN(&cccd_md.read_perm);
+    BLE_GAP_CONN_SEC_MODE_SET_OPEN(&cccd_md.write_perm);
+
+    cccd_md.vloc = BLE_GATTS_VLOC_STACK;
+    char_md.char_props.notify = 1;
+    char_md.p_cccd_md         = &cccd_md;
+
+    memset(&attr_md, 0, sizeof(attr_md));
+
+    attr_md.read_perm  = p_sls_init->sled_value_char_attr_md.read_perm;
+    BLE_GAP_CONN_SEC_MODE_SET_NO_ACCESS(&attr_md.write_perm);
+    attr_md.vloc       = BLE_GATTS_VLOC_STACK;
+    attr_md.vlen       = 1;
+
+    ble_uuid.type = p_sls->uuid_type;
+    ble_uuid.uuid = SLED_STREAM_CHAR_UUID;
+
+    memset(&attr_char_value, 0, sizeof(attr_char_value));
+
+    attr_char_value.p_uuid    = &ble_uuid;
+    attr_char_value.p_attr_md = &attr_md;
+    attr_char_value.init_len  = 0;
+    attr_char_value.init_offs = 0;
+    attr_char_value.max_len   = BLE_SLS_STREAM_MAX_LEN;
+
+    return sd_ble_gatts_characteristic_add(p_sls->service_handle, &char_md,
+                                           &attr_char_value,
+                                           &p_sls->sled_stream_handles);
+}
+
 
 void ble_sls_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
 {
@@ -197,6 +268,14 @@ void ble_sls_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
             on_write(p_sls, p_ble_evt);
             break;
 
+        case BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST:
+            on_rw_authorize_request(p_sls, p_ble_evt);
+            break;
+
+        case BLE_GATTS_EVT_HVN_TX_COMPLETE:
+            on_hvn_tx_complete(p_sls, p_ble_evt);
+            break;
+
         default:
             break;
     }
@@ -215,33 +294,268 @@ static void on_connect(ble_sls_t * p_sls, ble_evt_t const * p_ble_evt)
 static void on_disconnect(ble_sls_t * p_sls, ble_evt_t const * p_ble_evt)
 {
     UNUSED_PARAMETER(p_ble_evt);
-    p_sls->conn_handle = BLE_CONN_HANDLE_INVALID;
+    p_sls->conn_handle        = BLE_CONN_HANDLE_INVALID;
+    p_sls->stream_enabled     = false;
+    p_sls->stream_max_len     = BLE_GATT_ATT_MTU_DEFAULT - BLE_SLS_HVX_OVERHEAD;
+    p_sls->sled_value_pending = false;
+    p_sls->cmd_status_enabled = false;
+    p_sls->cmd_seq_valid      = false;
+
+    // Whatever was queued in the SoftDevice is gone with the link.
+    CRITICAL_REGION_ENTER();
+    p_sls->tx_stats.outstanding = 0;
+    CRITICAL_REGION_EXIT();
+}
+
+
+static void on_hvn_tx_complete(ble_sls_t * p_sls, ble_evt_t const * p_ble_evt)
+{
+    uint8_t count = p_ble_evt->evt.gatts_evt.params.hvn_tx_complete.count;
+
+    CRITICAL_REGION_ENTER();
+    p_sls->tx_stats.sent        += count;
+    p_sls->tx_stats.outstanding -= MIN(count, p_sls->tx_stats.outstanding);
+    CRITICAL_REGION_EXIT();
+
+    // There is room in the TX queue again, let the producer resend the held back Sled Value.
+    if (p_sls->sled_value_pending)
+    {
+        ble_sls_evt_t evt;
+        evt.evt_type = BLE_SLS_EVT_TX_READY;
+        p_sls->evt_handler(p_sls, &evt);
+    }
+}
+
+static uint16_t cmd_decode(uint8_t const * p_data, uint16_t len, ble_sls_cmd_t * p_cmd)
+{
+    uint8_t const * p_payload;
+    uint16_t        payload_len;
+    uint16_t        expected_len;
+
+    if (len < 1)
+    {
+        return BLE_GATT_STATUS_ATTERR_INVALID_ATT_VAL_LENGTH;
+    }
+
+    p_cmd->opcode  = (ble_sls_cmd_opcode_t)(p_data[0] & ~BLE_SLS_CMD_FLAG_SEQ);
+    p_cmd->has_seq = ((p_data[0] & BLE_SLS_CMD_FLAG_SEQ) != 0);
+    p_cmd->seq     = 0;
+
+    if (p_cmd->has_seq)
+    {
+        if (len < 2)
+        {
+            return BLE_GATT_STATUS_ATTERR_INVALID_ATT_VAL_LENGTH;
+        }
+        p_cmd->seq  = p_data[1];
+        p_payload   = &p_data[2];
+        payload_len = len - 2;
+    }
+    else
+    {
+        p_payload   = &p_data[1];
+        payload_len = len - 1;
+    }
+
+    switch (p_cmd->opcode)
+    {
+        case BLE_SLS_CMD_SET_MODE:
+            expected_len = 1;
+            break;
+
+        case BLE_SLS_CMD_SET_DUTY:
+            expected_len = 4;
+            break;
+
+        case BLE_SLS_CMD_SET_POWER:
+            expected_len = 2;
+            break;
+
+        case BLE_SLS_CMD_SET_PROFILE:
+            if ((payload_len < 1) || (p_payload[0] == 0) || (p_payload[0] > BLE_SLS_CMD_PROFILE_MAX_POINTS))
+            {
+                return BLE_GATT_STATUS_ATTERR_INVALID_ATT_VAL_LENGTH;
+            }
+            expected_len = 1 + p_payload[0] * BLE_SLS_CMD_POINT_LEN;
+            break;
+
+        default:
+            return BLE_SLS_ATTERR_UNKNOWN_OPCODE;
+    }
+
+    if (payload_len != expected_len)
+    {
+        return BLE_GATT_STATUS_ATTERR_INVALID_ATT_VAL_LENGTH;
+    }
+
+    switch (p_cmd->opcode)
+    {
+        case BLE_SLS_CMD_SET_MODE:
+            p_cmd->params.set_mode.mode = p_payload[0];
+            break;
+
+        case BLE_SLS_CMD_SET_DUTY:
+            p_cmd->params.set_duty.duty    = uint16_decode(&p_payload[0]);
+            p_cmd->params.set_duty.ramp_ms = uint16_decode(&p_payload[2]);
+            break;
+
+        case BLE_SLS_CMD_SET_POWER:
+            p_cmd->params.set_power.target_dw = uint16_decode(&p_payload[0]);
+            break;
+
+        case BLE_SLS_CMD_SET_PROFILE:
+            p_cmd->params.set_profile.count    = p_payload[0];
+            p_cmd->params.set_profile.p_points = &p_payload[1];
+            break;
+    }
+
+    return BLE_GATT_STATUS_SUCCESS;
+}
+
+static void cmd_status_update(ble_sls_t * p_sls, ble_sls_cmd_t const * p_cmd, uint16_t status)
+{
+    uint8_t  data[BLE_SLS_CMD_STATUS_LEN];
+    uint16_t len = BLE_SLS_CMD_STATUS_LEN;
+    uint32_t err_code;
+
+    data[0] = p_cmd->seq;
+    data[1] = (uint8_t)p_cmd->opcode;
+    (void)uint16_encode(status, &data[2]);
+
+    if (p_cmd->has_seq && p_sls->cmd_status_enabled)
+    {
+        ble_gatts_hvx_params_t hvx_params;
+
+        memset(&hvx_params, 0, sizeof(hvx_params));
+
+        // The notification also updates the attribute value.
+        hvx_params.handle = p_sls->sled_pwm_handles.value_handle;
+        hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+        hvx_params.offset = 0;
+        hvx_params.p_len  = &len;
+        hvx_params.p_data = data;
+
+        err_code = sd_ble_gatts_hvx(p_sls->conn_handle, &hvx_params);
+        err_code = hvx_result_process(p_sls, err_code, 1);
+    }
+    else
+    {
+        ble_gatts_value_t gatts_value;
+
+        memset(&gatts_value, 0, sizeof(gatts_value));
+
+        gatts_value.len     = len;
+        gatts_value.offset  = 0;
+        gatts_value.p_value = data;
+
+        err_code = sd_ble_gatts_value_set(p_sls->conn_handle, p_sls->sled_pwm_handles.value_handle,
+                                          &gatts_value);
+    }
+
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_WARNING("Sled PWM command status failed: %d", err_code);
+    }
+}
+
+// Shared by Write Requests, which arrive for authorization, and Write Commands, which arrive as
+// a plain write.
+static uint16_t cmd_process(ble_sls_t * p_sls, ble_gatts_evt_write_t const * p_evt_write, ble_sls_cmd_t * p_cmd)
+{
+    uint16_t status;
+
+    memset(p_cmd, 0, sizeof(*p_cmd));
+
+    status = cmd_decode(p_evt_write->data, p_evt_write->len, p_cmd);
+
+    if (p_cmd->has_seq)
+    {
+        // Commands without response can be dropped by the phone's stack, count what never arrived.
+        if (p_sls->cmd_seq_valid && (p_cmd->seq != p_sls->cmd_seq_next))
+        {
+            p_sls->cmd_seq_gaps += (uint8_t)(p_cmd->seq - p_sls->cmd_seq_next);
+        }
+        p_sls->cmd_seq_next  = p_cmd->seq + 1;
+        p_sls->cmd_seq_valid = true;
+    }
+
+    if ((status == BLE_GATT_STATUS_SUCCESS) && (p_sls->cmd_handler != NULL))
+    {
+        switch (p_sls->cmd_handler(p_cmd))
+        {
+            case NRF_SUCCESS:
+                break;
+
+            case NRF_ERROR_NO_MEM:
+                status = BLE_SLS_ATTERR_BUSY;
+                break;
+
+            default:
+                status = BLE_SLS_ATTERR_INVALID_PARAM;
+                break;
+        }
+    }
+
+    if (status != BLE_GATT_STATUS_SUCCESS)
+    {
+        NRF_LOG_INFO("Sled PWM command rejected: 0x%04x", status);
+    }
+
+    return status;
+}
+
+static void on_rw_authorize_request(ble_sls_t * p_sls, ble_evt_t const * p_ble_evt)
+{
+    ble_gatts_evt_rw_authorize_request_t const * p_auth_req =
+        &p_ble_evt->evt.gatts_evt.params.authorize_request;
+    ble_gatts_evt_write_t const *                p_evt_write = &p_auth_req->request.write;
+    ble_gatts_rw_authorize_reply_params_t        reply;
+    ble_sls_cmd_t                                cmd;
+    uint16_t                                     status;
+    uint32_t                                     err_code;
+
+    // Only Write Requests are authorized, Write Commands are handled in on_write.
+    if ((p_auth_req->type != BLE_GATTS_AUTHORIZE_TYPE_WRITE)
+        || (p_evt_write->handle != p_sls->sled_pwm_handles.value_handle)
+        || (p_evt_write->op != BLE_GATTS_OP_WRITE_REQ))
+    {
+        return;
+    }
+
+    status = cmd_process(p_sls, p_evt_write, &cmd);
+
+    // The command itself is not stored, the attribute holds the status of the last command.
+    memset(&reply, 0, sizeof(reply));
+
+    reply.type                     = BLE_GATTS_AUTHORIZE_TYPE_WRITE;
+    reply.params.write.gatt_status = status;
+    reply.params.write.update      = 0;
+
+    err_code = sd_ble_gatts_rw_authorize_reply(p_ble_evt->evt.gatts_evt.conn_handle, &reply);
+    if (err_code != NRF_SUCCESS)
+    {
+        // The link went away, there is nobody left to answer.
+        NRF_LOG_WARNING("Sled PWM command reply failed: %d", err_code);
+        return;
+    }
+
+    cmd_status_update(p_sls, &cmd, status);
 }
 
 static void on_write(ble_sls_t * p_sls, ble_evt_t const * p_ble_evt)
 {
-     NRF_LOG_INFO("on_write: called");
-     ble_gatts_evt_write_t const * p_evt_write = &p_ble_evt->evt.gatts_evt.params.write;
-
-     if (p_evt_write->handle == p_sls->sled_pwm_handles.value_handle)
-    {
-      int8_t len = p_evt_write->len;
-      NRF_LOG_INFO("Write Happened!");
-      //if (len != 4)
-      //{
-      //  NRF_LOG_INFO("ERROR: incomplete package");
-      //  NRF_LOG_INFO("len: %d", len);
-      //  return;
-      //}
-      // Data must be sent from in Little Endian Format and 4 bytes
-      // Convert the little endian 4 bytes of data into 32 bit unsigned int
-      uint32_t * char_pwm_value_adr;
-      uint32_t char_pwm_value_val;
-      char_pwm_value_adr = (uint32_t *) p_evt_write->data;
-      char_pwm_value_val = *p_evt_write->data;
-
-      NRF_LOG_INFO("PWM Value: %d", char_pwm_value_val);
-      p_sls->char_pwm_value_write_handler(char_pwm_value_val);
+    ble_gatts_evt_write_t const * p_evt_write = &p_ble_evt->evt.gatts_evt.params.write;
+
+    // The SoftDevice never asks to authorize a Write Command: it stored the raw command in the
+    // attribute, and the status written back replaces it.
+    if ((p_evt_write->handle == p_sls->sled_pwm_handles.value_handle)
+        && (p_evt_write->op == BLE_GATTS_OP_WRITE_CMD))
+    {
+        ble_sls_cmd_t cmd;
+        uint16_t      status = cmd_process(p_sls, p_evt_write, &cmd);
+
+        cmd_status_update(p_sls, &cmd, status);
+        return;
     }
 
     // Check if the handle passed with the event matches the Custom Value Characteristic handle.
@@ -267,58 +581,253 @@ static void on_write(ble_sls_t * p_sls, ble_evt_t const * p_ble_evt)
         }
     }
 
-    
-   
+    if ((p_evt_write->handle == p_sls->sled_pwm_handles.cccd_handle)
+        && (p_evt_write->len == 2))
+    {
+        p_sls->cmd_status_enabled = ble_srv_is_notification_enabled(p_evt_write->data);
+    }
+
+    if ((p_evt_write->handle == p_sls->sled_stream_handles.cccd_handle)
+        && (p_evt_write->len == 2))
+    {
+        ble_sls_evt_t evt;
+
+        p_sls->stream_enabled = ble_srv_is_notification_enabled(p_evt_write->data);
+
+        if (p_sls->evt_handler != NULL)
+        {
+            evt.evt_type = p_sls->stream_enabled ? BLE_SLS_EVT_STREAM_ENABLED
+                                                 : BLE_SLS_EVT_STREAM_DISABLED;
+            p_sls->evt_handler(p_sls, &evt);
+        }
+    }
+}
+
+
+
+/**@brief Function for accounting the result of a notification.
+ *
+ * @param[in]   p_sls          Sled Service structure.
+ * @param[in]   err_code       Return value of sd_ble_gatts_hvx.
+ * @param[in]   samples        Number of samples carried by the notification.
+ *
+ * @return      NRF_SUCCESS if flow control absorbs the result (sent, TX queue full, link or
+ *              subscription going away), otherwise err_code.
+ */
+static uint32_t hvx_result_process(ble_sls_t * p_sls, uint32_t err_code, uint16_t samples)
+{
+    ble_sls_tx_stats_t * p_stats = &p_sls->tx_stats;
+    uint32_t             ret     = NRF_SUCCESS;
+
+    // The counters are shared between the main loop (Sled Value, stream) and the SoftDevice context (command status, TX complete).
+    CRITICAL_REGION_ENTER();
+    switch (err_code)
+    {
+        case NRF_SUCCESS:
+            p_stats->queued++;
+            p_stats->outstanding++;
+            if (p_stats->outstanding > p_stats->outstanding_max)
+            {
+                p_stats->outstanding_max = p_stats->outstanding;
+            }
+            break;
+
+        case NRF_ERROR_RESOURCES:
+            p_stats->deferred++;
+            break;
+
+        case NRF_ERROR_INVALID_STATE:
+        case BLE_ERROR_INVALID_CONN_HANDLE:
+        case BLE_ERROR_GATTS_SYS_ATTR_MISSING:
+            p_stats->dropped += samples;
+            break;
+
+        default:
+            p_stats->dropped += samples;
+            ret = err_code;
+            break;
+    }
+    CRITICAL_REGION_EXIT();
+
+    return ret;
+}
+
+
+ble_sls_sled_value_t * ble_sls_sled_value_back_get(ble_sls_t * p_sls)
+{
+    return &p_sls->sled_value_buf[p_sls->sled_value_front ^ 1];
 }
 
 
+void ble_sls_sled_value_publish(ble_sls_t * p_sls)
+{
+    // A single byte store, the notification path sees either the old or the new buffer.
+    p_sls->sled_value_front ^= 1;
+}
 
-uint32_t ble_sls_sled_value_update(ble_sls_t * p_sls, uint64_t sled_value)
+
+uint32_t ble_sls_sled_value_notify(ble_sls_t * p_sls)
 {
     if (p_sls == NULL)
     {
         return NRF_ERROR_NULL;
     }
+    if (p_sls->conn_handle == BLE_CONN_HANDLE_INVALID)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (p_sls->sled_value_pending)
+    {
+        // Behind: the held back notification will carry this newer value.
+        CRITICAL_REGION_ENTER();
+        p_sls->tx_stats.coalesced++;
+        CRITICAL_REGION_EXIT();
+        return NRF_SUCCESS;
+    }
 
-    uint32_t err_code = NRF_SUCCESS;
-    ble_gatts_value_t gatts_value;
+    uint32_t               err_code;
+    uint16_t               len = sizeof(ble_sls_sled_value_t);
+    ble_gatts_hvx_params_t hvx_params =
+    {
+        .handle = p_sls->sled_value_handles.value_handle,
+        .type   = BLE_GATT_HVX_NOTIFICATION,
+        .offset = 0,
+        .p_len  = &len,
+        .p_data = (uint8_t const *) &p_sls->sled_value_buf[p_sls->sled_value_front]
+    };
+
+    err_code = sd_ble_gatts_hvx(p_sls->conn_handle, &hvx_params);
+    if (err_code == NRF_ERROR_RESOURCES)
+    {
+        p_sls->sled_value_pending = true;
+    }
 
-    // Initialize value struct.
-    memset(&gatts_value, 0, sizeof(gatts_value));
+    return hvx_result_process(p_sls, err_code, 1);
+}
 
-    gatts_value.len     = sizeof(uint64_t);
-    gatts_value.offset  = 0;
-    gatts_value.p_value = (uint8_t*) &sled_value;
 
-    // Update database.
-    err_code = sd_ble_gatts_value_set(p_sls->conn_handle,
-                                      p_sls->sled_value_handles.value_handle,
-                                      &gatts_value);
-   
-    if (err_code != NRF_SUCCESS)
+uint32_t ble_sls_sled_value_resend(ble_sls_t * p_sls)
+{
+    if (p_sls == NULL)
     {
-        return err_code;
+        return NRF_ERROR_NULL;
+    }
+    if (!p_sls->sled_value_pending)
+    {
+        return NRF_SUCCESS;
     }
 
-    // Send value if connected and notifying.
-    if ((p_sls->conn_handle != BLE_CONN_HANDLE_INVALID))
+    p_sls->sled_value_pending = false;
+    return ble_sls_sled_value_notify(p_sls);
+}
+
+
+void ble_sls_att_mtu_set(ble_sls_t * p_sls, uint16_t att_mtu)
+{
+    p_sls->stream_max_len = MIN(att_mtu - BLE_SLS_HVX_OVERHEAD, BLE_SLS_STREAM_MAX_LEN);
+}
+
+
+uint32_t ble_sls_stream_flush(ble_sls_t * p_sls)
+{
+    if (p_sls == NULL)
     {
-        ble_gatts_hvx_params_t hvx_params;
+        return NRF_ERROR_NULL;
+    }
+    if (p_sls->stream_len == 0)
+    {
+        return NRF_SUCCESS;
+    }
 
-        memset(&hvx_params, 0, sizeof(hvx_params));
+    uint32_t               err_code;
+    uint16_t               len     = p_sls->stream_len;
+    uint8_t                records = (len - BLE_SLS_STREAM_HDR_LEN) / BLE_SLS_STREAM_REC_LEN;
+    ble_gatts_hvx_params_t hvx_params;
 
-        hvx_params.handle = p_sls->sled_value_handles.value_handle;
-        hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
-        hvx_params.offset = gatts_value.offset;
-        hvx_params.p_len  = &gatts_value.len;
-        hvx_params.p_data = gatts_value.p_value;
+    // Fill in the header, the records are already in place.
+    (void)uint16_encode(p_sls->stream_seq, &p_sls->stream_buf[0]);
+    p_sls->stream_buf[2] = records;
 
-        err_code = sd_ble_gatts_hvx(p_sls->conn_handle, &hvx_params);
+    memset(&hvx_params, 0, sizeof(hvx_params));
+
+    hvx_params.handle = p_sls->sled_stream_handles.value_handle;
+    hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+    hvx_params.offset = 0;
+    hvx_params.p_len  = &len;
+    hvx_params.p_data = p_sls->stream_buf;
+
+    err_code = sd_ble_gatts_hvx(p_sls->conn_handle, &hvx_params);
+
+    // TX queue full: keep the packet and its sequence number for the next attempt.
+    p_sls->stream_pending = (err_code == NRF_ERROR_RESOURCES);
+    if (!p_sls->stream_pending)
+    {
+        // Sent or lost, a lost packet leaves a gap in the sequence numbers.
+        p_sls->stream_seq++;
+        p_sls->stream_len = 0;
     }
-    else
+
+    return hvx_result_process(p_sls, err_code, records);
+}
+
+
+uint32_t ble_sls_stream_rec_add(ble_sls_t * p_sls, ble_sls_stream_rec_t const * p_rec)
+{
+    if (p_sls == NULL || p_rec == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (!p_sls->stream_enabled || p_sls->conn_handle == BLE_CONN_HANDLE_INVALID)
+    {
+        // The buffer is only touched from the caller's context, discard what was left over here.
+        p_sls->stream_len     = 0;
+        p_sls->stream_pending = false;
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    uint32_t  err_code = NRF_SUCCESS;
+    uint8_t * p_rec_buf;
+    uint16_t  first_ts;
+
+    if (p_sls->stream_pending)
     {
-        err_code = NRF_ERROR_INVALID_STATE;
+        err_code = ble_sls_stream_flush(p_sls);
+        VERIFY_SUCCESS(err_code);
+    }
+
+    if (p_sls->stream_len == 0)
+    {
+        p_sls->stream_len = BLE_SLS_STREAM_HDR_LEN;
+    }
+    else if (p_sls->stream_len + BLE_SLS_STREAM_REC_LEN > p_sls->stream_max_len)
+    {
+        // Still waiting for the TX queue with a full packet, the newest record is replaced.
+        p_sls->stream_len -= BLE_SLS_STREAM_REC_LEN;
+        CRITICAL_REGION_ENTER();
+        p_sls->tx_stats.coalesced++;
+        CRITICAL_REGION_EXIT();
+    }
+
+    p_rec_buf = &p_sls->stream_buf[p_sls->stream_len];
+    (void)uint16_encode(p_rec->timestamp, &p_rec_buf[0]);
+    memcpy(&p_rec_buf[2], &p_rec->power, sizeof(float));
+    memcpy(&p_rec_buf[6], &p_rec->distance, sizeof(float));
+    p_sls->stream_len += BLE_SLS_STREAM_REC_LEN;
+
+    first_ts = uint16_decode(&p_sls->stream_buf[BLE_SLS_STREAM_HDR_LEN]);
+
+    if (!p_sls->stream_pending
+        && ((p_sls->stream_len + BLE_SLS_STREAM_REC_LEN > p_sls->stream_max_len)
+            || ((uint16_t)(p_rec->timestamp - first_ts) >= p_sls->stream_max_latency)))
+    {
+        err_code = ble_sls_stream_flush(p_sls);
     }
 
     return err_code;
 }
+
+
+ble_sls_tx_stats_t const * ble_sls_tx_stats_get(ble_sls_t const * p_sls)
+{
+    return &p_sls->tx_stats;
+}
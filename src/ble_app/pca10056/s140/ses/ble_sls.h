@@ -5,6 +5,8 @@
 #include <stdbool.h>
 #include "ble.h"
 #include "ble_srv_common.h"
+#include "nrf_sdh_ble.h"
+#include "sdk_errors.h"
 
 #define BLE_SLS_DEF(_name)                                                        \
 static ble_sls_t _name;                                                           \
@@ -18,15 +20,93 @@ NRF_SDH_BLE_OBSERVER(_name ## _obs,
 #define SLED_SERVICE_UUID       0x1400
 #define SLED_VALUE_CHAR_UUID    0x1401
 #define SLED_PWM_CHAR_UUID      0x1402
+#define SLED_STREAM_CHAR_UUID   0x1403
 
-typedef void (*ble_os_char_pwm_value_write_handler_t) (uint32_t pwm_value);
+#define BLE_SLS_HVX_OVERHEAD        3       /**< ATT opcode and attribute handle in every notification. */
+#define BLE_SLS_STREAM_MAX_LEN      (NRF_SDH_BLE_GATT_MAX_MTU_SIZE - BLE_SLS_HVX_OVERHEAD)  /**< Largest Sled Stream notification the stack is configured for. */
+#define BLE_SLS_STREAM_HDR_LEN      3       /**< Sled Stream header: uint16 sequence number, uint8 record count. */
+#define BLE_SLS_STREAM_REC_LEN      10      /**< Sled Stream record: uint16 timestamp, float power, float distance. */
+#define BLE_SLS_STREAM_TICK_HZ      1024    /**< Resolution of the Sled Stream record timestamp. */
+
+#define BLE_SLS_CMD_POINT_LEN           6       /**< Profile point on air: uint16 left, uint16 right, uint16 steps. */
+#define BLE_SLS_CMD_PROFILE_MAX_POINTS  16      /**< Most points one SET_PROFILE command can carry. */
+#define BLE_SLS_CMD_MAX_LEN             (2 + BLE_SLS_CMD_PROFILE_MAX_POINTS * BLE_SLS_CMD_POINT_LEN)  /**< Longest command written to the Sled PWM characteristic. */
+
+#define BLE_SLS_CMD_FLAG_SEQ            0x80    /**< Opcode flag: a uint8 sequence number follows the opcode. */
+#define BLE_SLS_CMD_STATUS_LEN          4       /**< Command status: uint8 sequence number, uint8 opcode, uint16 ATT status. */
+
+#define BLE_SLS_ATTERR_UNKNOWN_OPCODE   (BLE_GATT_STATUS_ATTERR_APP_BEGIN + 0)  /**< ATT error for an unknown command opcode. */
+#define BLE_SLS_ATTERR_INVALID_PARAM    (BLE_GATT_STATUS_ATTERR_APP_BEGIN + 1)  /**< ATT error for a parameter the application rejected. */
+#define BLE_SLS_ATTERR_BUSY             (BLE_GATT_STATUS_ATTERR_APP_BEGIN + 2)  /**< ATT error for a command the application had no room to queue. */
+
+/**@brief Opcodes of the Sled PWM command protocol.
+ *
+ * @details Every write is one command: an opcode byte followed by a fixed, little-endian payload.
+ *          Commands can be written with or without response. A rejected Write Request, such as one
+ *          of the wrong length, is answered with an ATT error; a Write Command has no response, its
+ *          status only shows as described next. With @ref BLE_SLS_CMD_FLAG_SEQ set in the opcode a
+ *          sequence number follows it, and if the client enabled notifications on the
+ *          characteristic the command is answered with a @ref BLE_SLS_CMD_STATUS_LEN byte status
+ *          notification.
+ *          Reading the characteristic returns the status of the last command.
+ */
+typedef enum
+{
+    BLE_SLS_CMD_SET_MODE    = 0x01,     /**< uint8 pwm_setting_t. */
+    BLE_SLS_CMD_SET_DUTY    = 0x02,     /**< uint16 duty in PWM ticks, uint16 ramp time in ms. */
+    BLE_SLS_CMD_SET_POWER   = 0x03,     /**< uint16 target power in 0.1 W, 0 leaves constant power mode. */
+    BLE_SLS_CMD_SET_PROFILE = 0x04,     /**< uint8 point count, then count points of BLE_SLS_CMD_POINT_LEN bytes. */
+} ble_sls_cmd_opcode_t;
+
+/**@brief Decoded Sled PWM command.
+ *
+ * @details Decoded in place; p_points refers to the write event data and is only valid during
+ *          the command handler call.
+ */
+typedef struct
+{
+    ble_sls_cmd_opcode_t opcode;
+    bool                 has_seq;       /**< The command carried a sequence number. */
+    uint8_t              seq;           /**< Sequence number, 0 if has_seq is false. */
+    union
+    {
+        struct
+        {
+            uint8_t  mode;
+        } set_mode;
+        struct
+        {
+            uint16_t duty;
+            uint16_t ramp_ms;
+        } set_duty;
+        struct
+        {
+            uint16_t target_dw;
+        } set_power;
+        struct
+        {
+            uint8_t         count;
+            uint8_t const * p_points;
+        } set_profile;
+    } params;
+} ble_sls_cmd_t;
+
+/**@brief Sled PWM command handler type.
+ *
+ * @return  NRF_SUCCESS to accept the command, NRF_ERROR_NO_MEM to reject it with
+ *          @ref BLE_SLS_ATTERR_BUSY, otherwise it is rejected with @ref BLE_SLS_ATTERR_INVALID_PARAM.
+ */
+typedef ret_code_t (*ble_sls_cmd_handler_t) (ble_sls_cmd_t const * p_cmd);
 
 typedef enum
 {
     BLE_SLS_EVT_NOTIFICATION_ENABLED,
     BLE_SLS_EVT_NOTIFICATION_DISABLED,
+    BLE_SLS_EVT_STREAM_ENABLED,
+    BLE_SLS_EVT_STREAM_DISABLED,
     BLE_SLS_EVT_DISCONNECTED,
-    BLE_SLS_EVT_CONNECTED
+    BLE_SLS_EVT_CONNECTED,
+    BLE_SLS_EVT_TX_READY            /**< The TX queue has room for a held back Sled Value, see @ref ble_sls_sled_value_resend. */
 } ble_sls_evt_type_t;
 
 // Forward declaration of the ble_sls_t type
@@ -38,6 +118,33 @@ typedef struct
     ble_sls_evt_type_t evt_type;
 } ble_sls_evt_t;
 
+/**@brief Sled Value as sent on air (the former packed uint64: distance in the low word). */
+typedef struct
+{
+    float distance;         /**< Session distance in meters. */
+    float power;            /**< Power in watts. */
+} ble_sls_sled_value_t;
+
+/**@brief One record of the Sled Stream characteristic. */
+typedef struct
+{
+    uint16_t timestamp;     /**< Acquisition time in 1/BLE_SLS_STREAM_TICK_HZ s, wraps around. */
+    float    power;         /**< Power in watts. */
+    float    distance;      /**< Session distance in meters. */
+} ble_sls_stream_rec_t;
+
+/**@brief Notification flow control counters. */
+typedef struct
+{
+    uint32_t queued;            /**< Notifications accepted by the SoftDevice. */
+    uint32_t sent;              /**< Notifications reported transmitted (BLE_GATTS_EVT_HVN_TX_COMPLETE). */
+    uint32_t deferred;          /**< Notifications postponed because the TX queue was full. */
+    uint32_t coalesced;         /**< Samples replaced by a newer one while waiting for the TX queue. */
+    uint32_t dropped;           /**< Samples discarded because the link or subscription went away. */
+    uint8_t  outstanding;       /**< Notifications queued in the SoftDevice and not yet transmitted. */
+    uint8_t  outstanding_max;   /**< High-water mark of outstanding. */
+} ble_sls_tx_stats_t;
+
 /**@brief Sled Service event handler type. */
 typedef void (*ble_sls_evt_handler_t) (ble_sls_t * p_sls, ble_sls_evt_t * p_evt);
 
@@ -48,7 +155,8 @@ typedef struct
   ble_sls_evt_handler_t         evt_handler;                  /**< Event handler to be called for handling events in Sled Service */
   uint8_t                       initial_sled_value;           /**< Initial sled value */
   ble_srv_cccd_security_mode_t  sled_value_char_attr_md;      /**< Initial security level for Sled characteristics attribute */
-  ble_os_char_pwm_value_write_handler_t char_pwm_value_write_handler;
+  ble_sls_cmd_handler_t         cmd_handler;                  /**< Called with every valid Sled PWM command */
+  uint16_t                      stream_max_latency;           /**< Longest time a record may wait in the Sled Stream buffer, in 1/BLE_SLS_STREAM_TICK_HZ s */
 } ble_sls_init_t;
 
 /**@brief Sled Service structure. This contains various status information for the service. */
@@ -58,9 +166,26 @@ struct ble_sls_s
   uint16_t                  service_handle;         /**< Handle of Sled Service (as provided by the BLE stack) */
   ble_gatts_char_handles_t  sled_value_handles;     /**< Handles related to the Sled Value characteristic */
   ble_gatts_char_handles_t  sled_pwm_handles;       /**< Handles related to the Sled PWM characteristic */
+  ble_gatts_char_handles_t  sled_stream_handles;    /**< Handles related to the Sled Stream characteristic */
   uint16_t                  conn_handle;            /**< Handle of the current connection (as provided by the BLE stack, is BLE_CONN_HANDLE_INVALID if not in a connection) */
   uint8_t                   uuid_type;
-  ble_os_char_pwm_value_write_handler_t char_pwm_value_write_handler;
+  ble_sls_cmd_handler_t     cmd_handler;            /**< See @ref ble_sls_init_t */
+  bool                      cmd_status_enabled;     /**< True if the client enabled command status notifications */
+  bool                      cmd_seq_valid;          /**< cmd_seq_next holds a sequence number */
+  uint8_t                   cmd_seq_next;           /**< Sequence number expected with the next command */
+  uint32_t                  cmd_seq_gaps;           /**< Sequenced commands that never arrived */
+  ble_sls_sled_value_t      sled_value_attr;        /**< User located (BLE_GATTS_VLOC_USER) Sled Value attribute */
+  ble_sls_sled_value_t      sled_value_buf[2];      /**< Double buffer: the producer fills one while the other is notified */
+  volatile uint8_t          sled_value_front;       /**< Index of the published Sled Value buffer */
+  volatile bool             sled_value_pending;     /**< Sled Value waits for the TX queue, see @ref BLE_SLS_EVT_TX_READY */
+  bool                      stream_enabled;         /**< True if the client enabled Sled Stream notifications */
+  uint16_t                  stream_max_len;         /**< Sled Stream notification size allowed by the current ATT MTU */
+  uint16_t                  stream_max_latency;     /**< See @ref ble_sls_init_t */
+  uint16_t                  stream_seq;             /**< Sequence number of the next Sled Stream notification */
+  uint16_t                  stream_len;             /**< Bytes used in stream_buf */
+  bool                      stream_pending;         /**< stream_buf holds a packet the TX queue had no room for */
+  ble_sls_tx_stats_t        tx_stats;               /**< Notification flow control counters */
+  uint8_t                   stream_buf[BLE_SLS_STREAM_MAX_LEN];
 };
 
 /**@brief Function for initializing the Sled Service.
@@ -92,6 +217,15 @@ static uint32_t sled_value_char_add(ble_sls_t * p_sls, const ble_sls_init_t * p_
  */
 static uint32_t sled_pwm_char_add(ble_sls_t * p_sls, const ble_sls_init_t * p_sls_init);
 
+/**@brief Function for adding the Sled Stream characteristic.
+ *
+ * @param[in]   p_sls        Sled Service structure.
+ * @param[in]   p_sls_init   Information needed to initialize the service.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+static uint32_t sled_stream_char_add(ble_sls_t * p_sls, const ble_sls_init_t * p_sls_init);
+
 /**@brief Function for handling the Application's BLE Stack events.
  *
  * @details Handles all events from the BLE stack of interest to the Battery Service.
@@ -118,25 +252,150 @@ static void on_connect(ble_sls_t * p_sls, ble_evt_t const * p_ble_evt);
 static void on_disconnect(ble_sls_t * p_sls, ble_evt_t const * p_ble_evt);
 
 /**@brief Function for handling the Write event.
+ *
+ * @details Also carries Sled PWM commands written without response: the SoftDevice authorizes
+ *          Write Requests only, a Write Command is stored as is and reported here.
  *
  * @param[in]   p_sls       Sled Service structure.
  * @param[in]   p_ble_evt   Event received from the BLE stack.
  */
 static void on_write(ble_sls_t * p_sls, ble_evt_t const * p_ble_evt);
 
-/**@brief Function for updating the sled value.
+/**@brief Function for handling the Read/Write Authorize Request event.
  *
- * @details The application calls this function when the cutom value should be updated. If
- *          notification has been enabled, the sled value characteristic is sent to the client.
+ * @details Write Requests to the Sled PWM characteristic are authorized so that a command can be
+ *          validated and rejected with an ATT error before it is stored.
+ *
+ * @param[in]   p_sls       Sled Service structure.
+ * @param[in]   p_ble_evt   Event received from the BLE stack.
+ */
+static void on_rw_authorize_request(ble_sls_t * p_sls, ble_evt_t const * p_ble_evt);
+
+/**@brief Function for decoding a Sled PWM command.
+ *
+ * @param[in]   p_data      Write data.
+ * @param[in]   len         Write length.
+ * @param[out]  p_cmd       Decoded command.
+ *
+ * @return      BLE_GATT_STATUS_SUCCESS, or the ATT error to reply with.
+ */
+static uint16_t cmd_decode(uint8_t const * p_data, uint16_t len, ble_sls_cmd_t * p_cmd);
+
+/**@brief Function for decoding, sequence checking and handing on one Sled PWM command.
+ *
+ * @param[in]   p_sls       Sled Service structure.
+ * @param[in]   p_evt_write Write carrying the command.
+ * @param[out]  p_cmd       Decoded command, possibly only partly.
+ *
+ * @return      BLE_GATT_STATUS_SUCCESS, or the ATT error the command is rejected with.
+ */
+static uint16_t cmd_process(ble_sls_t * p_sls, ble_gatts_evt_write_t const * p_evt_write, ble_sls_cmd_t * p_cmd);
+
+/**@brief Function for sending or storing the status of a Sled PWM command.
+ *
+ * @param[in]   p_sls       Sled Service structure.
+ * @param[in]   p_cmd       Command, possibly only partly decoded.
+ * @param[in]   status      ATT status the command was answered with.
+ */
+static void cmd_status_update(ble_sls_t * p_sls, ble_sls_cmd_t const * p_cmd, uint16_t status);
+
+/**@brief Function for accounting the result of a notification.
  *
- * @note 
- *       
  * @param[in]   p_sls          Sled Service structure.
- * @param[in]   Sled value 
+ * @param[in]   err_code       Return value of sd_ble_gatts_hvx.
+ * @param[in]   samples        Number of samples carried by the notification.
  *
- * @return      NRF_SUCCESS on success, otherwise an error code.
+ * @return      NRF_SUCCESS if flow control absorbs the result, otherwise err_code.
+ */
+static uint32_t hvx_result_process(ble_sls_t * p_sls, uint32_t err_code, uint16_t samples);
+
+/**@brief Function for handling the HVN TX complete event.
+ *
+ * @param[in]   p_sls       Sled Service structure.
+ * @param[in]   p_ble_evt   Event received from the BLE stack.
+ */
+static void on_hvn_tx_complete(ble_sls_t * p_sls, ble_evt_t const * p_ble_evt);
+
+/**@brief Function for getting the Sled Value buffer the producer may write.
+ *
+ * @details The returned buffer is not visible to the notification path until
+ *          @ref ble_sls_sled_value_publish is called, so it can be filled in place field by field.
+ *          Only one context may produce Sled Values.
+ *
+ * @param[in]   p_sls          Sled Service structure.
+ *
+ * @return      Back buffer of the Sled Value.
+ */
+ble_sls_sled_value_t * ble_sls_sled_value_back_get(ble_sls_t * p_sls);
+
+/**@brief Function for publishing the back buffer filled by the producer. */
+void ble_sls_sled_value_publish(ble_sls_t * p_sls);
+
+/**@brief Function for notifying the published sled value.
+ *
+ * @details Only the hvx call is made; the SoftDevice updates the user located attribute from the
+ *          published buffer, so no separate sd_ble_gatts_value_set is needed.
+ *          If the TX queue is full the notification is held back and @ref BLE_SLS_EVT_TX_READY is
+ *          raised once there is room; further calls until it is resent are coalesced.
+ *          Must be called from one context only, together with @ref ble_sls_sled_value_resend.
+ *
+ * @param[in]   p_sls          Sled Service structure.
+ *
+ * @return      NRF_SUCCESS if the value was sent, deferred, coalesced or dropped because the link
+ *              is going away, otherwise an error code.
+ */
+uint32_t ble_sls_sled_value_notify(ble_sls_t * p_sls);
+
+/**@brief Function for resending a held back Sled Value with the latest published value.
+ *
+ * @details Meant to be called on @ref BLE_SLS_EVT_TX_READY. Does nothing if no value is held back.
+ *
+ * @param[in]   p_sls          Sled Service structure.
+ *
+ * @return      See @ref ble_sls_sled_value_notify.
+ */
+uint32_t ble_sls_sled_value_resend(ble_sls_t * p_sls);
+
+/**@brief Function for setting the ATT MTU used to size Sled Stream notifications.
+ *
+ * @param[in]   p_sls          Sled Service structure.
+ * @param[in]   att_mtu        Effective ATT MTU of the connection.
+ */
+void ble_sls_att_mtu_set(ble_sls_t * p_sls, uint16_t att_mtu);
+
+/**@brief Function for adding a record to the Sled Stream.
+ *
+ * @details Records are packed into the stream buffer. The buffer is sent as one notification
+ *          when the next record would no longer fit in the ATT MTU, or when the oldest record
+ *          is older than the configured latency. Every notification carries a sequence number
+ *          that is incremented whenever a packet is lost, so the client can detect drops.
+ *          If the TX queue is full the packet is kept and retried on the next call; records that
+ *          arrive while it waits are appended, and once it is full the newest record is replaced.
+ *          Must always be called from the same context.
+ *
+ * @param[in]   p_sls          Sled Service structure.
+ * @param[in]   p_rec          Record to add.
+ *
+ * @return      NRF_SUCCESS on success, NRF_ERROR_INVALID_STATE if streaming is not enabled,
+ *              otherwise an error code.
+ */
+uint32_t ble_sls_stream_rec_add(ble_sls_t * p_sls, ble_sls_stream_rec_t const * p_rec);
+
+/**@brief Function for sending the records waiting in the Sled Stream buffer.
+ *
+ * @param[in]   p_sls          Sled Service structure.
+ *
+ * @return      NRF_SUCCESS on success (also if the buffer was empty), otherwise an error code.
+ */
+uint32_t ble_sls_stream_flush(ble_sls_t * p_sls);
+
+/**@brief Function for getting the notification flow control counters.
+ *
+ * @param[in]   p_sls          Sled Service structure.
+ *
+ * @return      Counters since init.
  */
-uint32_t ble_sls_sled_value_update(ble_sls_t * p_sls, uint64_t sled_value);
+ble_sls_tx_stats_t const * ble_sls_tx_stats_get(ble_sls_t const * p_sls);
 
 
 #endif
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "sdk_common.h"
+#include "odometer.h"
+
+/**@brief Function for converting counts to millimeters without overflowing.
+ *
+ * @details counts * um_per_rev / (cpr * 1000) is split into a quotient and remainder part, so
+ *          the intermediate products stay below |counts| and cpr * 1000 * um_per_rev respectively.
+ */
+static int64_t counts_to_mm(int64_t counts, uint32_t cpr)
+{
+    int64_t den = (int64_t)cpr * 1000;
+    int64_t q   = counts / den;
+    int64_t r   = counts % den;
+
+    return q * ODOMETER_UM_PER_REV + (r * ODOMETER_UM_PER_REV) / den;
+}
+
+
+ret_code_t odometer_init(odometer_t * p_odo, uint32_t cpr)
+{
+    if (p_odo == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (cpr == 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    p_odo->session_counts  = 0;
+    p_odo->lifetime_counts = 0;
+    p_odo->cpr             = cpr;
+
+    return NRF_SUCCESS;
+}
+
+
+void odometer_add(odometer_t * p_odo, int32_t counts)
+{
+    p_odo->session_counts  += counts;
+    p_odo->lifetime_counts += (counts < 0) ? -(int64_t)counts : counts;
+}
+
+
+void odometer_session_reset(odometer_t * p_odo)
+{
+    p_odo->session_counts = 0;
+}
+
+
+int64_t odometer_session_mm(odometer_t const * p_odo)
+{
+    return counts_to_mm(p_odo->session_counts, p_odo->cpr);
+}
+
+
+int64_t odometer_lifetime_mm(odometer_t const * p_odo)
+{
+    return counts_to_mm(p_odo->lifetime_counts, p_odo->cpr);
+}
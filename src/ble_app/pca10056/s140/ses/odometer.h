@@ -0,0 +1,53 @@
+#ifndef ODOMETER_H__
+#define ODOMETER_H__
+
+#include <stdint.h>
+#include "sdk_errors.h"
+
+#define ODOMETER_UM_PER_REV     997450      /**< Calibrated distance per encoder revolution (0.99745 m), in micrometers. */
+
+/**@brief Encoder odometer.
+ *
+ * @details Counts are kept as 64-bit integers and only converted to distance when read, so the
+ *          result never drifts no matter how many reports were accumulated. The session count is
+ *          signed (pushing back reduces it), the lifetime count is total travel in either direction.
+ */
+typedef struct
+{
+    int64_t  session_counts;    /**< Net counts since the last @ref odometer_session_reset. */
+    int64_t  lifetime_counts;   /**< Absolute counts since @ref odometer_init. */
+    uint32_t cpr;               /**< Encoder counts per revolution. */
+} odometer_t;
+
+/**@brief Function for initializing the odometer.
+ *
+ * @param[out]  p_odo   Odometer instance.
+ * @param[in]   cpr     Encoder counts per revolution (after x4 decoding).
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+ret_code_t odometer_init(odometer_t * p_odo, uint32_t cpr);
+
+/**@brief Function for adding the counts of one QDEC report.
+ *
+ * @param[in]   p_odo   Odometer instance.
+ * @param[in]   counts  Counts accumulated during the report period.
+ */
+void odometer_add(odometer_t * p_odo, int32_t counts);
+
+/**@brief Function for starting a new session. Lifetime totals are kept. */
+void odometer_session_reset(odometer_t * p_odo);
+
+/**@brief Function for getting the session distance.
+ *
+ * @return      Net distance since the last session reset, in millimeters (rounded toward zero).
+ */
+int64_t odometer_session_mm(odometer_t const * p_odo);
+
+/**@brief Function for getting the lifetime distance.
+ *
+ * @return      Total distance travelled since init, in millimeters (rounded toward zero).
+ */
+int64_t odometer_lifetime_mm(odometer_t const * p_odo);
+
+#endif /* ODOMETER_H__ */
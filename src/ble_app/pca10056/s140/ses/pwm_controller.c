@@ -1,36 +1,121 @@
 #include "pwm_controller.h"
 
-static nrf_drv_pwm_t m_pwm0 = NRFX_PWM_INSTANCE(0);
+#define PWM_MID_VALUE       7500
+#define PWM_LOW_VALUE       2000
+#define PWM_HILL_STEP       (PWM_TOP_VALUE / PWM_STEP_COUNT)
+#define PWM_PERIOD_MS       20                              /**< One PWM period, PWM_TOP_VALUE ticks at 500 kHz. */
 
-void initPwm(pwm_setting_t setting)
+/**@brief One step with separate left and right values, in channel order of config0. */
+#define PWM_LR(_l, _r)      { (_l), (_r), (_l), (_r) }
+
+/**@brief Waveform generators, evaluated by the compiler for every step index. */
+#define PWM_HILL(i)         (((i) < PWM_STEP_COUNT / 2) ? ((i) + 1) * PWM_HILL_STEP \
+                                                        : (PWM_STEP_COUNT - 1 - (i)) * PWM_HILL_STEP)
+
+#define PWM_WAVE_LINEAR1(i) PWM_LR(PWM_LOW_VALUE, PWM_LOW_VALUE)
+#define PWM_WAVE_LINEAR2(i) PWM_LR(PWM_MID_VALUE, PWM_MID_VALUE)
+#define PWM_WAVE_LINEAR3(i) PWM_LR(PWM_TOP_VALUE, PWM_TOP_VALUE)
+#define PWM_WAVE_LEFT(i)    PWM_LR(PWM_MID_VALUE, PWM_LOW_VALUE)
+#define PWM_WAVE_RIGHT(i)   PWM_LR(PWM_LOW_VALUE, PWM_MID_VALUE)
+#define PWM_WAVE_LATERAL(i) PWM_LR(PWM_HILL(i), PWM_HILL(((i) + PWM_STEP_COUNT / 2) % PWM_STEP_COUNT))
+#define PWM_WAVE_HILLS(i)   PWM_LR(PWM_HILL(i), PWM_HILL(i))
+
+#define PWM_GEN_10(_f, _i)  _f((_i) + 0), _f((_i) + 1), _f((_i) + 2), _f((_i) + 3), _f((_i) + 4), \
+                            _f((_i) + 5), _f((_i) + 6), _f((_i) + 7), _f((_i) + 8), _f((_i) + 9)
+#define PWM_GEN_100(_f)     { PWM_GEN_10(_f, 0),  PWM_GEN_10(_f, 10), PWM_GEN_10(_f, 20), PWM_GEN_10(_f, 30), \
+                              PWM_GEN_10(_f, 40), PWM_GEN_10(_f, 50), PWM_GEN_10(_f, 60), PWM_GEN_10(_f, 70), \
+                              PWM_GEN_10(_f, 80), PWM_GEN_10(_f, 90) }
+
+STATIC_ASSERT(PWM_STEP_COUNT == 100);
+
+// Waveform bank, one table per setting, generated at compile time and kept in flash.
+static const nrf_pwm_values_individual_t m_wave_bank[PWM_SETTING_COUNT][PWM_STEP_COUNT] =
 {
-  NRF_LOG_INFO("Initializing PWM Module.");
-  nrf_gpio_cfg_output(7);
-  nrf_gpio_cfg_output(8);
+  [PWM_LINEAR1]           = PWM_GEN_100(PWM_WAVE_LINEAR1),
+  [PWM_LINEAR2]           = PWM_GEN_100(PWM_WAVE_LINEAR2),
+  [PWM_LINEAR3]           = PWM_GEN_100(PWM_WAVE_LINEAR3),
+  [PWM_LEFT]              = PWM_GEN_100(PWM_WAVE_LEFT),
+  [PWM_RIGHT]             = PWM_GEN_100(PWM_WAVE_RIGHT),
+  [PWM_LATERAL_VARIATION] = PWM_GEN_100(PWM_WAVE_LATERAL),
+  [PWM_ROLLING_HILLS]     = PWM_GEN_100(PWM_WAVE_HILLS)
+};
 
-  // Initialize the application to Linear 1 setting
-  currentPwmSetting = setting;
-  pwmHandler();
-}
+static nrf_drv_pwm_t m_pwm0 = NRFX_PWM_INSTANCE(0);
+
+// EasyDMA only reads from RAM, so the bank is copied here once at start.
+static nrf_pwm_values_individual_t m_wave_ram[PWM_SETTING_COUNT][PWM_STEP_COUNT];
+static nrf_pwm_values_individual_t m_profile_slot[2][PWM_STEP_COUNT];   /**< Ping-pong tables for pwmProfileSet. */
+static uint8_t                     m_profile_next = 0;                  /**< Table the next profile is rendered to. */
+static nrf_pwm_values_individual_t m_level_slot[2];                     /**< Ping-pong slots for pwmResistanceSet. */
+static uint8_t                     m_level_next   = 0;                  /**< Slot the next level is written to. */
+static bool                        m_level_live   = false;              /**< The last written level slot plays, not a waveform or profile. */
+static bool                        m_level_deferred = false;            /**< m_level waits for the previous swap to start playing. */
+APP_TIMER_DEF(m_level_timer);                                           /**< Applies a deferred level one PWM period later. */
+static bool                        m_pwm_running  = false;
+
+APP_TIMER_DEF(m_ramp_timer);                                            /**< Steps pwmResistanceRamp once per PWM period. */
+static bool                        m_ramp_timer_created = false;
+static uint16_t                    m_level      = 0;                    /**< Last constant level, where a ramp starts. */
+static uint16_t                    m_ramp_from;
+static uint16_t                    m_ramp_to;
+static uint16_t                    m_ramp_steps;
+static uint16_t                    m_ramp_left  = 0;                    /**< Ramp steps still to go, 0 when idle. */
+
+static void pwmLevelTimeoutHandler(void * p_context);
 
-void completeSequence(nrf_pwm_values_common_t * sequence, const uint16_t value)
+/**@brief Function for pointing both sequence slots of the running playback at new values.
+ *
+ * @details The PWM latches SEQ[n].PTR and SEQ[n].CNT when sequence n starts, so on their own the
+ *          new values would wait for the next sequence boundary, up to 4 s into a 100 step
+ *          waveform. Sequence 0 is restarted instead, the peripheral keeps running and loads the
+ *          first new step at the next PWM period boundary. The register that shrinks the sequence
+ *          is written first, so a sequence starting between the two writes never reads past the
+ *          end of either buffer. PWMPERIODEND is cleared after the task, once it is set again the
+ *          new values are playing.
+ *
+ * @param[in] p_values  Steps in RAM.
+ * @param[in] steps     Number of steps.
+ * @param[in] refresh   Extra PWM periods each step is held for.
+ */
+static void pwmSequenceSwap(nrf_pwm_values_individual_t const * p_values, uint16_t steps, uint32_t refresh)
 {
-  for (int i = 0; i < 100; i++)
-  {
-    sequence[i] = value;
-  }
+    NRF_PWM_Type * p_reg  = m_pwm0.p_registers;
+    uint16_t       length = steps * (sizeof(*p_values) / sizeof(uint16_t));
+
+    CRITICAL_REGION_ENTER();
+    for (uint8_t seq_id = 0; seq_id < 2; seq_id++)
+    {
+        nrf_pwm_seq_refresh_set(p_reg, seq_id, refresh);
+        if (length < p_reg->SEQ[seq_id].CNT)
+        {
+            nrf_pwm_seq_cnt_set(p_reg, seq_id, length);
+            nrf_pwm_seq_ptr_set(p_reg, seq_id, (uint16_t const *)p_values);
+        }
+        else
+        {
+            nrf_pwm_seq_ptr_set(p_reg, seq_id, (uint16_t const *)p_values);
+            nrf_pwm_seq_cnt_set(p_reg, seq_id, length);
+        }
+    }
+    nrf_pwm_task_trigger(p_reg, NRF_PWM_TASK_SEQSTART0);
+    nrf_pwm_event_clear(p_reg, NRF_PWM_EVENT_PWMPERIODEND);
+    CRITICAL_REGION_EXIT();
 }
 
-void pwmHandler()
+/**@brief Function for configuring the PWM peripheral and starting looping playback.
+ *
+ * @details GPIO and the peripheral are set up once, every later change goes through
+ *          @ref pwmSequenceSwap.
+ *
+ * @param[in] p_values  Steps in RAM.
+ * @param[in] steps     Number of steps.
+ * @param[in] refresh   Extra PWM periods each step is held for.
+ */
+static void pwmStart(nrf_pwm_values_individual_t const * p_values, uint16_t steps, uint32_t refresh)
 {
-    nrf_drv_pwm_uninit(&m_pwm0);
-
-    enum { // [local constants]
-        TOP        = 10000,
-        MID        = 7500,
-        LOW        = 2000,
-        STEP_COUNT = 100
-    };
+    NRF_LOG_INFO("Initializing PWM Module.");
+    nrf_gpio_cfg_output(7);
+    nrf_gpio_cfg_output(8);
 
     nrf_drv_pwm_config_t const config0 =
     {
@@ -44,57 +129,283 @@ void pwmHandler()
         .irq_priority = APP_IRQ_PRIORITY_LOWEST,
         .base_clock   = NRF_PWM_CLK_500kHz,
         .count_mode   = NRF_PWM_MODE_UP,
-        .top_value    = TOP,
-        .load_mode    = NRF_PWM_LOAD_COMMON,
+        .top_value    = PWM_TOP_VALUE,
+        .load_mode    = NRF_PWM_LOAD_INDIVIDUAL,
         .step_mode    = NRF_PWM_STEP_AUTO
     };
     APP_ERROR_CHECK(nrf_drv_pwm_init(&m_pwm0, &config0, NULL));
+    APP_ERROR_CHECK(app_timer_create(&m_level_timer, APP_TIMER_MODE_SINGLE_SHOT, pwmLevelTimeoutHandler));
+
+    memcpy(m_wave_ram, m_wave_bank, sizeof(m_wave_ram));
+
+    nrf_pwm_sequence_t const seq0 =
+    {
+        .values.p_individual = p_values,
+        .length              = steps * (sizeof(*p_values) / sizeof(uint16_t)),
+        .repeats             = refresh,
+        .end_delay           = 0
+    };
+
+    // LOOP plays the sequence from both SEQ[0] and SEQ[1], which is what pwmSequenceSwap rewrites.
+    (void)nrf_drv_pwm_simple_playback(&m_pwm0, &seq0, 1,
+                                      NRF_DRV_PWM_FLAG_LOOP);
+    nrf_pwm_event_clear(m_pwm0.p_registers, NRF_PWM_EVENT_PWMPERIODEND);
+    m_pwm_running = true;
+}
+
+/**@brief Function for dropping a deferred level.
+ */
+static void pwmLevelDeferCancel(void)
+{
+    if (m_level_deferred)
+    {
+        m_level_deferred = false;
+        (void)app_timer_stop(m_level_timer);
+    }
+}
+
+/**@brief Function for giving up the level slots, a waveform or profile takes over.
+ */
+static void pwmLevelRelease(void)
+{
+    m_level_live = false;
+    pwmLevelDeferCancel();
+}
+
+/**@brief Function for writing a constant level to the running PWM, see @ref pwmResistanceSet.
+ *
+ * @details At most one slot is swapped in per PWM period. Until the previous swap reaches its
+ *          period boundary, EasyDMA may still read either slot, so the level is held and applied
+ *          one period later instead.
+ */
+static void pwmLevelApply(uint16_t level)
+{
+    nrf_pwm_values_individual_t * p_slot = &m_level_slot[m_level_next];
 
-    // This array cannot be allocated on stack (hence "static") and it must
-    // be in RAM (hence no "const", though its content is not changed).
-    static nrf_pwm_values_common_t /*const*/ seq0_values[STEP_COUNT];
-    uint16_t value;
-    uint16_t step  = TOP / STEP_COUNT;
-    uint8_t  i;
-
-    switch (currentPwmSetting)
-    {
-      case PWM_LINEAR1:
-        completeSequence((nrf_pwm_values_common_t *) &seq0_values, LOW);
-        break;
-      case PWM_LINEAR2:
-        completeSequence((nrf_pwm_values_common_t *) &seq0_values, MID);
-        break;
-      case PWM_LINEAR3:
-        completeSequence((nrf_pwm_values_common_t *) &seq0_values, TOP);
-        break;
-      case PWM_ROLLING_HILLS:
-        value = 0;
-        // Increase
-        for (i = 0; i < STEP_COUNT / 2; i++)
+    m_level = MIN(level, PWM_TOP_VALUE);
+
+    if (m_level_live && (m_level_slot[m_level_next ^ 1].channel_0 == m_level))
+    {
+        // Already playing, or starting at the next boundary.
+        pwmLevelDeferCancel();
+        return;
+    }
+
+    if (m_pwm_running && !nrf_pwm_event_check(m_pwm0.p_registers, NRF_PWM_EVENT_PWMPERIODEND))
+    {
+        if (!m_level_deferred)
         {
-            value         += step;
-            seq0_values[i] = value;
+            m_level_deferred = true;
+            APP_ERROR_CHECK(app_timer_start(m_level_timer, APP_TIMER_TICKS(PWM_PERIOD_MS), NULL));
         }
-        // Decrease
-        for (; i < STEP_COUNT; i++)
+        return;
+    }
+
+    // The other slot may still be playing until the current period ends, this one is free.
+    *p_slot = (nrf_pwm_values_individual_t) PWM_LR(m_level, m_level);
+    m_level_next ^= 1;
+    m_level_live  = true;
+
+    if (!m_pwm_running)
+    {
+        pwmStart(p_slot, 1, 0);
+        return;
+    }
+
+    pwmSequenceSwap(p_slot, 1, 0);
+}
+
+/**@brief Function for applying a deferred level, runs from the scheduler.
+ */
+static void pwmLevelDeferredApply(void * p_event_data, uint16_t event_size)
+{
+    UNUSED_PARAMETER(p_event_data);
+    UNUSED_PARAMETER(event_size);
+
+    // A waveform or profile set since the level was deferred has dropped it.
+    if (m_level_deferred)
+    {
+        m_level_deferred = false;
+        pwmLevelApply(m_level);
+    }
+}
+
+/**@brief Function for handling the deferred level timeout.
+ *
+ * @details Like the ramp, the level is only scheduled. A full queue retries one period later.
+ */
+static void pwmLevelTimeoutHandler(void * p_context)
+{
+    UNUSED_PARAMETER(p_context);
+    if (app_sched_event_put(NULL, 0, pwmLevelDeferredApply) != NRF_SUCCESS)
+    {
+        (void)app_timer_start(m_level_timer, APP_TIMER_TICKS(PWM_PERIOD_MS), NULL);
+    }
+}
+
+/**@brief Function for cancelling a running ramp, any direct setting overrides it.
+ */
+static void pwmRampStop(void)
+{
+    if (m_ramp_left != 0)
+    {
+        m_ramp_left = 0;
+        (void)app_timer_stop(m_ramp_timer);
+    }
+}
+
+/**@brief Function for applying one ramp step, runs from the scheduler.
+ */
+static void pwmRampStep(void * p_event_data, uint16_t event_size)
+{
+    int32_t delta = (int32_t)m_ramp_to - m_ramp_from;
+
+    UNUSED_PARAMETER(p_event_data);
+    UNUSED_PARAMETER(event_size);
+
+    // A step queued before the ramp was cancelled finds nothing left to do.
+    if (m_ramp_left == 0)
+    {
+        return;
+    }
+    m_ramp_left--;
+
+    pwmLevelApply((uint16_t)(m_ramp_to - (delta * m_ramp_left) / m_ramp_steps));
+
+    if (m_ramp_left == 0)
+    {
+        (void)app_timer_stop(m_ramp_timer);
+    }
+}
+
+/**@brief Function for handling the ramp timer timeout, one step per PWM period.
+ *
+ * @details The step is only scheduled, so the PWM registers are written from a single context.
+ *          A step lost to a full queue delays the ramp by one period.
+ */
+static void pwmRampTimeoutHandler(void * p_context)
+{
+    UNUSED_PARAMETER(p_context);
+    (void)app_sched_event_put(NULL, 0, pwmRampStep);
+}
+
+void initPwm(pwm_setting_t setting)
+{
+  if (setting >= PWM_SETTING_COUNT)
+  {
+    NRF_LOG_WARNING("Unknown PWM setting %d.", setting);
+    return;
+  }
+
+  pwmRampStop();
+  currentPwmSetting = setting;
+
+  if (!m_pwm_running)
+  {
+    pwmStart(m_wave_ram[setting], PWM_STEP_COUNT, 1);
+    return;
+  }
+
+  pwmHandler();
+}
+
+void pwmHandler()
+{
+    pwmLevelRelease();
+    pwmSequenceSwap(m_wave_ram[currentPwmSetting], PWM_STEP_COUNT, 1);
+}
+
+void pwmResistanceSet(uint16_t level)
+{
+    pwmRampStop();
+    pwmLevelApply(level);
+}
+
+ret_code_t pwmResistanceRamp(uint16_t level, uint16_t ramp_ms)
+{
+    ret_code_t err_code;
+
+    pwmRampStop();
+
+    if (ramp_ms < 2 * PWM_PERIOD_MS)
+    {
+        pwmLevelApply(level);
+        return NRF_SUCCESS;
+    }
+
+    if (!m_ramp_timer_created)
+    {
+        err_code = app_timer_create(&m_ramp_timer, APP_TIMER_MODE_REPEATED, pwmRampTimeoutHandler);
+        VERIFY_SUCCESS(err_code);
+        m_ramp_timer_created = true;
+    }
+
+    m_ramp_from  = m_level;
+    m_ramp_to    = MIN(level, PWM_TOP_VALUE);
+    m_ramp_steps = ramp_ms / PWM_PERIOD_MS;
+    m_ramp_left  = m_ramp_steps;
+
+    return app_timer_start(m_ramp_timer, APP_TIMER_TICKS(PWM_PERIOD_MS), NULL);
+}
+
+ret_code_t pwmProfileCheck(pwm_profile_point_t const * p_points, uint8_t count)
+{
+    uint32_t steps = 0;
+
+    VERIFY_PARAM_NOT_NULL(p_points);
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        steps += p_points[i].steps;
+    }
+    if ((count == 0) || (steps == 0) || (steps > PWM_STEP_COUNT))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    return NRF_SUCCESS;
+}
+
+ret_code_t pwmProfileSet(pwm_profile_point_t const * p_points, uint8_t count)
+{
+    nrf_pwm_values_individual_t * p_table = m_profile_slot[m_profile_next];
+    uint16_t                      steps;
+    uint8_t                       i;
+    ret_code_t                    err_code;
+
+    err_code = pwmProfileCheck(p_points, count);
+    VERIFY_SUCCESS(err_code);
+
+    // Ramp linearly from every point to the next one, the last point ramps back to the first.
+    steps = 0;
+    for (i = 0; i < count; i++)
+    {
+        pwm_profile_point_t const * p_from  = &p_points[i];
+        pwm_profile_point_t const * p_to    = &p_points[(i + 1) % count];
+        int32_t                     left    = MIN(p_from->left,  PWM_TOP_VALUE);
+        int32_t                     right   = MIN(p_from->right, PWM_TOP_VALUE);
+        int32_t                     d_left  = (int32_t)MIN(p_to->left,  PWM_TOP_VALUE) - left;
+        int32_t                     d_right = (int32_t)MIN(p_to->right, PWM_TOP_VALUE) - right;
+
+        for (uint16_t k = 0; k < p_from->steps; k++, steps++)
         {
-            value         -= step;
-            seq0_values[i] = value;
+            uint16_t l = (uint16_t)(left  + (d_left  * k) / p_from->steps);
+            uint16_t r = (uint16_t)(right + (d_right * k) / p_from->steps);
+
+            p_table[steps] = (nrf_pwm_values_individual_t) PWM_LR(l, r);
         }
-        break;
-      default:
-        break;
     }
-    
-    nrf_pwm_sequence_t const seq0 =
+    m_profile_next ^= 1;
+
+    pwmRampStop();
+    pwmLevelRelease();
+
+    if (!m_pwm_running)
     {
-        .values.p_common = seq0_values,
-        .length          = NRF_PWM_VALUES_LENGTH(seq0_values),
-        .repeats         = 1,
-        .end_delay       = 0
-    };
+        pwmStart(p_table, steps, 1);
+        return NRF_SUCCESS;
+    }
 
-    (void)nrf_drv_pwm_simple_playback(&m_pwm0, &seq0, 1,
-                                      NRF_DRV_PWM_FLAG_LOOP);
-}
\ No newline at end of file
+    pwmSequenceSwap(p_table, steps, 1);
+    return NRF_SUCCESS;
+}
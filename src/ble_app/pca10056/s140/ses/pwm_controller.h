@@ -11,6 +11,7 @@
 #include "boards.h"
 #include "bsp.h"
 #include "app_timer.h"
+#include "app_scheduler.h"
 #include "nrf_drv_clock.h"
 #include "nrf_gpio.h"
 
@@ -18,6 +19,9 @@
 #include "nrf_log_ctrl.h"
 #include "nrf_log_default_backends.h"
 
+#define PWM_STEP_COUNT      100         /**< Steps in one waveform table. */
+#define PWM_TOP_VALUE       10000       /**< PWM counter top (50 Hz at 500 kHz), full resistance. */
+
 typedef enum
 {
   PWM_LINEAR1,
@@ -26,22 +30,89 @@ typedef enum
   PWM_LEFT,
   PWM_RIGHT,
   PWM_LATERAL_VARIATION,
-  PWM_ROLLING_HILLS  
+  PWM_ROLLING_HILLS,
+  PWM_SETTING_COUNT
 } pwm_setting_t;
 
+/**@brief One point of a piecewise linear resistance profile.
+ *
+ * @details Left is output channels 0 and 2, right is channels 1 and 3 of the PWM instance.
+ */
+typedef struct
+{
+  uint16_t left;        /**< Left resistance, 0 to @ref PWM_TOP_VALUE. */
+  uint16_t right;       /**< Right resistance, 0 to @ref PWM_TOP_VALUE. */
+  uint16_t steps;       /**< Steps to ramp from this point to the next (the last point ramps to the first). */
+} pwm_profile_point_t;
+
 static pwm_setting_t currentPwmSetting;
 
 /**@brief Function for initializing the application for PWM support
  *
- * @details Initializes PWM settings.
+ * @details Starts the PWM peripheral on the first call. Later calls only switch the waveform,
+ *          see @ref pwmHandler.
  *
  * @note 
  *
  */
 void initPwm(pwm_setting_t setting);
 
+/**@brief Function for switching the running PWM to the waveform of the current setting.
+ *
+ * @details Constant time, only the sequence pointers are swapped to a precomputed table. The
+ *          waveform restarts from its first step at the next PWM period boundary.
+ */
 void pwmHandler();
 
-void completeSequence(nrf_pwm_values_common_t * sequence, const uint16_t value);
+/**@brief Function for setting a constant resistance level on the running PWM.
+ *
+ * @details The peripheral keeps running; the level is written to the free one of two RAM slots
+ *          and takes over at the next PWM period boundary, also while a waveform or profile is
+ *          playing. The level already set returns at once. A level set while the previous one
+ *          waits for its boundary is applied one period later, the latest of them wins. Starts the
+ *          PWM if needed and cancels a running ramp. Must not be called from more than one
+ *          interrupt priority.
+ *
+ * @param[in] level     Duty in counter ticks, clamped to @ref PWM_TOP_VALUE.
+ */
+void pwmResistanceSet(uint16_t level);
+
+/**@brief Function for ramping the resistance linearly to a constant level.
+ *
+ * @details Starts from the last constant level and steps once per PWM period. The app_timer only
+ *          schedules the steps, they are applied from @ref app_sched_execute like every other
+ *          setting. Any other setting cancels the ramp. Ramps shorter than two periods are applied
+ *          at once.
+ *
+ * @param[in] level     Duty in counter ticks, clamped to @ref PWM_TOP_VALUE.
+ * @param[in] ramp_ms   Ramp duration in milliseconds.
+ *
+ * @return    NRF_SUCCESS on success, otherwise the app_timer error code.
+ */
+ret_code_t pwmResistanceRamp(uint16_t level, uint16_t ramp_ms);
+
+/**@brief Function for playing an arbitrary piecewise linear profile in a loop.
+ *
+ * @details The profile is rendered into the free one of two RAM tables, left and right are
+ *          loaded per channel by the PWM, and the table starts from its first step at the next
+ *          PWM period boundary.
+ *          Starts the PWM if needed. Must not be called from more than one interrupt priority.
+ *
+ * @param[in] p_points  Profile points.
+ * @param[in] count     Number of points.
+ *
+ * @return    NRF_SUCCESS on success, NRF_ERROR_INVALID_LENGTH if the steps add up to zero or more
+ *            than @ref PWM_STEP_COUNT.
+ */
+ret_code_t pwmProfileSet(pwm_profile_point_t const * p_points, uint8_t count);
+
+/**@brief Function for checking a profile without playing it.
+ *
+ * @details Lets a caller accept or reject a profile before handing it to @ref pwmProfileSet from
+ *          another context. Safe to call from any context.
+ *
+ * @return    See @ref pwmProfileSet.
+ */
+ret_code_t pwmProfileCheck(pwm_profile_point_t const * p_points, uint8_t count);
 
 #endif
\ No newline at end of file
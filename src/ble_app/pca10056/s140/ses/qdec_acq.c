@@ -0,0 +1,538 @@
+#include "sdk_common.h"
+#include "qdec_acq.h"
+#include "nrf_drv_qdec.h"
+#include "nrf_drv_timer.h"
+#include "nrf_drv_ppi.h"
+#include "nrf_drv_gpiote.h"
+#include "app_timer.h"
+#include "nrf_atfifo.h"
+#include "nrf_log.h"
+
+/**@brief Converts app_timer ticks to microseconds. */
+#define QDEC_ACQ_TICKS_TO_US(_ticks) \
+    ((uint32_t)(((uint64_t)(_ticks) * (APP_TIMER_CONFIG_RTC_FREQUENCY + 1) * 1000000) / APP_TIMER_CLOCK_FREQ))
+
+/**@brief Interval at which a sleep span is folded into m_sleep_us.
+ *
+ * @details The 24-bit RTC wraps after 1024 s at 16384 Hz, so app_timer tick differences are only
+ *          valid for spans shorter than that. A quarter of the wrap leaves ample margin.
+ */
+#define QDEC_ACQ_SLEEP_CHECKPOINT_MS    256000
+
+APP_TIMER_DEF(m_sleep_timer);
+
+NRF_ATFIFO_DEF(m_qdec_fifo, qdec_acq_sample_t, QDEC_ACQ_FIFO_SIZE);
+
+static const nrf_drv_timer_t m_ts_timer = NRF_DRV_TIMER_INSTANCE(QDEC_ACQ_TIMER_INSTANCE);
+static nrf_ppi_channel_t     m_ts_ppi_channel;
+
+/**@brief Acquisition ranges, fastest first.
+ *
+ * @details A range is kept up to one transition per sample on average, half of what the decoder
+ *          resolves, which leaves room to accelerate until the next report. Range 0 has no limit,
+ *          the top speed check against its sample period is done by the application.
+ */
+static const qdec_acq_range_t m_ranges[QDEC_ACQ_RANGE_COUNT] =
+{
+    {NRF_QDEC_SAMPLEPER_128us, NRF_QDEC_REPORTPER_10, 128, 128 * QDEC_ACQ_FAST_REPORT_SAMPLES, UINT32_MAX},
+    {NRF_QDEC_SAMPLEPER_256us, NRF_QDEC_REPORTPER_40, 256, 256 * 40, 1000000 / 256},
+    {NRF_QDEC_SAMPLEPER_512us, NRF_QDEC_REPORTPER_40, 512, 512 * 40, 1000000 / 512}
+};
+
+// ACCDBL cannot saturate in range 0, which is used at top speed. The 40 sample ranges only see
+// double transitions when the sled speeds up faster than they can switch, such reports are counted.
+STATIC_ASSERT(QDEC_ACQ_FAST_REPORT_SAMPLES <= QDEC_ACQ_ACCDBL_MAX);
+
+static volatile bool     m_batch_ready;     /**< Set from the ISR when a batch of reports is available. */
+static qdec_acq_stats_t  m_stats;           /**< Counters, ISR only. */
+static uint32_t          m_batch_us;        /**< Report time since the last batch, ISR only. */
+static uint32_t          m_last_timestamp;  /**< Timestamp of the previous report, ISR only. */
+static uint32_t          m_period_start;    /**< TIMER value the current report period started at, ISR only. */
+static uint32_t          m_idle_timeout_us; /**< Time without motion before sleeping, 0 to never sleep. */
+static uint32_t          m_idle_us;         /**< Time without motion so far, ISR only. */
+static uint8_t           m_range;           /**< Active acquisition range, index into m_ranges. */
+static bool              m_autorange = true; /**< Range follows the measured speed, see @ref qdec_acq_autorange_set. */
+static uint32_t          m_downshift_us;    /**< Time the speed stayed low enough for a slower range. */
+static bool              m_sampling;        /**< The QDEC is enabled and sampling. */
+static volatile bool     m_sleeping;        /**< Sampling is stopped and wake-on-move is armed. */
+static uint32_t          m_sleep_ticks;     /**< app_timer counter at the last sleep checkpoint. */
+static uint64_t          m_sleep_us;        /**< Sleep time up to the last checkpoint, ISR only. */
+static uint64_t          m_gap_us;          /**< Sleep span handed to the next report, ISR only. */
+static int8_t            m_direction = 1;   /**< Sign of the last report with counts, ISR only. */
+static qdec_acq_evt_handler_t m_evt_handler; /**< See @ref qdec_acq_init_t. */
+
+/**@brief Function for passing an event to the application handler.
+ */
+static void evt_send(qdec_acq_evt_type_t type, qdec_acq_sample_t const * p_sample)
+{
+    qdec_acq_evt_t evt;
+
+    if (m_evt_handler != NULL)
+    {
+        evt.type     = type;
+        evt.p_sample = p_sample;
+        m_evt_handler(&evt);
+    }
+}
+
+
+/**@brief Function for arming the TIMER compare that stands in for a null report.
+ *
+ * @details The QDEC raises REPORTRDY only for reports with transitions, so a standing sled
+ *          produces no reports at all. The compare fires half a sample after the end of the
+ *          current report period, by when a report with counts would have been captured.
+ */
+static void null_report_arm(void)
+{
+    qdec_acq_range_t const * p_range = &m_ranges[m_range];
+
+    nrf_drv_timer_compare(&m_ts_timer,
+                          NRF_TIMER_CC_CHANNEL1,
+                          m_period_start + p_range->period_us + p_range->sample_us / 2,
+                          true);
+}
+
+
+/**@brief Function for (re)starting the QDEC and the timestamp TIMER.
+ */
+static void sampling_start(void)
+{
+    // The first report is timed from the start of sampling.
+    m_last_timestamp = 0;
+    m_period_start   = 0;
+    m_idle_us        = 0;
+    m_downshift_us   = 0;
+    m_sampling       = true;
+    nrf_drv_timer_clear(&m_ts_timer);
+    null_report_arm();
+    nrf_drv_timer_enable(&m_ts_timer);
+    nrf_drv_qdec_enable();
+}
+
+
+/**@brief Function for stopping the QDEC and the timestamp TIMER, releasing the HFCLK they request.
+ */
+static void sampling_stop(void)
+{
+    m_sampling = false;
+    nrf_drv_qdec_disable();
+    nrf_drv_timer_disable(&m_ts_timer);
+}
+
+
+/**@brief Function for arming or disarming the PORT event on the encoder pins.
+ */
+static void wake_enable(bool enable)
+{
+    if (enable)
+    {
+        nrf_drv_gpiote_in_event_enable(QDEC_CONFIG_PIO_A, true);
+        nrf_drv_gpiote_in_event_enable(QDEC_CONFIG_PIO_B, true);
+    }
+    else
+    {
+        nrf_drv_gpiote_in_event_disable(QDEC_CONFIG_PIO_A);
+        nrf_drv_gpiote_in_event_disable(QDEC_CONFIG_PIO_B);
+    }
+}
+
+
+/**@brief Function for folding the RTC ticks since the last checkpoint into the sleep time.
+ */
+static void sleep_checkpoint(void)
+{
+    uint32_t ticks = app_timer_cnt_get();
+
+    m_sleep_us   += QDEC_ACQ_TICKS_TO_US(app_timer_cnt_diff_compute(ticks, m_sleep_ticks));
+    m_sleep_ticks = ticks;
+}
+
+
+/**@brief Callback function for the sleep checkpoint timer.
+ *
+ * @details Runs in the RTC interrupt, which has the same priority as the QDEC and GPIOTE
+ *          interrupts. A timeout already pending when sampling woke up finds nothing to do.
+ */
+static void sleep_timer_handler(void * p_context)
+{
+    UNUSED_PARAMETER(p_context);
+
+    if (m_sleeping)
+    {
+        sleep_checkpoint();
+    }
+}
+
+
+/**@brief Function for putting sampling to sleep until the encoder moves, runs in the QDEC interrupt.
+ */
+static void sleep_enter(void)
+{
+    sampling_stop();
+    m_sleep_ticks = app_timer_cnt_get();
+    m_sleep_us    = 0;
+    m_sleeping    = true;
+    m_stats.sleeps++;
+    wake_enable(true);
+    (void)app_timer_start(m_sleep_timer, APP_TIMER_TICKS(QDEC_ACQ_SLEEP_CHECKPOINT_MS), NULL);
+
+    evt_send(QDEC_ACQ_EVT_SLEEP, NULL);
+}
+
+
+/**@brief Callback function for an edge on the encoder A or B pin while sleeping.
+ *
+ * @details Runs in the GPIOTE interrupt at the same priority as the QDEC interrupt.
+ */
+static void wake_pin_handler(nrf_drv_gpiote_pin_t pin, nrf_gpiote_polarity_t action)
+{
+    UNUSED_PARAMETER(pin);
+    UNUSED_PARAMETER(action);
+
+    if (!m_sleeping)
+    {
+        return;
+    }
+
+    wake_enable(false);
+    (void)app_timer_stop(m_sleep_timer);
+    m_sleeping = false;
+
+    // The RTC keeps running, so the next report can account for the time spent asleep. The
+    // checkpoints keep every tick difference below the RTC wrap, however long the sled was parked.
+    sleep_checkpoint();
+    m_gap_us = m_sleep_us;
+    sampling_start();
+
+    evt_send(QDEC_ACQ_EVT_WAKE, NULL);
+}
+
+
+/**@brief Function for adding the counts lost to double transitions.
+ *
+ * @details A double transition means two counts were skipped in one sample. At speeds the sample
+ *          period is sized for, the sled cannot reverse within a report, so the counts go in the
+ *          direction of travel. A saturated ACCDBL gives a lower bound, see
+ *          @ref qdec_acq_stats_t::accdbl_saturated.
+ */
+static int32_t counts_compensate(int16_t acc, uint16_t accdbl)
+{
+    if (acc > 0)
+    {
+        m_direction = 1;
+    }
+    else if (acc < 0)
+    {
+        m_direction = -1;
+    }
+
+    return (int32_t)acc + m_direction * 2 * (int32_t)accdbl;
+}
+
+
+/**@brief Function for switching the acquisition range.
+ *
+ * @details The registers are written with the QDEC stopped. Counts accumulated before the switch
+ *          end up in the next report, whose duration is measured by the TIMER either way.
+ */
+static void range_apply(uint8_t range)
+{
+    m_downshift_us = 0;
+
+    if (range == m_range)
+    {
+        return;
+    }
+
+    if (m_sampling)
+    {
+        nrf_qdec_task_trigger(NRF_QDEC_TASK_STOP);
+    }
+    nrf_qdec_sampleper_set(m_ranges[range].sampleper);
+    nrf_qdec_reportper_set(m_ranges[range].reportper);
+
+    m_range = range;
+    m_stats.range_switches++;
+
+    if (m_sampling)
+    {
+        // The restarted QDEC counts its report period from now.
+        nrf_qdec_task_trigger(NRF_QDEC_TASK_START);
+        m_period_start = nrf_drv_timer_capture(&m_ts_timer, NRF_TIMER_CC_CHANNEL2);
+        null_report_arm();
+    }
+}
+
+
+/**@brief Function for selecting the acquisition range from the speed of the latest report.
+ */
+static void range_select(qdec_acq_sample_t const * p_sample)
+{
+    uint32_t cps;
+    uint8_t  range = m_range;
+
+    if (!m_autorange || (p_sample->dt_us == 0))
+    {
+        return;
+    }
+
+    cps = (uint32_t)(((uint64_t)ABS(p_sample->counts) * 1000000) / p_sample->dt_us);
+
+    // A saturated ACCDBL only bounds the speed from below, the fastest range resolves it.
+    if (p_sample->accdbl >= QDEC_ACQ_ACCDBL_MAX)
+    {
+        range = 0;
+    }
+
+    // Faster right away, missed transitions cannot be recovered.
+    while ((range > 0) && (cps > m_ranges[range].max_cps))
+    {
+        range--;
+    }
+    if (range != m_range)
+    {
+        range_apply(range);
+        return;
+    }
+
+    // Slower only once the speed stayed well inside the slower range.
+    if ((range + 1 < QDEC_ACQ_RANGE_COUNT) && (cps < m_ranges[range + 1].max_cps / 2))
+    {
+        m_downshift_us += p_sample->dt_us;
+        if (m_downshift_us >= QDEC_ACQ_DOWNSHIFT_US)
+        {
+            range_apply(range + 1);
+        }
+    }
+    else
+    {
+        m_downshift_us = 0;
+    }
+}
+
+
+/**@brief Function for handling one report, real or null.
+ *
+ * @details Runs in the QDEC or the TIMER interrupt, which share a priority.
+ */
+static void report_process(uint32_t timestamp, int16_t acc, uint16_t accdbl)
+{
+    qdec_acq_sample_t sample =
+    {
+        .timestamp = timestamp,
+        .dt_us     = timestamp - m_last_timestamp,
+        .gap_us    = m_gap_us,
+        .counts    = counts_compensate(acc, accdbl),
+        .acc       = acc,
+        .accdbl    = accdbl,
+        .range     = m_range
+    };
+
+    m_last_timestamp = timestamp;
+    m_period_start   = timestamp;
+    m_gap_us         = 0;
+    m_stats.reports++;
+    m_stats.accdbl  += sample.accdbl;
+    m_stats.accdbl_saturated += (sample.accdbl >= QDEC_ACQ_ACCDBL_MAX);
+
+    if (nrf_atfifo_alloc_put(m_qdec_fifo, &sample, sizeof(sample), NULL) != NRF_SUCCESS)
+    {
+        m_stats.overflows++;
+    }
+
+    m_batch_us += sample.dt_us;
+    if (m_batch_us >= QDEC_ACQ_BATCH_US)
+    {
+        m_batch_us    = 0;
+        m_batch_ready = true;
+    }
+
+    evt_send(QDEC_ACQ_EVT_REPORT, &sample);
+
+    // Re-armed before the range switch, which moves the period start again.
+    null_report_arm();
+    range_select(&sample);
+
+    if ((sample.acc != 0) || (sample.accdbl != 0))
+    {
+        m_idle_us = 0;
+    }
+    else if ((m_idle_timeout_us != 0) && ((m_idle_us += sample.dt_us) >= m_idle_timeout_us))
+    {
+        sleep_enter();
+    }
+}
+
+
+/**@brief Callback function for QDEC event.
+ *
+ * @details Runs in interrupt context. The peripheral is left running, the report is only
+ *          copied into the FIFO together with the timestamp PPI captured at REPORTRDY.
+ */
+static void qdec_event_handler(nrf_drv_qdec_event_t event)
+{
+    if (event.type == NRF_QDEC_EVENT_REPORTRDY)
+    {
+        report_process(nrf_drv_timer_capture_get(&m_ts_timer, NRF_TIMER_CC_CHANNEL0),
+                       event.data.report.acc,
+                       event.data.report.accdbl);
+    }
+}
+
+
+/**@brief Callback function for the timestamp TIMER.
+ *
+ * @details A report period ended without REPORTRDY: no transition, which is a null report. It is
+ *          timestamped at the end of the period, as the QDEC would have done.
+ */
+static void ts_timer_event_handler(nrf_timer_event_t event_type, void * p_context)
+{
+    UNUSED_PARAMETER(p_context);
+
+    // A REPORTRDY pending behind this interrupt ends the same period and re-arms the compare.
+    if ((event_type == NRF_TIMER_EVENT_COMPARE1) && !nrf_qdec_event_check(NRF_QDEC_EVENT_REPORTRDY))
+    {
+        report_process(m_period_start + m_ranges[m_range].period_us, 0, 0);
+    }
+}
+
+
+ret_code_t qdec_acq_init(qdec_acq_init_t const * p_init)
+{
+    ret_code_t err_code;
+
+    VERIFY_PARAM_NOT_NULL(p_init);
+
+    m_evt_handler     = p_init->evt_handler;
+    m_idle_timeout_us = p_init->idle_timeout_us;
+
+    err_code = NRF_ATFIFO_INIT(m_qdec_fifo);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = nrf_drv_qdec_init(NULL, qdec_event_handler);
+    VERIFY_SUCCESS(err_code);
+    nrf_qdec_dbfen_enable();
+
+    // Start in the fastest range, whatever sdk_config.h holds.
+    m_range = 0;
+    nrf_qdec_sampleper_set(m_ranges[0].sampleper);
+    nrf_qdec_reportper_set(m_ranges[0].reportper);
+
+    // Free running 1 MHz, 32-bit TIMER. CC[0] timestamps reports, CC[1] times null reports.
+    nrf_drv_timer_config_t timer_cfg = NRF_DRV_TIMER_DEFAULT_CONFIG;
+    timer_cfg.frequency = NRF_TIMER_FREQ_1MHz;
+    timer_cfg.bit_width = NRF_TIMER_BIT_WIDTH_32;
+
+    err_code = nrf_drv_timer_init(&m_ts_timer, &timer_cfg, ts_timer_event_handler);
+    VERIFY_SUCCESS(err_code);
+
+    // REPORTRDY -> TIMER CAPTURE[0], the CPU is not involved in timing the report.
+    err_code = nrf_drv_ppi_init();
+    if (err_code != NRF_ERROR_MODULE_ALREADY_INITIALIZED)
+    {
+        VERIFY_SUCCESS(err_code);
+    }
+
+    err_code = nrf_drv_ppi_channel_alloc(&m_ts_ppi_channel);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = nrf_drv_ppi_channel_assign(m_ts_ppi_channel,
+                                          nrfx_qdec_event_address_get(NRF_QDEC_EVENT_REPORTRDY),
+                                          nrf_drv_timer_capture_task_address_get(&m_ts_timer,
+                                                                                 NRF_TIMER_CC_CHANNEL0));
+    VERIFY_SUCCESS(err_code);
+
+    err_code = nrf_drv_ppi_channel_enable(m_ts_ppi_channel);
+    VERIFY_SUCCESS(err_code);
+
+    // Wake-on-move uses the PORT event, no GPIOTE channel and no HFCLK while waiting.
+    if (!nrf_drv_gpiote_is_init())
+    {
+        err_code = nrf_drv_gpiote_init();
+        VERIFY_SUCCESS(err_code);
+    }
+
+    nrf_drv_gpiote_in_config_t wake_cfg = GPIOTE_CONFIG_IN_SENSE_TOGGLE(false);
+
+    err_code = nrf_drv_gpiote_in_init(QDEC_CONFIG_PIO_A, &wake_cfg, wake_pin_handler);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = nrf_drv_gpiote_in_init(QDEC_CONFIG_PIO_B, &wake_cfg, wake_pin_handler);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = app_timer_create(&m_sleep_timer, APP_TIMER_MODE_REPEATED, sleep_timer_handler);
+    VERIFY_SUCCESS(err_code);
+
+    NRF_LOG_INFO("QDEC initialized.");
+    return NRF_SUCCESS;
+}
+
+
+void qdec_acq_start(void)
+{
+    CRITICAL_REGION_ENTER();
+    m_gap_us = 0;
+    sampling_start();
+    CRITICAL_REGION_EXIT();
+}
+
+
+void qdec_acq_stop(void)
+{
+    CRITICAL_REGION_ENTER();
+    if (m_sleeping)
+    {
+        wake_enable(false);
+        (void)app_timer_stop(m_sleep_timer);
+        m_sleeping = false;
+    }
+    sampling_stop();
+    CRITICAL_REGION_EXIT();
+}
+
+
+bool qdec_acq_is_sleeping(void)
+{
+    return m_sleeping;
+}
+
+
+bool qdec_acq_batch_ready(void)
+{
+    if (!m_batch_ready)
+    {
+        return false;
+    }
+    m_batch_ready = false;
+    return true;
+}
+
+
+bool qdec_acq_sample_get(qdec_acq_sample_t * p_sample)
+{
+    return (nrf_atfifo_get_free(m_qdec_fifo, p_sample, sizeof(*p_sample), NULL) == NRF_SUCCESS);
+}
+
+
+qdec_acq_range_t const * qdec_acq_range_get(uint8_t range)
+{
+    return &m_ranges[MIN(range, QDEC_ACQ_RANGE_COUNT - 1)];
+}
+
+
+void qdec_acq_autorange_set(bool enable)
+{
+    CRITICAL_REGION_ENTER();
+    m_autorange = enable;
+    if (!enable)
+    {
+        range_apply(0);
+    }
+    CRITICAL_REGION_EXIT();
+}
+
+
+void qdec_acq_stats_get(qdec_acq_stats_t * p_stats)
+{
+    *p_stats = m_stats;
+}
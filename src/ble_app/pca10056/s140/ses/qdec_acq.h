@@ -0,0 +1,177 @@
+#ifndef QDEC_ACQ_H__
+#define QDEC_ACQ_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdk_errors.h"
+#include "nrf_qdec.h"
+
+#define QDEC_ACQ_FIFO_SIZE      64      /**< Number of QDEC reports the acquisition FIFO can hold. */
+#define QDEC_ACQ_BATCH_US       20000   /**< Report time that makes up one batch for the main loop, in microseconds. */
+#define QDEC_ACQ_TIMER_INSTANCE 1       /**< TIMER instance capturing the report timestamps (TIMER0 belongs to the SoftDevice). */
+#define QDEC_ACQ_RANGE_COUNT    3       /**< Number of sample and report period ranges, see @ref qdec_acq_range_get. */
+#define QDEC_ACQ_FAST_SAMPLE_US 128     /**< Sample period of range 0, the one used at top speed. */
+#define QDEC_ACQ_FAST_REPORT_SAMPLES 10 /**< Samples per report of range 0, REPORTPER. */
+#define QDEC_ACQ_ACCDBL_MAX     15      /**< ACCDBL is 4 bits wide and saturates at this value. */
+#define QDEC_ACQ_DOWNSHIFT_US   500000  /**< Time the speed must stay low before moving to a slower range. */
+
+/**@brief Sample and report period of one acquisition range.
+ *
+ * @details The table is constant, so consumers can cache the period per range instead of reading
+ *          the peripheral registers.
+ */
+typedef struct
+{
+    nrf_qdec_sampleper_t sampleper;     /**< SAMPLEPER register value. */
+    nrf_qdec_reportper_t reportper;     /**< REPORTPER register value. */
+    uint32_t             sample_us;     /**< Sample period, SAMPLEPER, in microseconds. */
+    uint32_t             period_us;     /**< Report period, SAMPLEPER x REPORTPER, in microseconds. */
+    uint32_t             max_cps;       /**< Highest transition rate the range is kept for, counts per second. */
+} qdec_acq_range_t;
+
+/**@brief One QDEC report as captured in the REPORTRDY interrupt.
+ *
+ * @details The timestamp is captured by a TIMER through PPI on the REPORTRDY event itself, so it
+ *          is exact regardless of interrupt latency.
+ *
+ *          The QDEC raises REPORTRDY only when the report saw a transition. A TIMER compare stands
+ *          in for the others: a report period that passes without REPORTRDY is handed on as a
+ *          null report, timestamped at the end of the period.
+ *
+ *          When A and B both change within one sample period the QDEC cannot tell the direction
+ *          and counts a double transition instead. Each one stands for two counts, which are
+ *          added in the direction of the last report that had a direction.
+ */
+typedef struct
+{
+    uint64_t gap_us;    /**< Time sampling slept right before this report, measured on the RTC, 0 otherwise. */
+    uint32_t timestamp; /**< TIMER value at REPORTRDY, in microseconds since sampling last (re)started. Wraps after 71 minutes. */
+    uint32_t dt_us;     /**< Time elapsed since the previous report, in microseconds. */
+    int32_t  counts;    /**< Counts for the report period, acc plus the compensated double transitions. */
+    int16_t  acc;       /**< Accumulated transitions (ACCREAD) for the report period. */
+    uint16_t accdbl;    /**< Accumulated double transitions (ACCDBLREAD) for the report period. */
+    uint8_t  range;     /**< Acquisition range the report was sampled with. */
+} qdec_acq_sample_t;
+
+/**@brief Acquisition counters since init. */
+typedef struct
+{
+    uint32_t reports;           /**< REPORTRDY events handled. */
+    uint32_t accdbl;            /**< Sum of ACCDBLREAD, transitions the decoder could not resolve. */
+    uint32_t accdbl_saturated;  /**< Reports whose ACCDBL saturated, their counts are a lower bound. */
+    uint32_t overflows;         /**< Reports dropped because the FIFO was full. */
+    uint32_t sleeps;            /**< Times sampling went to sleep for lack of motion. */
+    uint32_t range_switches;    /**< Times the acquisition range changed. */
+} qdec_acq_stats_t;
+
+/**@brief QDEC acquisition event types. */
+typedef enum
+{
+    QDEC_ACQ_EVT_REPORT,        /**< A report was put into the FIFO. */
+    QDEC_ACQ_EVT_SLEEP,         /**< No motion for idle_timeout_us, sampling stopped until the encoder moves. */
+    QDEC_ACQ_EVT_WAKE           /**< The encoder moved while sleeping, sampling restarted. */
+} qdec_acq_evt_type_t;
+
+/**@brief QDEC acquisition event. */
+typedef struct
+{
+    qdec_acq_evt_type_t       type;
+    qdec_acq_sample_t const * p_sample;     /**< Valid for @ref QDEC_ACQ_EVT_REPORT only. */
+} qdec_acq_evt_t;
+
+/**@brief Event handler type, called from the QDEC, TIMER and GPIOTE interrupts. Must be short. */
+typedef void (*qdec_acq_evt_handler_t)(qdec_acq_evt_t const * p_evt);
+
+/**@brief QDEC acquisition init structure. */
+typedef struct
+{
+    qdec_acq_evt_handler_t evt_handler;     /**< Event handler, can be NULL. */
+    uint32_t               idle_timeout_us; /**< Time without motion before sampling sleeps, 0 to never sleep. */
+} qdec_acq_init_t;
+
+/**@brief Function for initializing the QDEC acquisition stage.
+ *
+ * @details Initializes the QDEC driver, the report FIFO and the timestamp TIMER, and connects
+ *          REPORTRDY to the TIMER capture task through PPI. The TIMER compare interrupt times the
+ *          null reports. The encoder A and B pins are prepared as low power GPIOTE inputs for
+ *          wake-on-move. Sampling is not started.
+ *
+ * @param[in]   p_init      Initialization parameters.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+ret_code_t qdec_acq_init(qdec_acq_init_t const * p_init);
+
+/**@brief Function for starting continuous QDEC acquisition.
+ *
+ * @details The peripheral stays enabled and every report, REPORTRDY or null, is pushed into the
+ *          FIFO. The timestamp TIMER is restarted from zero.
+ *
+ *          After idle_timeout_us of reports without a single transition the QDEC and the TIMER are
+ *          stopped and a PORT event is armed on the A and B pins instead, which costs no more than
+ *          the GPIO sense logic. The first edge restarts sampling from the GPIOTE interrupt, so
+ *          the motion is seen one sample period later. The waking edge itself is not counted.
+ *          A repeating app_timer checkpoints the sleep time every 256 s, well inside the 1024 s
+ *          wrap of the RTC, so the gap reported on wake is exact for sleeps of any length.
+ */
+void qdec_acq_start(void);
+
+/**@brief Function for stopping QDEC acquisition, the timestamp TIMER and wake-on-move. */
+void qdec_acq_stop(void);
+
+/**@brief Function for checking if sampling sleeps waiting for the encoder to move. */
+bool qdec_acq_is_sleeping(void);
+
+/**@brief Function for checking if a full batch of reports is waiting in the FIFO.
+ *
+ * @details Clears the batch flag, so the caller is expected to drain the FIFO with
+ *          @ref qdec_acq_sample_get afterwards. Batches are counted in time rather than reports,
+ *          so their rate does not depend on the acquisition range.
+ *
+ * @return      True if at least @ref QDEC_ACQ_BATCH_US of reports arrived since the last batch.
+ */
+bool qdec_acq_batch_ready(void);
+
+/**@brief Function for taking the oldest report out of the FIFO.
+ *
+ * @param[out]  p_sample    Report read from the FIFO.
+ *
+ * @return      True if a report was read, false if the FIFO is empty.
+ */
+bool qdec_acq_sample_get(qdec_acq_sample_t * p_sample);
+
+/**@brief Function for getting the descriptor of an acquisition range.
+ *
+ * @details Range 0 samples fastest and reports every 10 samples, for sprint speed. The slower
+ *          ranges sample less often and report over more samples, which cuts interrupts and gives
+ *          more counts per report at walking pace.
+ *
+ *          After every report the transition rate is compared against the range limits. A faster
+ *          range is taken right away; a slower one only after the rate stayed below half its limit
+ *          for @ref QDEC_ACQ_DOWNSHIFT_US, so the range does not flap around a threshold.
+ *
+ * @param[in]   range       Range index, below @ref QDEC_ACQ_RANGE_COUNT.
+ *
+ * @return      Pointer to the constant range descriptor.
+ */
+qdec_acq_range_t const * qdec_acq_range_get(uint8_t range);
+
+/**@brief Function for enabling or disabling automatic range selection.
+ *
+ * @details Disabling pins range 0, for consumers that need a fixed and short report period.
+ *          The change takes effect immediately, or on wake if sampling sleeps.
+ *
+ * @param[in]   enable      True to select the range from the measured speed.
+ */
+void qdec_acq_autorange_set(bool enable);
+
+/**@brief Function for getting the acquisition counters.
+ *
+ * @details The counters are written in the QDEC interrupt. A caller at a lower priority may see
+ *          one of them a report ahead of the others.
+ *
+ * @param[out]  p_stats     Copy of the counters.
+ */
+void qdec_acq_stats_get(qdec_acq_stats_t * p_stats);
+
+#endif /* QDEC_ACQ_H__ */
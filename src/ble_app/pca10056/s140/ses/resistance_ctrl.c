@@ -0,0 +1,60 @@
+#include "sdk_common.h"
+#include "resistance_ctrl.h"
+
+ret_code_t resistance_ctrl_init(resistance_ctrl_t * p_ctrl, resistance_ctrl_config_t const * p_config)
+{
+    VERIFY_PARAM_NOT_NULL(p_ctrl);
+    VERIFY_PARAM_NOT_NULL(p_config);
+
+    if (p_config->duty_min > p_config->duty_max)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    p_ctrl->cfg          = *p_config;
+    p_ctrl->target_q16   = 0;
+    p_ctrl->integral_q16 = (int32_t)p_config->duty_min << 16;
+    p_ctrl->duty         = p_config->duty_min;
+
+    return NRF_SUCCESS;
+}
+
+
+void resistance_ctrl_target_set(resistance_ctrl_t * p_ctrl, uint32_t target_q16)
+{
+    if ((p_ctrl->target_q16 == 0) && (target_q16 != 0))
+    {
+        p_ctrl->integral_q16 = (int32_t)p_ctrl->cfg.duty_min << 16;
+    }
+    p_ctrl->target_q16 = target_q16;
+}
+
+
+bool resistance_ctrl_is_enabled(resistance_ctrl_t const * p_ctrl)
+{
+    return (p_ctrl->target_q16 != 0);
+}
+
+
+uint16_t resistance_ctrl_update(resistance_ctrl_t * p_ctrl, uint32_t power_q16, uint32_t dt_us, bool moving)
+{
+    int32_t const min_q16 = (int32_t)p_ctrl->cfg.duty_min << 16;
+    int32_t const max_q16 = (int32_t)p_ctrl->cfg.duty_max << 16;
+    int64_t       err_q16 = (int64_t)power_q16 - p_ctrl->target_q16;    // Duty goes up with power.
+    int64_t       out_q16;
+
+    if (moving)
+    {
+        // Gain of this step in Q8.8 ticks/W, then Q16.16 W * Q8.8 ticks/W >> 8 = Q16.16 ticks.
+        // Clamping the integrator is the anti-windup.
+        int64_t ki_step  = ((int64_t)p_ctrl->cfg.ki * MIN(dt_us, RESISTANCE_CTRL_DT_MAX_US)) / 1000000;
+        int64_t integral = p_ctrl->integral_q16 + ((err_q16 * ki_step) >> 8);
+        p_ctrl->integral_q16 = (int32_t)MAX(MIN(integral, max_q16), min_q16);
+    }
+
+    out_q16 = p_ctrl->integral_q16 + ((err_q16 * p_ctrl->cfg.kp) >> 8);
+    out_q16 = MAX(MIN(out_q16, max_q16), min_q16);
+
+    p_ctrl->duty = (uint16_t)(out_q16 >> 16);
+    return p_ctrl->duty;
+}
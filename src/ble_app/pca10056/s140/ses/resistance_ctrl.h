@@ -0,0 +1,70 @@
+#ifndef RESISTANCE_CTRL_H__
+#define RESISTANCE_CTRL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdk_errors.h"
+
+#define RESISTANCE_CTRL_DT_MAX_US   100000  /**< Longest step the integrator accounts for, in microseconds. */
+
+/**@brief Closed-loop resistance controller configuration.
+ *
+ * @details The measured power is that of the flywheel, P = k * w^2, so it follows speed alone.
+ *          More duty brakes the flywheel and lowers its speed and power at the same effort, so the
+ *          controller raises duty while measured power is above target and lowers it below.
+ */
+typedef struct
+{
+    int32_t  kp;            /**< Proportional gain, duty ticks per watt, Q8.8. */
+    int32_t  ki;            /**< Integral gain, duty ticks per watt and second, Q8.8. */
+    uint16_t duty_min;      /**< Lowest duty the controller commands. */
+    uint16_t duty_max;      /**< Highest duty the controller commands. */
+} resistance_ctrl_config_t;
+
+/**@brief Closed-loop resistance controller state. */
+typedef struct
+{
+    resistance_ctrl_config_t cfg;           /**< Gains and limits. */
+    uint32_t                 target_q16;    /**< Target power, Q16.16 watts, 0 when disabled. */
+    int32_t                  integral_q16;  /**< Integrator, duty ticks Q16.16. */
+    uint16_t                 duty;          /**< Last commanded duty. */
+} resistance_ctrl_t;
+
+/**@brief Function for initializing the controller. It starts disabled.
+ *
+ * @param[out]  p_ctrl      Controller instance.
+ * @param[in]   p_config    Gains and limits.
+ *
+ * @return      NRF_SUCCESS on success, NRF_ERROR_INVALID_PARAM if the limits are inverted.
+ */
+ret_code_t resistance_ctrl_init(resistance_ctrl_t * p_ctrl, resistance_ctrl_config_t const * p_config);
+
+/**@brief Function for setting the target power.
+ *
+ * @details Enabling restarts the integrator from duty_min.
+ *
+ * @param[in]   p_ctrl      Controller instance.
+ * @param[in]   target_q16  Target power, Q16.16 watts. 0 disables the controller.
+ */
+void resistance_ctrl_target_set(resistance_ctrl_t * p_ctrl, uint32_t target_q16);
+
+/**@brief Function for checking if the controller is holding a target. */
+bool resistance_ctrl_is_enabled(resistance_ctrl_t const * p_ctrl);
+
+/**@brief Function for running one control step.
+ *
+ * @details Integer only and constant time, meant to run once per batch of QDEC reports. The
+ *          integral gain is scaled by the step duration, so the loop does not depend on the report
+ *          rate. The integrator is frozen while the sled stands still so it does not wind up before
+ *          the first stroke.
+ *
+ * @param[in]   p_ctrl      Controller instance.
+ * @param[in]   power_q16   Measured power at the end of the step, Q16.16 watts.
+ * @param[in]   dt_us       Duration of the step, in microseconds, limited to @ref RESISTANCE_CTRL_DT_MAX_US.
+ * @param[in]   moving      True if the sled moved during the step.
+ *
+ * @return      Duty to apply, between duty_min and duty_max.
+ */
+uint16_t resistance_ctrl_update(resistance_ctrl_t * p_ctrl, uint32_t power_q16, uint32_t dt_us, bool moving);
+
+#endif /* RESISTANCE_CTRL_H__ */
@@ -0,0 +1,216 @@
+#include "sdk_common.h"
+#include "sled_link.h"
+#include "ble_hci.h"
+#include "ble_conn_params.h"
+#include "app_timer.h"
+#include "nrf_log.h"
+
+static sled_link_info_t        m_info;
+static sled_link_init_t        m_init;
+static volatile bool           m_notifying;        /**< Telemetry notifications enabled by the client. */
+static uint32_t                m_last_motion;      /**< app_timer counter at the last batch with motion. */
+
+
+/**@brief Function for resetting the link information to the BLE defaults. */
+static void info_reset(uint16_t conn_handle)
+{
+    m_info.conn_handle   = conn_handle;
+    m_info.att_mtu       = BLE_GATT_ATT_MTU_DEFAULT;
+    m_info.data_len      = BLE_GAP_DATA_LENGTH_DEFAULT;
+    m_info.tx_phy        = BLE_GAP_PHY_1MBPS;
+    m_info.rx_phy        = BLE_GAP_PHY_1MBPS;
+    m_info.conn_interval = 0;
+    m_info.slave_latency = 0;
+    m_info.mode          = SLED_LINK_MODE_IDLE;
+    m_notifying          = false;
+}
+
+
+/**@brief Function for passing the link information to the application. */
+static void info_changed(void)
+{
+    if (m_init.evt_handler != NULL)
+    {
+        m_init.evt_handler(&m_info);
+    }
+}
+
+
+/**@brief Function for storing the connection parameters reported by the stack. */
+static void conn_params_store(ble_gap_conn_params_t const * p_params)
+{
+    m_info.conn_interval = p_params->max_conn_interval;
+    m_info.slave_latency = p_params->slave_latency;
+    NRF_LOG_INFO("Conn interval: %d x 1.25 ms, latency %d", m_info.conn_interval, m_info.slave_latency);
+}
+
+
+/**@brief Function for handling BLE events.
+ *
+ * @param[in]   p_ble_evt   Bluetooth stack event.
+ * @param[in]   p_context   Unused.
+ */
+static void sled_link_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    UNUSED_PARAMETER(p_context);
+    ret_code_t err_code;
+
+    switch (p_ble_evt->header.evt_id)
+    {
+        case BLE_GAP_EVT_CONNECTED:
+        {
+            ble_gap_phys_t const phys =
+            {
+                .rx_phys = BLE_GAP_PHY_2MBPS,
+                .tx_phys = BLE_GAP_PHY_2MBPS,
+            };
+
+            info_reset(p_ble_evt->evt.gap_evt.conn_handle);
+            conn_params_store(&p_ble_evt->evt.gap_evt.params.connected.conn_params);
+            info_changed();
+
+            // The peer may not support 2M, the outcome is reported in BLE_GAP_EVT_PHY_UPDATE.
+            err_code = sd_ble_gap_phy_update(m_info.conn_handle, &phys);
+            if (err_code != NRF_SUCCESS)
+            {
+                NRF_LOG_WARNING("PHY update request failed: 0x%x", err_code);
+            }
+        } break;
+
+        case BLE_GAP_EVT_DISCONNECTED:
+            info_reset(BLE_CONN_HANDLE_INVALID);
+            info_changed();
+            break;
+
+        case BLE_GAP_EVT_CONN_PARAM_UPDATE:
+            conn_params_store(&p_ble_evt->evt.gap_evt.params.conn_param_update.conn_params);
+            info_changed();
+            break;
+
+        case BLE_GAP_EVT_PHY_UPDATE:
+            if (p_ble_evt->evt.gap_evt.params.phy_update.status == BLE_HCI_STATUS_CODE_SUCCESS)
+            {
+                m_info.tx_phy = p_ble_evt->evt.gap_evt.params.phy_update.tx_phy;
+                m_info.rx_phy = p_ble_evt->evt.gap_evt.params.phy_update.rx_phy;
+                NRF_LOG_INFO("PHY: tx %d, rx %d", m_info.tx_phy, m_info.rx_phy);
+                info_changed();
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+NRF_SDH_BLE_OBSERVER(m_sled_link_obs, SLED_LINK_BLE_OBSERVER_PRIO, sled_link_on_ble_evt, NULL);
+
+
+ret_code_t sled_link_init(nrf_ble_gatt_t * p_gatt, sled_link_init_t const * p_init)
+{
+    ret_code_t err_code;
+
+    VERIFY_PARAM_NOT_NULL(p_init);
+
+    m_init = *p_init;
+    info_reset(BLE_CONN_HANDLE_INVALID);
+
+    err_code = nrf_ble_gatt_att_mtu_periph_set(p_gatt, NRF_SDH_BLE_GATT_MAX_MTU_SIZE);
+    VERIFY_SUCCESS(err_code);
+
+    return nrf_ble_gatt_data_length_set(p_gatt, BLE_CONN_HANDLE_INVALID, NRF_SDH_BLE_GAP_DATA_LENGTH);
+}
+
+
+void sled_link_on_gatt_evt(nrf_ble_gatt_t * p_gatt, nrf_ble_gatt_evt_t const * p_evt)
+{
+    UNUSED_PARAMETER(p_gatt);
+
+    switch (p_evt->evt_id)
+    {
+        case NRF_BLE_GATT_EVT_ATT_MTU_UPDATED:
+            m_info.att_mtu = p_evt->params.att_mtu_effective;
+            NRF_LOG_INFO("ATT MTU: %d", m_info.att_mtu);
+            info_changed();
+            break;
+
+        case NRF_BLE_GATT_EVT_DATA_LENGTH_UPDATED:
+            m_info.data_len = p_evt->params.data_length;
+            NRF_LOG_INFO("Data length: %d", m_info.data_len);
+            info_changed();
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+sled_link_info_t const * sled_link_info_get(void)
+{
+    return &m_info;
+}
+
+
+void sled_link_notify_set(bool enabled)
+{
+    m_notifying = enabled;
+}
+
+
+/**@brief Function for requesting the connection parameters of a mode, if not already requested. */
+static void mode_request(sled_link_mode_t mode)
+{
+    ret_code_t            err_code;
+    ble_gap_conn_params_t params;
+
+    if (mode == m_info.mode)
+    {
+        return;
+    }
+
+    params   = (mode == SLED_LINK_MODE_ACTIVE) ? m_init.active_params : m_init.idle_params;
+    err_code = ble_conn_params_change_conn_params(m_info.conn_handle, &params);
+
+    // A negotiation may already be running (NRF_ERROR_BUSY), try again on the next batch.
+    if (err_code == NRF_SUCCESS)
+    {
+        m_info.mode = mode;
+        NRF_LOG_INFO("Requesting %s connection parameters.",
+                     (mode == SLED_LINK_MODE_ACTIVE) ? "active" : "idle");
+        info_changed();
+    }
+}
+
+
+void sled_link_activity_update(bool moving)
+{
+    sled_link_mode_t mode;
+    uint32_t         now = app_timer_cnt_get();
+
+    if (m_info.conn_handle == BLE_CONN_HANDLE_INVALID)
+    {
+        return;
+    }
+
+    if (moving)
+    {
+        m_last_motion = now;
+    }
+
+    mode = (m_notifying && (app_timer_cnt_diff_compute(now, m_last_motion) < m_init.idle_timeout))
+           ? SLED_LINK_MODE_ACTIVE
+           : SLED_LINK_MODE_IDLE;
+
+    mode_request(mode);
+}
+
+
+void sled_link_idle_request(void)
+{
+    if (m_info.conn_handle == BLE_CONN_HANDLE_INVALID)
+    {
+        return;
+    }
+
+    mode_request(SLED_LINK_MODE_IDLE);
+}
@@ -0,0 +1,91 @@
+#ifndef SLED_LINK_H__
+#define SLED_LINK_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble.h"
+#include "nrf_ble_gatt.h"
+#include "nrf_sdh_ble.h"
+
+#define SLED_LINK_BLE_OBSERVER_PRIO     2       /**< Priority of the link module's BLE observer. */
+
+/**@brief Connection parameter set requested by the interval controller. */
+typedef enum
+{
+    SLED_LINK_MODE_IDLE,        /**< Long interval with slave latency, used when nothing is streamed. */
+    SLED_LINK_MODE_ACTIVE       /**< Short interval, used while notifying and the sled is moving. */
+} sled_link_mode_t;
+
+/**@brief Negotiated parameters of the current connection. */
+typedef struct
+{
+    uint16_t conn_handle;       /**< Handle of the current connection, BLE_CONN_HANDLE_INVALID if not connected. */
+    uint16_t att_mtu;           /**< Effective ATT MTU. */
+    uint16_t data_len;          /**< Effective link layer TX payload size (Data Length Extension). */
+    uint8_t  tx_phy;            /**< Current TX PHY (BLE_GAP_PHY_*). */
+    uint8_t  rx_phy;            /**< Current RX PHY (BLE_GAP_PHY_*). */
+    uint16_t conn_interval;     /**< Current connection interval in 1.25 ms units. */
+    uint16_t slave_latency;     /**< Current slave latency. */
+    sled_link_mode_t mode;      /**< Parameter set last requested by the interval controller. */
+} sled_link_info_t;
+
+/**@brief Link event handler type, called whenever a negotiated parameter changes. */
+typedef void (*sled_link_evt_handler_t) (sled_link_info_t const * p_info);
+
+/**@brief Link module init structure. */
+typedef struct
+{
+    sled_link_evt_handler_t evt_handler;    /**< Handler for link parameter changes. */
+    ble_gap_conn_params_t   active_params;  /**< Connection parameters for @ref SLED_LINK_MODE_ACTIVE. */
+    ble_gap_conn_params_t   idle_params;    /**< Connection parameters for @ref SLED_LINK_MODE_IDLE. */
+    uint32_t                idle_timeout;   /**< Time without motion before relaxing to idle, in app_timer ticks. */
+} sled_link_init_t;
+
+/**@brief Function for initializing the link optimization module.
+ *
+ * @details Configures the GATT module to request the largest ATT MTU and data length supported by
+ *          the stack configuration. A 2M PHY update is requested after every connection.
+ *          Connections start with the idle parameters; the Connection Parameters module must
+ *          be initialized before the first call to @ref sled_link_activity_update.
+ *
+ * @param[in]   p_gatt          GATT module instance, already initialized.
+ * @param[in]   p_init          Initialization parameters.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+ret_code_t sled_link_init(nrf_ble_gatt_t * p_gatt, sled_link_init_t const * p_init);
+
+/**@brief Function for telling the interval controller whether telemetry is being notified.
+ *
+ * @details Only records the state, may be called from the SoftDevice event context.
+ */
+void sled_link_notify_set(bool enabled);
+
+/**@brief Function for running the connection interval controller.
+ *
+ * @details Requests the active parameters while notifications are enabled and motion was seen
+ *          within the idle timeout, otherwise the idle parameters. Call from the main loop for
+ *          every batch of QDEC reports.
+ *
+ * @param[in]   moving          True if the encoder moved since the last call.
+ */
+void sled_link_activity_update(bool moving);
+
+/**@brief Function for requesting the idle parameters without waiting for the idle timeout.
+ *
+ * @details Meant for when QDEC sampling went to sleep, so no more batches arrive to run the
+ *          timeout. The next batch with motion goes back to the active parameters.
+ *          Call from the main loop.
+ */
+void sled_link_idle_request(void);
+
+/**@brief Function for handling events from the GATT module.
+ *
+ * @details Must be called from the application's nrf_ble_gatt event handler.
+ */
+void sled_link_on_gatt_evt(nrf_ble_gatt_t * p_gatt, nrf_ble_gatt_evt_t const * p_evt);
+
+/**@brief Function for getting the negotiated parameters of the current connection. */
+sled_link_info_t const * sled_link_info_get(void);
+
+#endif /* SLED_LINK_H__ */
@@ -0,0 +1,49 @@
+#include "sdk_common.h"
+#include "sled_metrics.h"
+#include <math.h>
+
+ret_code_t sled_metrics_init(sled_metrics_t * p_metrics, uint32_t cpr, uint32_t period_us)
+{
+    if (p_metrics == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (cpr == 0 || period_us == 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // The constant is computed once in single precision, the per-report path is integer only.
+    float rad_per_count_s = (2.0f * (float)M_PI / (float)cpr) / ((float)period_us * 0.000001f);
+    float power_k         = SLED_METRICS_POWER_COEFF * rad_per_count_s * rad_per_count_s;
+
+    if (power_k >= (float)(1UL << (32 - SLED_METRICS_K_FRAC_BITS)))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    p_metrics->power_k   = (uint32_t)(power_k * (float)(1UL << SLED_METRICS_K_FRAC_BITS) + 0.5f);
+    p_metrics->period_us = period_us;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sled_metrics_power_vel_q16(sled_metrics_t const * p_metrics, int32_t vel_q16)
+{
+    uint64_t speed  = (vel_q16 < 0) ? (uint64_t)(-(int64_t)vel_q16) : (uint64_t)vel_q16;
+    uint64_t counts = (speed * p_metrics->period_us) / (1000000 << 8);   // Counts per period, Q8.
+
+    // More than 65535 counts per report is far beyond the encoder, saturate instead of overflowing.
+    if (counts > ((uint64_t)UINT16_MAX << 8))
+    {
+        return UINT32_MAX;
+    }
+
+    // counts^2 is Q16 and up to 48 bits, split it so the product with power_k fits 64 bits.
+    uint64_t sq    = counts * counts;
+    uint64_t power = (((sq >> 16) * p_metrics->power_k) >> (SLED_METRICS_K_FRAC_BITS - 16))
+                   + (((sq & 0xFFFF) * p_metrics->power_k) >> SLED_METRICS_K_FRAC_BITS);
+
+    return (power > UINT32_MAX) ? UINT32_MAX : (uint32_t)power;
+}
@@ -0,0 +1,50 @@
+#ifndef SLED_METRICS_H__
+#define SLED_METRICS_H__
+
+#include <stdint.h>
+#include "sdk_errors.h"
+
+#define SLED_METRICS_POWER_COEFF    0.001735f   /**< Flywheel power per (rad/s)^2, in watts. */
+
+#define SLED_METRICS_K_FRAC_BITS    28          /**< Fractional bits of the precomputed power constant (UQ4.28). */
+
+/**@brief Convert a Q16.16 fixed-point value to float. */
+#define SLED_METRICS_Q16_TO_FLOAT(_q16)  ((float)(_q16) / 65536.0f)
+
+/**@brief Precomputed constants of the power kernel.
+ *
+ * @details Power at a speed of n counts per report period T is P = 0.001735 * (n / T * 2pi / cpr)^2,
+ *          so everything except n is folded into power_k once. Quantizing power_k to 28 fractional bits gives a
+ *          relative error below 2^-28 / power_k (1e-7 at cpr = 1024, T = 1.28 ms), and the
+ *          Q16.16 result is truncated by less than 2^-16 W.
+ */
+typedef struct
+{
+    uint32_t power_k;       /**< Watts per count^2 for one report period, UQ4.28. */
+    uint32_t period_us;     /**< Report period the constants were computed for. */
+} sled_metrics_t;
+
+/**@brief Function for precomputing the kernel constants.
+ *
+ * @param[out]  p_metrics   Kernel constants.
+ * @param[in]   cpr         Encoder counts per revolution (after x4 decoding).
+ * @param[in]   period_us   QDEC report period in microseconds.
+ *
+ * @return      NRF_SUCCESS on success, NRF_ERROR_INVALID_PARAM if the constant does not fit its format.
+ */
+ret_code_t sled_metrics_init(sled_metrics_t * p_metrics, uint32_t cpr, uint32_t period_us);
+
+/**@brief Function for computing power from an estimated velocity.
+ *
+ * @details The velocity is converted to counts per nominal report period with 8 fractional bits,
+ *          so a smoothed estimate below one count per report still gives a power reading. The
+ *          measured report duration is already accounted for by the velocity estimate.
+ *
+ * @param[in]   p_metrics   Kernel constants.
+ * @param[in]   vel_q16     Velocity in counts per second, Q16.16.
+ *
+ * @return      Power in watts, Q16.16, saturated at UINT32_MAX.
+ */
+uint32_t sled_metrics_power_vel_q16(sled_metrics_t const * p_metrics, int32_t vel_q16);
+
+#endif /* SLED_METRICS_H__ */
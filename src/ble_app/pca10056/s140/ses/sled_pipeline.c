@@ -0,0 +1,69 @@
+#include "sdk_common.h"
+#include "sled_pipeline.h"
+
+ret_code_t sled_pipeline_init(sled_pipeline_t * p_pipe,
+                              uint32_t          cpr,
+                              uint32_t const  * p_period_us,
+                              uint8_t           range_count,
+                              uint32_t          tau_us)
+{
+    ret_code_t err_code;
+
+    VERIFY_PARAM_NOT_NULL(p_pipe);
+    VERIFY_PARAM_NOT_NULL(p_period_us);
+    if ((range_count == 0) || (range_count > SLED_PIPELINE_RANGE_MAX))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    for (uint8_t i = 0; i < range_count; i++)
+    {
+        err_code = sled_metrics_init(&p_pipe->metrics[i], cpr, p_period_us[i]);
+        VERIFY_SUCCESS(err_code);
+    }
+    p_pipe->range_count = range_count;
+
+    err_code = sled_velocity_init(&p_pipe->velocity, p_period_us, range_count, tau_us);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = odometer_init(&p_pipe->odometer, cpr);
+    VERIFY_SUCCESS(err_code);
+
+    p_pipe->time_us   = 0;
+    p_pipe->power_q16 = 0;
+    p_pipe->batch_us  = 0;
+    p_pipe->moving    = false;
+
+    return NRF_SUCCESS;
+}
+
+
+void sled_pipeline_batch_begin(sled_pipeline_t * p_pipe)
+{
+    p_pipe->batch_us = 0;
+    p_pipe->moving   = false;
+}
+
+
+void sled_pipeline_report_add(sled_pipeline_t * p_pipe, uint8_t range, int32_t acc, uint32_t dt_us)
+{
+    range             = MIN(range, p_pipe->range_count - 1);
+    sled_velocity_update(&p_pipe->velocity, range, acc, dt_us);
+    p_pipe->power_q16 = sled_metrics_power_vel_q16(&p_pipe->metrics[range], p_pipe->velocity.vel_q16);
+    odometer_add(&p_pipe->odometer, acc);
+    p_pipe->time_us  += dt_us;
+    p_pipe->batch_us += dt_us;
+    p_pipe->moving   |= (acc != 0);
+}
+
+
+void sled_pipeline_gap_add(sled_pipeline_t * p_pipe, uint64_t gap_us)
+{
+    p_pipe->time_us += gap_us;
+}
+
+
+void sled_pipeline_session_reset(sled_pipeline_t * p_pipe)
+{
+    odometer_session_reset(&p_pipe->odometer);
+}
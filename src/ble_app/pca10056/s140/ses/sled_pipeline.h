@@ -0,0 +1,72 @@
+#ifndef SLED_PIPELINE_H__
+#define SLED_PIPELINE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdk_errors.h"
+#include "sled_metrics.h"
+#include "sled_velocity.h"
+#include "odometer.h"
+
+#define SLED_PIPELINE_RANGE_MAX     4   /**< Report periods the power constants can be precomputed for. */
+
+/**@brief Compute stage between QDEC acquisition and the Sled Service.
+ *
+ * @details Turns raw QDEC reports into power, distance and time. It makes no SoftDevice or
+ *          driver calls, so the stage can be fed with recorded or generated reports.
+ */
+typedef struct
+{
+    sled_metrics_t metrics[SLED_PIPELINE_RANGE_MAX]; /**< Precomputed power constants, one set per report period. */
+    uint8_t        range_count; /**< Entries of metrics in use. */
+    sled_velocity_t velocity;   /**< Velocity and acceleration estimate the power is computed from. */
+    odometer_t     odometer;    /**< Session and lifetime distance. */
+    uint64_t       time_us;     /**< Sum of the report durations and gaps since init. */
+    uint32_t       power_q16;   /**< Power at the latest report, from the estimated velocity, Q16.16 watts. */
+    uint32_t       batch_us;    /**< Sum of the report durations since @ref sled_pipeline_batch_begin. */
+    bool           moving;      /**< Counts were seen since @ref sled_pipeline_batch_begin. */
+} sled_pipeline_t;
+
+/**@brief Function for initializing the compute stage.
+ *
+ * @details The power constants and the velocity filter gains are computed once for every report
+ *          period the acquisition can switch to, so a report is processed with those of its own
+ *          period.
+ *
+ * @param[out]  p_pipe      Pipeline instance.
+ * @param[in]   cpr         Encoder counts per revolution (after x4 decoding).
+ * @param[in]   p_period_us Nominal QDEC report period of each range, in microseconds.
+ * @param[in]   range_count Number of ranges, at most @ref SLED_PIPELINE_RANGE_MAX.
+ * @param[in]   tau_us      Memory of the velocity filter, in microseconds.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+ret_code_t sled_pipeline_init(sled_pipeline_t * p_pipe,
+                              uint32_t          cpr,
+                              uint32_t const  * p_period_us,
+                              uint8_t           range_count,
+                              uint32_t          tau_us);
+
+/**@brief Function for starting a new batch of reports. Clears the moving flag and the batch time. */
+void sled_pipeline_batch_begin(sled_pipeline_t * p_pipe);
+
+/**@brief Function for processing one QDEC report.
+ *
+ * @param[in]   p_pipe      Pipeline instance.
+ * @param[in]   range       Range the report was sampled with, below range_count.
+ * @param[in]   acc         Counts accumulated during the report.
+ * @param[in]   dt_us       Measured duration of the report, in microseconds.
+ */
+void sled_pipeline_report_add(sled_pipeline_t * p_pipe, uint8_t range, int32_t acc, uint32_t dt_us);
+
+/**@brief Function for advancing the clock over a span without reports, such as a QDEC sleep.
+ *
+ * @param[in]   p_pipe      Pipeline instance.
+ * @param[in]   gap_us      Duration of the span, in microseconds.
+ */
+void sled_pipeline_gap_add(sled_pipeline_t * p_pipe, uint64_t gap_us);
+
+/**@brief Function for starting a new session. Lifetime totals and time are kept. */
+void sled_pipeline_session_reset(sled_pipeline_t * p_pipe);
+
+#endif /* SLED_PIPELINE_H__ */
@@ -0,0 +1,171 @@
+#include "sdk_common.h"
+#include "sled_prof.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "nrf_pwr_mgmt.h"
+#include "nrf_log.h"
+
+/**@brief Converts app_timer ticks to microseconds. */
+#define SLED_PROF_TICKS_TO_US(_ticks) \
+    (((uint64_t)(_ticks) * (APP_TIMER_CONFIG_RTC_FREQUENCY + 1) * 1000000) / APP_TIMER_CLOCK_FREQ)
+
+/**@brief Cycle statistics of one stage. */
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} sled_prof_stat_t;
+
+static sled_prof_stat_t m_stats[SLED_PROF_STAGE_COUNT];
+static uint64_t         m_window_us;    /**< Time covered by the statistics. */
+static uint64_t         m_sleep_us;     /**< Part of the window the CPU slept. */
+static uint32_t         m_last_ticks;   /**< app_timer counter when the window was last advanced. */
+
+
+/**@brief Function for computing the average of a stage, 0 if it never ran. */
+static uint32_t stat_avg(sled_prof_stat_t const * p_stat)
+{
+    return (p_stat->count != 0) ? (uint32_t)(p_stat->sum / p_stat->count) : 0;
+}
+
+
+/**@brief Function for advancing the window to now. */
+static uint32_t window_advance(void)
+{
+    uint32_t now   = app_timer_cnt_get();
+    uint32_t ticks = app_timer_cnt_diff_compute(now, m_last_ticks);
+
+    m_last_ticks = now;
+    m_window_us += SLED_PROF_TICKS_TO_US(ticks);
+    return ticks;
+}
+
+
+void sled_prof_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT       = 0;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+    sled_prof_reset();
+}
+
+
+void sled_prof_reset(void)
+{
+    CRITICAL_REGION_ENTER();
+    for (uint8_t i = 0; i < SLED_PROF_STAGE_COUNT; i++)
+    {
+        m_stats[i].count = 0;
+        m_stats[i].min   = UINT32_MAX;
+        m_stats[i].max   = 0;
+        m_stats[i].sum   = 0;
+    }
+    m_window_us  = 0;
+    m_sleep_us   = 0;
+    m_last_ticks = app_timer_cnt_get();
+    CRITICAL_REGION_EXIT();
+}
+
+
+void sled_prof_stop(sled_prof_stage_t stage, uint32_t start)
+{
+    uint32_t           cycles = DWT->CYCCNT - start;
+    sled_prof_stat_t * p_stat = &m_stats[stage];
+
+    // The encoder may run in SoftDevice context, keep the four fields consistent.
+    CRITICAL_REGION_ENTER();
+    p_stat->count++;
+    p_stat->sum += cycles;
+    if (cycles < p_stat->min)
+    {
+        p_stat->min = cycles;
+    }
+    if (cycles > p_stat->max)
+    {
+        p_stat->max = cycles;
+    }
+    CRITICAL_REGION_EXIT();
+}
+
+
+void sled_prof_sleep(void)
+{
+    uint32_t start;
+    uint64_t span_us;
+    uint64_t busy_us;
+
+    CRITICAL_REGION_ENTER();
+    (void)window_advance();
+    CRITICAL_REGION_EXIT();
+
+    start = DWT->CYCCNT;
+    nrf_pwr_mgmt_run();
+
+    CRITICAL_REGION_ENTER();
+    span_us = SLED_PROF_TICKS_TO_US(window_advance());
+    busy_us = (DWT->CYCCNT - start) / (SystemCoreClock / 1000000);
+    if (span_us > busy_us)
+    {
+        m_sleep_us += span_us - busy_us;
+    }
+    CRITICAL_REGION_EXIT();
+}
+
+
+uint16_t sled_prof_encode(uint8_t * p_buf)
+{
+    sled_prof_stat_t stats[SLED_PROF_STAGE_COUNT];
+    uint64_t         window_us;
+    uint64_t         sleep_us;
+    uint16_t         len = 0;
+
+    CRITICAL_REGION_ENTER();
+    memcpy(stats, m_stats, sizeof(stats));
+    window_us = m_window_us;
+    sleep_us  = m_sleep_us;
+    CRITICAL_REGION_EXIT();
+
+    len += uint32_encode((uint32_t)(window_us / 1000), &p_buf[len]);
+    len += uint16_encode((window_us != 0) ? (uint16_t)((sleep_us * 1000) / window_us) : 0, &p_buf[len]);
+    p_buf[len++] = SLED_PROF_STAGE_COUNT;
+
+    for (uint8_t i = 0; i < SLED_PROF_STAGE_COUNT; i++)
+    {
+        len += uint32_encode(stats[i].count, &p_buf[len]);
+        len += uint32_encode((stats[i].count != 0) ? stats[i].min : 0, &p_buf[len]);
+        len += uint32_encode(stat_avg(&stats[i]), &p_buf[len]);
+        len += uint32_encode(stats[i].max, &p_buf[len]);
+    }
+
+    return len;
+}
+
+
+void sled_prof_log(void)
+{
+    static char const * const stage_names[SLED_PROF_STAGE_COUNT] =
+    {
+        [SLED_PROF_QDEC]   = "qdec",
+        [SLED_PROF_POWER]  = "power",
+        [SLED_PROF_CTRL]   = "ctrl",
+        [SLED_PROF_PWM]    = "pwm",
+        [SLED_PROF_NOTIFY] = "notify"
+    };
+
+    NRF_LOG_INFO("Profile: %u ms, sleep %u permille.",
+                 (uint32_t)(m_window_us / 1000),
+                 (m_window_us != 0) ? (uint32_t)((m_sleep_us * 1000) / m_window_us) : 0);
+
+    for (uint8_t i = 0; i < SLED_PROF_STAGE_COUNT; i++)
+    {
+        if (m_stats[i].count != 0)
+        {
+            NRF_LOG_INFO("  %s: n %u, cycles %u/%u/%u (min/avg/max).",
+                         stage_names[i], m_stats[i].count,
+                         m_stats[i].min, stat_avg(&m_stats[i]), m_stats[i].max);
+        }
+    }
+}
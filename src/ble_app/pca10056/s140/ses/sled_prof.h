@@ -0,0 +1,63 @@
+#ifndef SLED_PROF_H__
+#define SLED_PROF_H__
+
+#include <stdint.h>
+#include "nrf.h"
+
+/**@brief Profiled stages of the main loop. */
+typedef enum
+{
+    SLED_PROF_QDEC,             /**< Draining the QDEC FIFO, everything below included. */
+    SLED_PROF_POWER,            /**< Power, distance and time of one report. */
+    SLED_PROF_CTRL,             /**< One constant power control step, PWM update included. */
+    SLED_PROF_PWM,              /**< Applying a Sled PWM command. */
+    SLED_PROF_NOTIFY,           /**< Publishing a batch or notifying the Sled Value. */
+    SLED_PROF_STAGE_COUNT
+} sled_prof_stage_t;
+
+#define SLED_PROF_HDR_LEN       7       /**< Encoded header: uint32 window in ms, uint16 sleep in permille, uint8 stage count. */
+#define SLED_PROF_STAGE_LEN     16      /**< Encoded stage: uint32 count, uint32 min, uint32 avg, uint32 max, in CPU cycles. */
+#define SLED_PROF_ENCODED_LEN   (SLED_PROF_HDR_LEN + SLED_PROF_STAGE_COUNT * SLED_PROF_STAGE_LEN)
+
+/**@brief Function for reading the DWT cycle counter at the start of a stage. */
+static __INLINE uint32_t sled_prof_start(void)
+{
+    return DWT->CYCCNT;
+}
+
+/**@brief Function for enabling the DWT cycle counter and clearing all statistics. */
+void sled_prof_init(void);
+
+/**@brief Function for clearing all statistics and starting a new window. */
+void sled_prof_reset(void);
+
+/**@brief Function for recording one run of a stage.
+ *
+ * @details Takes a few tens of cycles. Call from the main loop only.
+ *
+ * @param[in]   stage       Stage that ran.
+ * @param[in]   start       Value of @ref sled_prof_start when the stage began.
+ */
+void sled_prof_stop(sled_prof_stage_t stage, uint32_t start);
+
+/**@brief Function for putting the CPU to sleep while measuring how long it really slept.
+ *
+ * @details Wraps nrf_pwr_mgmt_run. The span is measured on the RTC; interrupts that ran in it are
+ *          measured on the cycle counter, which stops while the CPU sleeps, and are subtracted.
+ */
+void sled_prof_sleep(void);
+
+/**@brief Function for encoding the statistics, little endian.
+ *
+ * @details Safe to call from any context.
+ *
+ * @param[out]  p_buf       Buffer of at least @ref SLED_PROF_ENCODED_LEN bytes.
+ *
+ * @return      Number of bytes written.
+ */
+uint16_t sled_prof_encode(uint8_t * p_buf);
+
+/**@brief Function for writing the statistics to the log. */
+void sled_prof_log(void);
+
+#endif /* SLED_PROF_H__ */
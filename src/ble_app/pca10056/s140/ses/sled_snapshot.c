@@ -0,0 +1,41 @@
+#include <string.h>
+#include "sdk_common.h"
+#include "nrf.h"
+#include "sled_snapshot.h"
+
+void sled_snapshot_init(sled_snapshot_t * p_snap)
+{
+    memset(p_snap, 0, sizeof(*p_snap));
+}
+
+
+void sled_snapshot_publish(sled_snapshot_t * p_snap, sled_snapshot_data_t const * p_data)
+{
+    uint8_t back = p_snap->front ^ 1;
+
+    // Only a reader lapped by two publications can be looking at the back buffer.
+    p_snap->buf[back].seq++;
+    __DMB();
+    p_snap->buf[back].data = *p_data;
+    __DMB();
+    p_snap->buf[back].seq++;
+    __DMB();
+
+    p_snap->front = back;
+}
+
+
+void sled_snapshot_read(sled_snapshot_t const * p_snap, sled_snapshot_data_t * p_data)
+{
+    uint8_t  idx;
+    uint32_t seq;
+
+    do
+    {
+        idx = p_snap->front;
+        seq = p_snap->buf[idx].seq;
+        __DMB();
+        *p_data = p_snap->buf[idx].data;
+        __DMB();
+    } while ((seq & 1) || (seq != p_snap->buf[idx].seq));
+}
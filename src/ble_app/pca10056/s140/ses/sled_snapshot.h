@@ -0,0 +1,60 @@
+#ifndef SLED_SNAPSHOT_H__
+#define SLED_SNAPSHOT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**@brief Sled metrics of one published batch. */
+typedef struct
+{
+    uint64_t time_us;           /**< Sum of the report durations and gaps since init. */
+    int64_t  session_mm;        /**< Net distance since the session started, in millimeters. */
+    int64_t  lifetime_mm;       /**< Total distance since init, in millimeters. */
+    uint32_t power_q16;         /**< Power at the latest report, Q16.16 watts. */
+    int32_t  vel_q16;           /**< Estimated velocity, counts per second, Q16.16. */
+    int32_t  acc_q16;           /**< Estimated acceleration, counts per second squared, Q16.16. */
+    uint32_t batch;             /**< Batches published since init, 0 before the first one. */
+    bool     moving;            /**< Counts were seen during the batch. */
+} sled_snapshot_data_t;
+
+/**@brief Hand-off point between the compute stage and every consumer of the sled metrics.
+ *
+ * @details Two buffers, each guarded by a sequence counter. The producer fills the buffer
+ *          readers are not pointed at, then flips the front index, so it never waits. A reader
+ *          copies the front buffer and retries if the counter moved meanwhile, which can only
+ *          happen when the producer preempted it and published twice. A reader that preempts the
+ *          producer never retries, so the snapshot can be read from any interrupt priority.
+ */
+typedef struct
+{
+    struct
+    {
+        volatile uint32_t    seq;   /**< Odd while the buffer is written. */
+        sled_snapshot_data_t data;
+    } buf[2];
+    volatile uint8_t front;         /**< Index of the buffer readers copy. */
+} sled_snapshot_t;
+
+/**@brief Function for initializing the snapshot with all metrics zero.
+ *
+ * @param[out]  p_snap      Snapshot instance.
+ */
+void sled_snapshot_init(sled_snapshot_t * p_snap);
+
+/**@brief Function for publishing the metrics of a new batch.
+ *
+ * @details Must be called from one context only.
+ *
+ * @param[in]   p_snap      Snapshot instance.
+ * @param[in]   p_data      Metrics to publish.
+ */
+void sled_snapshot_publish(sled_snapshot_t * p_snap, sled_snapshot_data_t const * p_data);
+
+/**@brief Function for reading a consistent copy of the latest published metrics.
+ *
+ * @param[in]   p_snap      Snapshot instance.
+ * @param[out]  p_data      Copy of the metrics.
+ */
+void sled_snapshot_read(sled_snapshot_t const * p_snap, sled_snapshot_data_t * p_data);
+
+#endif /* SLED_SNAPSHOT_H__ */
@@ -0,0 +1,138 @@
+#include "sdk_common.h"
+#include "sled_velocity.h"
+#include <math.h>
+
+#define US_PER_S            1000000
+#define MIN_DT_US           128                 /**< Shortest span treated as a report, one QDEC sample. */
+#define RESIDUAL_MAX_Q16    ((int64_t)1 << 24)  /**< Residual clamp, 256 counts, keeps the gain products within 64 bits. */
+
+/**@brief Function for converting a gain to fixed point.
+ *
+ * @return      The gain, or 0 if it does not fit 32 bits.
+ */
+static uint32_t gain_fixed(float gain, uint8_t frac_bits)
+{
+    float fixed = gain * (float)(1UL << frac_bits) + 0.5f;
+
+    return (fixed < 4294967040.0f) ? (uint32_t)fixed : 0;
+}
+
+
+/**@brief Function for saturating a 64-bit intermediate to the 32-bit state. */
+static int32_t sat32(int64_t value)
+{
+    if (value > INT32_MAX)
+    {
+        return INT32_MAX;
+    }
+    if (value < INT32_MIN)
+    {
+        return INT32_MIN;
+    }
+    return (int32_t)value;
+}
+
+
+ret_code_t sled_velocity_init(sled_velocity_t * p_vel,
+                              uint32_t const  * p_period_us,
+                              uint8_t           range_count,
+                              uint32_t          tau_us)
+{
+    VERIFY_PARAM_NOT_NULL(p_vel);
+    VERIFY_PARAM_NOT_NULL(p_period_us);
+    if ((range_count == 0) || (range_count > SLED_VELOCITY_RANGE_MAX) || (tau_us == 0))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // The gains are computed once in single precision, the per-report path is integer only.
+    for (uint8_t i = 0; i < range_count; i++)
+    {
+        if (p_period_us[i] == 0)
+        {
+            return NRF_ERROR_INVALID_PARAM;
+        }
+
+        float period = (float)p_period_us[i] * 0.000001f;
+        float theta  = expf(-(float)p_period_us[i] / (float)tau_us);
+        float one_m  = 1.0f - theta;
+
+        p_vel->gains[i].g = gain_fixed(1.0f - theta * theta * theta, SLED_VELOCITY_POS_FRAC);
+        p_vel->gains[i].h = gain_fixed(1.5f * one_m * one_m * (1.0f + theta) / period,
+                                       SLED_VELOCITY_RATE_FRAC);
+        p_vel->gains[i].k = gain_fixed(one_m * one_m * one_m / (period * period),
+                                       SLED_VELOCITY_RATE_FRAC);
+        if ((p_vel->gains[i].g == 0) || (p_vel->gains[i].h == 0) || (p_vel->gains[i].k == 0))
+        {
+            return NRF_ERROR_INVALID_PARAM;
+        }
+    }
+    p_vel->range_count = range_count;
+
+    sled_velocity_reset(p_vel);
+
+    return NRF_SUCCESS;
+}
+
+
+void sled_velocity_update(sled_velocity_t * p_vel, uint8_t range, int32_t counts, uint32_t dt_us)
+{
+    sled_velocity_gains_t const * p_gains = &p_vel->gains[MIN(range, p_vel->range_count - 1)];
+    int64_t                       dt      = MAX(dt_us, MIN_DT_US);
+    int64_t                       vel     = p_vel->vel_q16;
+    int64_t                       acc     = p_vel->acc_q16;
+    int64_t                       dv;
+    int64_t                       err;
+    int64_t                       res;
+
+    if (dt_us > SLED_VELOCITY_MAX_DT_US)
+    {
+        // Nothing to predict from, start over at the mean velocity of the report.
+        p_vel->vel_q16     = sat32((((int64_t)counts << 16) * US_PER_S) / dt);
+        p_vel->acc_q16     = 0;
+        p_vel->pos_err_q16 = 0;
+        p_vel->still_us    = (counts == 0) ? SLED_VELOCITY_REST_US : 0;
+        return;
+    }
+
+    // Predict to the end of the report: x += (v + a T / 2) T, v += a T.
+    dv  = (acc * dt) / US_PER_S;
+    err = p_vel->pos_err_q16 + ((vel + dv / 2) * dt) / US_PER_S - ((int64_t)counts << 16);
+    vel += dv;
+
+    // Correct with the residual, measured minus predicted position.
+    res  = -err;
+    res  = MIN(MAX(res, -RESIDUAL_MAX_Q16), RESIDUAL_MAX_Q16);
+    err += ((int64_t)p_gains->g * res) >> SLED_VELOCITY_POS_FRAC;
+    vel += ((int64_t)p_gains->h * res) >> SLED_VELOCITY_RATE_FRAC;
+    acc += ((int64_t)p_gains->k * res) >> SLED_VELOCITY_RATE_FRAC;
+
+    // No count for long enough, the sled is at rest. A single quiet report proves nothing: at
+    // 600 counts per second most 1.28 ms reports see no count at all.
+    if (counts != 0)
+    {
+        p_vel->still_us = 0;
+    }
+    else
+    {
+        p_vel->still_us = MIN(p_vel->still_us + (uint32_t)dt, SLED_VELOCITY_REST_US);
+        if (p_vel->still_us == SLED_VELOCITY_REST_US)
+        {
+            sled_velocity_reset(p_vel);
+            return;
+        }
+    }
+
+    p_vel->pos_err_q16 = sat32(err);
+    p_vel->vel_q16     = sat32(vel);
+    p_vel->acc_q16     = sat32(acc);
+}
+
+
+void sled_velocity_reset(sled_velocity_t * p_vel)
+{
+    p_vel->pos_err_q16 = 0;
+    p_vel->vel_q16     = 0;
+    p_vel->acc_q16     = 0;
+    p_vel->still_us    = SLED_VELOCITY_REST_US;
+}
@@ -0,0 +1,80 @@
+#ifndef SLED_VELOCITY_H__
+#define SLED_VELOCITY_H__
+
+#include <stdint.h>
+#include "sdk_errors.h"
+
+#define SLED_VELOCITY_RANGE_MAX     4           /**< Report periods the gains can be precomputed for. */
+#define SLED_VELOCITY_POS_FRAC      30          /**< Fractional bits of the position gain (UQ2.30). */
+#define SLED_VELOCITY_RATE_FRAC     12          /**< Fractional bits of the velocity and acceleration gains (UQ20.12). */
+#define SLED_VELOCITY_MAX_DT_US     100000      /**< Longer reports restart the filter instead of updating it. */
+#define SLED_VELOCITY_REST_US       50000       /**< Time without a single count after which the sled is at rest. */
+
+/**@brief Filter gains for one report period.
+ *
+ * @details The velocity and acceleration gains have the nominal report period folded in, h / T
+ *          and 2k / T^2, so the residual keeps its full resolution. Shifting the small raw gain
+ *          product first would round most corrections down to one negative LSB and bias the
+ *          estimate.
+ */
+typedef struct
+{
+    uint32_t g;                 /**< Position gain, UQ2.30. */
+    uint32_t h;                 /**< Velocity gain per second, UQ20.12. */
+    uint32_t k;                 /**< Acceleration gain per second squared, UQ20.12. */
+} sled_velocity_gains_t;
+
+/**@brief Fixed-point alpha-beta-gamma velocity estimator.
+ *
+ * @details Tracks position, velocity and acceleration of the encoder from the counts and the
+ *          hardware measured duration of every report. The gains are those of a critically damped
+ *          fading memory filter, theta = exp(-T / tau), so every report period forgets at the
+ *          same rate in time. Unlike averaging, a constant acceleration is followed without lag.
+ *
+ *          Position is kept relative to the measured count, so nothing grows with distance.
+ *          All units are counts: position Q16.16, velocity per second Q16.16 and acceleration per
+ *          second squared Q16.16.
+ */
+typedef struct
+{
+    sled_velocity_gains_t gains[SLED_VELOCITY_RANGE_MAX];  /**< Precomputed gains, one set per report period. */
+    uint8_t               range_count;                     /**< Entries of gains in use. */
+    int32_t               pos_err_q16;  /**< Estimated minus measured position. */
+    int32_t               vel_q16;      /**< Estimated velocity. */
+    int32_t               acc_q16;      /**< Estimated acceleration. */
+    uint32_t              still_us;     /**< Time since the last report with counts. */
+} sled_velocity_t;
+
+/**@brief Function for precomputing the gains and clearing the state.
+ *
+ * @param[out]  p_vel       Estimator instance.
+ * @param[in]   p_period_us Nominal QDEC report period of each range, in microseconds.
+ * @param[in]   range_count Number of ranges, at most @ref SLED_VELOCITY_RANGE_MAX.
+ * @param[in]   tau_us      Memory of the filter, in microseconds.
+ *
+ * @return      NRF_SUCCESS on success, NRF_ERROR_INVALID_PARAM if a gain does not fit its format.
+ */
+ret_code_t sled_velocity_init(sled_velocity_t * p_vel,
+                              uint32_t const  * p_period_us,
+                              uint8_t           range_count,
+                              uint32_t          tau_us);
+
+/**@brief Function for updating the estimate with one QDEC report.
+ *
+ * @details A report longer than @ref SLED_VELOCITY_MAX_DT_US, such as the first one after a QDEC
+ *          sleep, restarts the filter from the report's mean velocity. Once no count was seen for
+ *          @ref SLED_VELOCITY_REST_US the sled is at rest and power reads exactly zero instead of
+ *          decaying forever. The limit is in time rather than reports, so slow but steady motion
+ *          (any speed above 20 counts per second) is never mistaken for rest in the short ranges.
+ *
+ * @param[in]   p_vel       Estimator instance.
+ * @param[in]   range       Range the report was sampled with, below range_count.
+ * @param[in]   counts      Counts accumulated during the report.
+ * @param[in]   dt_us       Measured duration of the report, in microseconds.
+ */
+void sled_velocity_update(sled_velocity_t * p_vel, uint8_t range, int32_t counts, uint32_t dt_us);
+
+/**@brief Function for restarting the filter at rest. The gains are kept. */
+void sled_velocity_reset(sled_velocity_t * p_vel);
+
+#endif /* SLED_VELOCITY_H__ */